@@ -0,0 +1,115 @@
+// bench/bench_common.h
+// Small helpers shared by the benchmarks in bench/. Everything is static so
+// each benchmark stays a single translation unit like the fuzzers.
+#ifndef BENCH_COMMON_H
+#define BENCH_COMMON_H
+
+#include <cairo.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include "corpus_pack.h"
+
+static inline uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+/* Calls fn(arg) until at least min_ns have passed (and at least once) and
+ * returns the mean time per call in ns. */
+static inline double bench_repeat(void (*fn)(void *), void *arg, uint64_t min_ns) {
+    uint64_t iters = 0;
+    uint64_t t0 = now_ns(), t1;
+    do {
+        fn(arg);
+        iters++;
+        t1 = now_ns();
+    } while (t1 - t0 < min_ns);
+    return (double)(t1 - t0) / (double)iters;
+}
+
+/* ---------- corpus loading ---------- */
+typedef void (*bench_input_fn)(const char *name, const uint8_t *data, size_t size, void *ctx);
+
+static int bench_load_file(const char *path, bench_input_fn fn, void *ctx) {
+    FILE *fp = fopen(path, "rb");
+    if (!fp) { perror(path); return -1; }
+    struct stat st;
+    if (fstat(fileno(fp), &st) < 0 || !S_ISREG(st.st_mode)) { fclose(fp); return -1; }
+    size_t size = (size_t)st.st_size;
+    uint8_t *buf = malloc(size ? size : 1);
+    size_t got = buf ? fread(buf, 1, size, fp) : 0;
+    fclose(fp);
+    if (buf && got > 0) fn(path, buf, got, ctx);
+    free(buf);
+    return 0;
+}
+
+static int bench_load_pack(const char *path, bench_input_fn fn, void *ctx) {
+    cpack_t pack;
+    if (cpack_open(&pack, path) < 0) return -1;
+    char name[4096];
+    for (size_t i = 0; i < pack.count; i++) {
+        size_t size;
+        const uint8_t *data = cpack_get(&pack, i, &size);
+        if (!data || !size) continue;
+        snprintf(name, sizeof(name), "%s#%zu", path, i);
+        fn(name, data, size, ctx);
+    }
+    cpack_close(&pack);
+    return 0;
+}
+
+/* Calls fn once per input; path may be a single file, a corpus pack or a
+ * corpus directory. */
+static int bench_for_each_input(const char *path, bench_input_fn fn, void *ctx) {
+    struct stat st;
+    if (stat(path, &st) < 0) { perror(path); return -1; }
+    if (!S_ISDIR(st.st_mode))
+        return cpack_is_pack(path) ? bench_load_pack(path, fn, ctx)
+                                   : bench_load_file(path, fn, ctx);
+
+    DIR *d = opendir(path);
+    if (!d) { perror("opendir"); return -1; }
+    struct dirent *ent;
+    char full[4096];
+    while ((ent = readdir(d)) != NULL) {
+        if (ent->d_name[0] == '.') continue;
+        if (snprintf(full, sizeof(full), "%s/%s", path, ent->d_name) >= (int)sizeof(full))
+            continue;
+        if (stat(full, &st) == 0 && S_ISREG(st.st_mode))
+            bench_load_file(full, fn, ctx);
+    }
+    closedir(d);
+    return 0;
+}
+
+static const char *const bench_operator_names[] = {
+    "CLEAR", "SOURCE", "OVER", "IN", "OUT", "ATOP",
+    "DEST", "DEST_OVER", "DEST_IN", "DEST_OUT", "DEST_ATOP",
+    "XOR", "ADD", "SATURATE",
+    "MULTIPLY", "SCREEN", "OVERLAY", "DARKEN", "LIGHTEN",
+    "COLOR_DODGE", "COLOR_BURN", "HARD_LIGHT", "SOFT_LIGHT",
+    "DIFFERENCE", "EXCLUSION",
+    "HSL_HUE", "HSL_SATURATION", "HSL_COLOR", "HSL_LUMINOSITY",
+};
+#define BENCH_NUM_OPERATORS ((int)(sizeof(bench_operator_names) / sizeof(bench_operator_names[0])))
+
+static const char *const bench_antialias_names[] = {
+    "DEFAULT", "NONE", "GRAY", "SUBPIXEL", "FAST", "GOOD", "BEST",
+};
+
+static const char *const bench_filter_names[] = {
+    "FAST", "GOOD", "BEST", "NEAREST", "BILINEAR", "GAUSSIAN",
+};
+
+static const char *const bench_extend_names[] = {
+    "NONE", "REPEAT", "REFLECT", "PAD",
+};
+
+#endif
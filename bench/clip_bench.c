@@ -0,0 +1,282 @@
+// bench/clip_bench.c
+// Per-draw cost under nested clips, as a function of clip depth and clip
+// complexity.
+//
+// Synthetic sweep: N nested clips (save + clip per level, each level a bit
+// smaller than the previous one) of one shape, for a set of depths, then
+// paint / fill / stroke timed through the finished stack. Aligned rectangles
+// stay on the box path, everything else ends up with a clip path or clip
+// surface (cairo-clip-surface.c) that every draw has to composite through.
+//
+// Corpus replay (when corpus paths are given): the stateful harness built
+// with -DBENCH_BUILD reports every draw of op clip_stack through
+// bench_on_clip_draw(); the draws are bucketed by depth and by clip vertices.
+//
+//   clip_bench [-t min_ms_per_cell] [-s size] [-d depth]... [--csv] [<corpus_dir|file|pack>...]
+#include "bench_common.h"
+#include "bench_hooks.h"
+#include <math.h>
+
+#define MAX_DEPTHS 12
+#define NUM_BUCKETS 8      /* log2 buckets: 1, 2-3, 4-7, ... 128+ */
+#define TOP_N 15
+
+enum { SHAPE_ALIGNED, SHAPE_SUBPIXEL, SHAPE_POLYGON, SHAPE_CIRCLE, SHAPE_STAR, SHAPE_MIXED, NUM_SHAPES };
+static const char *const shape_names[NUM_SHAPES] = {
+    "rect-aligned", "rect-subpixel", "polygon", "circle", "star-evenodd", "mixed-aa",
+};
+
+enum { DRAW_PAINT, DRAW_FILL, DRAW_STROKE, NUM_DRAWS };
+static const char *const draw_names[NUM_DRAWS] = { "paint", "fill", "stroke" };
+
+typedef struct {
+    cairo_t *cr;
+    int      draw, size;
+} cell_t;
+
+/* ---------- synthetic sweep ---------- */
+static void push_level(cairo_t *cr, int shape, int level, int depth, int size) {
+    double inset = level * (size * 0.35) / depth;
+    double x0 = inset, y0 = inset, w = size - 2 * inset, h = size - 2 * inset;
+    double cx = size / 2.0, cy = size / 2.0, r = w / 2;
+
+    cairo_save(cr);
+    cairo_new_path(cr);
+    if (shape == SHAPE_MIXED) {
+        cairo_set_antialias(cr, (cairo_antialias_t)(level % 7));
+        shape = SHAPE_SUBPIXEL + level % 4;
+    }
+    switch (shape) {
+    case SHAPE_ALIGNED:
+        cairo_rectangle(cr, floor(x0), floor(y0), ceil(w), ceil(h));
+        break;
+    case SHAPE_SUBPIXEL:
+        cairo_rectangle(cr, x0 + 0.3, y0 + 0.3, w - 0.6, h - 0.6);
+        break;
+    case SHAPE_POLYGON:
+        for (int i = 0; i < 12; i++) {
+            double a = 2 * M_PI * i / 12 + level * 0.1;
+            cairo_line_to(cr, cx + r * 1.1 * cos(a), cy + r * 1.1 * sin(a));
+        }
+        cairo_close_path(cr);
+        break;
+    case SHAPE_CIRCLE:
+        cairo_arc(cr, cx, cy, r * 1.1, 0, 2 * M_PI);
+        break;
+    default:
+        cairo_set_fill_rule(cr, CAIRO_FILL_RULE_EVEN_ODD);
+        for (int i = 0; i < 7; i++) {
+            double a = 2 * M_PI * ((i * 3) % 7) / 7 + level * 0.1;
+            cairo_line_to(cr, cx + r * 1.3 * cos(a), cy + r * 1.3 * sin(a));
+        }
+        cairo_close_path(cr);
+        break;
+    }
+    cairo_clip(cr);
+}
+
+static void draw_cell(void *arg) {
+    cell_t *c = (cell_t*)arg;
+    switch (c->draw) {
+    case DRAW_PAINT:
+        cairo_paint(c->cr);
+        break;
+    case DRAW_FILL:
+        cairo_rectangle(c->cr, c->size * 0.05, c->size * 0.05, c->size * 0.9, c->size * 0.9);
+        cairo_fill(c->cr);
+        break;
+    default:
+        cairo_move_to(c->cr, 0, 0);
+        for (int i = 1; i <= 32; i++)
+            cairo_line_to(c->cr, c->size * i / 32.0, (i & 1) ? c->size : 0);
+        cairo_stroke(c->cr);
+        break;
+    }
+    cairo_surface_flush(cairo_get_target(c->cr));
+}
+
+typedef struct {
+    int    shape, depth, size;
+} build_t;
+
+/* target of build_and_unwind, created on first use and kept for the sweep */
+static cairo_surface_t *build_dst;
+static cairo_t *build_cr;
+
+static void build_and_unwind(void *arg) {
+    build_t *b = (build_t*)arg;
+    if (!build_dst) {
+        build_dst = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, b->size, b->size);
+        build_cr = cairo_create(build_dst);
+    }
+    cairo_t *cr = build_cr;
+    for (int l = 0; l < b->depth; l++) push_level(cr, b->shape, l, b->depth, b->size);
+    double x1, y1, x2, y2;
+    cairo_clip_extents(cr, &x1, &y1, &x2, &y2);   /* forces the clip to be reduced */
+    for (int l = 0; l < b->depth; l++) cairo_restore(cr);
+}
+
+static void sweep(int *depths, int ndepths, int size, double min_ms, int csv) {
+    if (csv) printf("shape,depth,build_us,paint_us,fill_us,stroke_us\n");
+    for (int shape = 0; shape < NUM_SHAPES; shape++) {
+        if (!csv) {
+            printf("\n== clips=%s size=%dx%d (us per call) ==\n", shape_names[shape], size, size);
+            printf("%6s %10s", "depth", "build");
+            for (int d = 0; d < NUM_DRAWS; d++) printf(" %10s", draw_names[d]);
+            printf("\n");
+        }
+        for (int di = 0; di < ndepths; di++) {
+            int depth = depths[di] > 0 ? depths[di] : 1;
+            build_t b = { shape, depth, size };
+            double build = bench_repeat(build_and_unwind, &b, (uint64_t)(min_ms * 1e6));
+
+            double ns[NUM_DRAWS];
+            for (int d = 0; d < NUM_DRAWS; d++) {
+                cairo_surface_t *dst = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, size, size);
+                cairo_t *cr = cairo_create(dst);
+                for (int l = 0; l < depth; l++) push_level(cr, shape, l, depth, size);
+                cairo_set_source_rgba(cr, 0.2, 0.5, 0.8, 0.7);
+                cairo_set_line_width(cr, 4.0);
+                cell_t cell = { cr, d, size };
+                draw_cell(&cell);   /* warm up */
+                ns[d] = bench_repeat(draw_cell, &cell, (uint64_t)(min_ms * 1e6));
+                cairo_destroy(cr);
+                cairo_surface_destroy(dst);
+            }
+            if (csv)
+                printf("%s,%d,%.3f,%.3f,%.3f,%.3f\n", shape_names[shape], depth, build / 1e3,
+                       ns[0] / 1e3, ns[1] / 1e3, ns[2] / 1e3);
+            else
+                printf("%6d %10.3f %10.3f %10.3f %10.3f\n", depth, build / 1e3, ns[0] / 1e3,
+                       ns[1] / 1e3, ns[2] / 1e3);
+            fflush(stdout);
+        }
+    }
+    if (build_dst) {
+        cairo_destroy(build_cr);
+        cairo_surface_destroy(build_dst);
+        build_cr = NULL;
+        build_dst = NULL;
+    }
+}
+
+/* ---------- corpus replay ---------- */
+typedef struct {
+    double ns;
+    int    depth, complexity;
+    char  *origin;
+} draw_sample_t;
+
+static draw_sample_t *samples;
+static size_t nsamples, cap_samples;
+static const char *current_origin;
+static uint64_t draw_start;
+
+void bench_on_clip_draw(int phase, int depth, int complexity) {
+    if (phase == BENCH_CLIP_BEGIN) {
+        draw_start = now_ns();
+        return;
+    }
+    double ns = (double)(now_ns() - draw_start);
+    if (nsamples == cap_samples) {
+        cap_samples = cap_samples ? cap_samples * 2 : 4096;
+        samples = realloc(samples, cap_samples * sizeof(*samples));
+    }
+    samples[nsamples++] = (draw_sample_t){ ns, depth, complexity, strdup(current_origin) };
+}
+
+static void replay_input(const char *name, const uint8_t *data, size_t size, void *ctx) {
+    (void)ctx;
+    current_origin = name;
+    LLVMFuzzerTestOneInput(data, size);
+}
+
+static void free_samples(void) {
+    for (size_t i = 0; i < nsamples; i++) free(samples[i].origin);
+    free(samples);
+    samples = NULL;
+    nsamples = cap_samples = 0;
+}
+
+static int log2_bucket(int v) {
+    int b = 0;
+    while (v > 1 && b < NUM_BUCKETS - 1) { v >>= 1; b++; }
+    return b;
+}
+
+static int by_ns_desc(const void *a, const void *b) {
+    double x = ((const draw_sample_t*)a)->ns, y = ((const draw_sample_t*)b)->ns;
+    return (x < y) - (x > y);
+}
+
+static void report_corpus(int csv) {
+    if (csv) {
+        printf("origin,depth,complexity,ns\n");
+        for (size_t i = 0; i < nsamples; i++)
+            printf("%s,%d,%d,%.0f\n", samples[i].origin, samples[i].depth, samples[i].complexity, samples[i].ns);
+        return;
+    }
+    double sum[NUM_BUCKETS][NUM_BUCKETS] = { { 0 } };
+    long cnt[NUM_BUCKETS][NUM_BUCKETS] = { { 0 } };
+    for (size_t i = 0; i < nsamples; i++) {
+        int d = log2_bucket(samples[i].depth), c = log2_bucket(samples[i].complexity);
+        sum[d][c] += samples[i].ns;
+        cnt[d][c]++;
+    }
+    printf("\n== corpus clip_stack draws: %zu, mean us per draw (rows: depth, columns: clip vertices) ==\n",
+           nsamples);
+    printf("%8s", "depth");
+    for (int c = 0; c < NUM_BUCKETS; c++) printf(" %10d", 1 << c);
+    printf("\n");
+    for (int d = 0; d < NUM_BUCKETS; d++) {
+        printf("%7d+", 1 << d);
+        for (int c = 0; c < NUM_BUCKETS; c++) {
+            if (cnt[d][c]) printf(" %10.2f", sum[d][c] / cnt[d][c] / 1e3);
+            else printf(" %10s", "-");
+        }
+        printf("\n");
+    }
+    qsort(samples, nsamples, sizeof(*samples), by_ns_desc);
+    printf("\nslowest draws:\n");
+    for (size_t i = 0; i < nsamples && i < TOP_N; i++)
+        printf("  %10.2f us depth %3d vertices %5d  %s\n", samples[i].ns / 1e3, samples[i].depth,
+               samples[i].complexity, samples[i].origin);
+}
+
+int main(int argc, char **argv) {
+    int depths[MAX_DEPTHS] = { 1, 2, 4, 8, 16, 32, 64 };
+    int ndepths = 7, user_depths = 0;
+    int size = 512, csv = 0;
+    double min_ms = 10.0;
+    int argi = 1;
+    for (; argi < argc && argv[argi][0] == '-'; argi++) {
+        if (!strcmp(argv[argi], "-t") && argi + 1 < argc) min_ms = atof(argv[++argi]);
+        else if (!strcmp(argv[argi], "-s") && argi + 1 < argc) size = atoi(argv[++argi]);
+        else if (!strcmp(argv[argi], "-d") && argi + 1 < argc) {
+            if (!user_depths) { ndepths = 0; user_depths = 1; }
+            if (ndepths < MAX_DEPTHS) depths[ndepths++] = atoi(argv[++argi]);
+            else argi++;
+        } else if (!strcmp(argv[argi], "--csv")) csv = 1;
+        else {
+            fprintf(stderr, "usage: %s [-t min_ms_per_cell] [-s size] [-d depth]... [--csv] "
+                    "[<corpus_dir|file|pack>...]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (size < 16) size = 16;
+
+    if (argi >= argc) {
+        sweep(depths, ndepths, size, min_ms, csv);
+        return 0;
+    }
+    srand(0);
+    for (; argi < argc; argi++)
+        bench_for_each_input(argv[argi], replay_input, NULL);
+    if (nsamples == 0) {
+        fprintf(stderr, "no clip_stack draws in the corpus\n");
+        return 1;
+    }
+    report_corpus(csv);
+    free_samples();
+    return 0;
+}
@@ -0,0 +1,222 @@
+// bench/font_cache_bench.c
+// Scaled-font and glyph-cache behaviour as a function of how many distinct
+// fonts a workload touches. A run cycles a line of text through every
+// combination of F font faces x S sizes x M font matrices (rotations set with
+// cairo_set_font_matrix), P passes over the combinations. Each combination is
+// its own scaled font, so once F*S*M outgrows cairo's scaled-font map and
+// holdover list, and their glyphs outgrow the global glyph-page budget, every
+// pass pays for font creation and glyph rasterization again.
+//
+// By default the faces are user fonts that draw their glyphs as outlines of a
+// toy face (Sans/Serif/Monospace x slant x weight). cairo calls render_glyph
+// only on a glyph-cache miss, so rendering the same glyph twice for one scaled
+// font means it was evicted in between. --direct uses the toy faces as they
+// are, which measures the real backend but can't see glyph misses.
+//
+// Scaled-font hits and misses are read off user data on the scaled font the
+// context ends up with: untagged means cairo had to create it. The tag's
+// destroy callback counts evictions.
+//
+//   font_cache_bench [-p passes] [-f faces]... [-s sizes]... [-m matrices]... [-g glyphs] [--direct] [--csv]
+#include "bench_common.h"
+#include <math.h>
+
+#define MAX_FACES 12
+#define MAX_AXIS 8
+
+typedef struct {
+    unsigned char rendered[32];    /* glyph ids 0..255 */
+} sf_tag_t;
+
+static cairo_user_data_key_t sf_tag_key, inner_face_key;
+static uint64_t sf_created, sf_alive, sf_evicted, glyph_renders, glyph_rerenders;
+
+static void sf_tag_destroy(void *p) {
+    sf_alive--;
+    sf_evicted++;
+    free(p);
+}
+
+static sf_tag_t *tag_scaled_font(cairo_scaled_font_t *sf) {
+    sf_tag_t *t = cairo_scaled_font_get_user_data(sf, &sf_tag_key);
+    if (t) return t;
+    t = calloc(1, sizeof(*t));
+    if (cairo_scaled_font_set_user_data(sf, &sf_tag_key, t, sf_tag_destroy) != CAIRO_STATUS_SUCCESS) {
+        free(t);
+        return NULL;
+    }
+    sf_created++;
+    sf_alive++;
+    return t;
+}
+
+/* ---------- proxy user font ---------- */
+static cairo_status_t proxy_unicode_to_glyph(cairo_scaled_font_t *sf, unsigned long unicode,
+                                             unsigned long *glyph) {
+    (void)sf;
+    *glyph = unicode & 0xff;
+    return CAIRO_STATUS_SUCCESS;
+}
+
+static cairo_status_t proxy_render_glyph(cairo_scaled_font_t *sf, unsigned long glyph, cairo_t *cr,
+                                         cairo_text_extents_t *extents) {
+    cairo_font_face_t *inner = cairo_font_face_get_user_data(cairo_scaled_font_get_font_face(sf),
+                                                             &inner_face_key);
+    sf_tag_t *t = tag_scaled_font(sf);
+    glyph_renders++;
+    if (t) {
+        unsigned char bit = (unsigned char)(1u << (glyph & 7));
+        if (t->rendered[(glyph & 0xff) >> 3] & bit) glyph_rerenders++;
+        t->rendered[(glyph & 0xff) >> 3] |= bit;
+    }
+    char s[2] = { (char)(glyph & 0x7f), 0 };
+    if (s[0] < 0x20) s[0] = '?';
+    cairo_set_font_face(cr, inner);
+    cairo_set_font_size(cr, 1.0);
+    cairo_move_to(cr, 0, 0);
+    cairo_text_path(cr, s);
+    cairo_fill(cr);
+    extents->x_advance = 0.6;
+    return CAIRO_STATUS_SUCCESS;
+}
+
+static cairo_font_face_t *make_face(int i, int direct) {
+    static const char *const families[3] = { "Sans", "Serif", "Monospace" };
+    cairo_font_face_t *toy = cairo_toy_font_face_create(families[i % 3], (cairo_font_slant_t)((i / 3) % 2),
+                                                        (cairo_font_weight_t)((i / 6) % 2));
+    if (direct) return toy;
+    cairo_font_face_t *uf = cairo_user_font_face_create();
+    cairo_user_font_face_set_unicode_to_glyph_func(uf, proxy_unicode_to_glyph);
+    cairo_user_font_face_set_render_glyph_func(uf, proxy_render_glyph);
+    cairo_font_face_set_user_data(uf, &inner_face_key, toy, (cairo_destroy_func_t)cairo_font_face_destroy);
+    return uf;
+}
+
+/* ---------- one workload ---------- */
+typedef struct {
+    uint64_t sf_hits, sf_misses, evicted, renders, rerenders;
+    double   cold_ns, warm_ns;     /* per glyph: first pass, later passes */
+} result_t;
+
+static void run(cairo_t *cr, int faces, int sizes, int matrices, int passes, const char *text,
+                int direct, result_t *r) {
+    cairo_font_face_t *face[MAX_FACES];
+    for (int f = 0; f < faces; f++) face[f] = make_face(f, direct);
+    uint64_t ev0 = sf_evicted, rn0 = glyph_renders, rr0 = glyph_rerenders;
+    size_t len = strlen(text);
+    uint64_t warm = 0;
+    memset(r, 0, sizeof(*r));
+
+    for (int p = 0; p < passes; p++) {
+        uint64_t t0 = now_ns();
+        for (int f = 0; f < faces; f++)
+            for (int s = 0; s < sizes; s++)
+                for (int m = 0; m < matrices; m++) {
+                    double pt = 9.0 + 1.5 * s, a = m * (M_PI / 2) / matrices;
+                    cairo_matrix_t fm;
+                    cairo_matrix_init_rotate(&fm, a);
+                    cairo_matrix_scale(&fm, pt, pt);
+                    cairo_set_font_face(cr, face[f]);
+                    cairo_set_font_matrix(cr, &fm);
+                    cairo_move_to(cr, 16, 16 + (m * 37 + s * 11) % 480);
+                    /* a proxy glyph render inside show_text may tag the font first */
+                    uint64_t created = sf_created;
+                    cairo_show_text(cr, text);
+                    tag_scaled_font(cairo_get_scaled_font(cr));
+                    if (sf_created != created) r->sf_misses++;
+                    else r->sf_hits++;
+                }
+        cairo_surface_flush(cairo_get_target(cr));
+        uint64_t dt = now_ns() - t0;
+        if (p == 0) r->cold_ns = (double)dt;
+        else warm += dt;
+    }
+    double glyphs_per_pass = (double)faces * sizes * matrices * len;
+    r->cold_ns /= glyphs_per_pass;
+    r->warm_ns = passes > 1 ? (double)warm / (glyphs_per_pass * (passes - 1)) : NAN;
+    r->evicted = sf_evicted - ev0;
+    r->renders = glyph_renders - rn0;
+    r->rerenders = glyph_rerenders - rr0;
+    for (int f = 0; f < faces; f++) cairo_font_face_destroy(face[f]);
+}
+
+int main(int argc, char **argv) {
+    int faces[MAX_AXIS] = { 1, 4, 12 }, nfaces = 3, user_faces = 0;
+    int sizes[MAX_AXIS] = { 1, 8, 32 }, nsizes = 3, user_sizes = 0;
+    int mats[MAX_AXIS] = { 1, 8 }, nmats = 2, user_mats = 0;
+    int passes = 4, nglyphs = 48, direct = 0, csv = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-p") && i + 1 < argc) passes = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-f") && i + 1 < argc) {
+            if (!user_faces) { nfaces = 0; user_faces = 1; }
+            if (nfaces < MAX_AXIS) faces[nfaces++] = atoi(argv[++i]);
+            else i++;
+        } else if (!strcmp(argv[i], "-s") && i + 1 < argc) {
+            if (!user_sizes) { nsizes = 0; user_sizes = 1; }
+            if (nsizes < MAX_AXIS) sizes[nsizes++] = atoi(argv[++i]);
+            else i++;
+        } else if (!strcmp(argv[i], "-m") && i + 1 < argc) {
+            if (!user_mats) { nmats = 0; user_mats = 1; }
+            if (nmats < MAX_AXIS) mats[nmats++] = atoi(argv[++i]);
+            else i++;
+        } else if (!strcmp(argv[i], "-g") && i + 1 < argc) nglyphs = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--direct")) direct = 1;
+        else if (!strcmp(argv[i], "--csv")) csv = 1;
+        else {
+            fprintf(stderr, "usage: %s [-p passes] [-f faces]... [-s sizes]... [-m matrices]... "
+                    "[-g glyphs] [--direct] [--csv]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (passes < 1) passes = 1;
+    if (nglyphs < 1) nglyphs = 1;
+    if (nglyphs > 256) nglyphs = 256;
+
+    /* printable ASCII, wrapping: more glyphs means more distinct glyph ids */
+    char text[257];
+    for (int i = 0; i < nglyphs; i++) text[i] = (char)(0x21 + i % 94);
+    text[nglyphs] = 0;
+
+    cairo_surface_t *dst = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, 512, 512);
+    cairo_t *cr = cairo_create(dst);
+    cairo_set_source_rgb(cr, 0, 0, 0);
+
+    if (csv)
+        printf("faces,sizes,matrices,scaled_fonts,sf_hits,sf_misses,sf_evicted,glyph_renders,"
+               "glyph_rerenders,cold_ns_per_glyph,warm_ns_per_glyph\n");
+    else {
+        printf("== %s faces, %d passes, %d glyphs per line ==\n", direct ? "toy" : "proxy user-font",
+               passes, nglyphs);
+        printf("%5s %5s %8s %8s %8s %9s %8s %10s %10s %8s %10s %10s\n", "faces", "sizes", "matrices",
+               "fonts", "sf_hit%", "sf_misses", "evicted", "renders", "rerenders", "rerend%",
+               "cold_ns/g", "warm_ns/g");
+    }
+    for (int fi = 0; fi < nfaces; fi++)
+        for (int si = 0; si < nsizes; si++)
+            for (int mi = 0; mi < nmats; mi++) {
+                int f = faces[fi] < 1 ? 1 : faces[fi] > MAX_FACES ? MAX_FACES : faces[fi];
+                int s = sizes[si] < 1 ? 1 : sizes[si], m = mats[mi] < 1 ? 1 : mats[mi];
+                result_t r;
+                run(cr, f, s, m, passes, text, direct, &r);
+                int fonts = f * s * m;
+                uint64_t lookups = r.sf_hits + r.sf_misses;
+                double hit = lookups ? 100.0 * r.sf_hits / lookups : 0.0;
+                double rer = r.renders ? 100.0 * r.rerenders / r.renders : 0.0;
+                if (csv)
+                    printf("%d,%d,%d,%d,%llu,%llu,%llu,%llu,%llu,%.1f,%.1f\n", f, s, m, fonts,
+                           (unsigned long long)r.sf_hits, (unsigned long long)r.sf_misses,
+                           (unsigned long long)r.evicted, (unsigned long long)r.renders,
+                           (unsigned long long)r.rerenders, r.cold_ns, r.warm_ns);
+                else
+                    printf("%5d %5d %8d %8d %7.1f%% %9llu %8llu %10llu %10llu %7.1f%% %10.1f %10.1f\n",
+                           f, s, m, fonts, hit, (unsigned long long)r.sf_misses,
+                           (unsigned long long)r.evicted, (unsigned long long)r.renders,
+                           (unsigned long long)r.rerenders, rer, r.cold_ns, r.warm_ns);
+                fflush(stdout);
+            }
+
+    cairo_destroy(cr);
+    cairo_surface_destroy(dst);
+    return 0;
+}
@@ -0,0 +1,179 @@
+// bench/gradient_bench.c
+// Gradient cost versus color-stop count. cairo keeps no per-pattern pixman
+// image, so every draw converts the stops again and pixman's gradient walker
+// searches them per pixel. The bench therefore splits each case into:
+//   build  - creating the pattern and adding the stops, in the given order
+//            (cairo inserts each stop into a sorted array)
+//   setup  - filling a 1x1 rectangle, i.e. the per-draw conversion cost
+//   ns/px  - (fill of an NxN square - setup) / N^2, for each size
+// over linear and radial gradients with different extend modes and degenerate
+// radial geometry, and sorted, shuffled or duplicate-heavy stop offsets.
+//
+//   gradient_bench [-t min_ms_per_cell] [-n stops]... [-s size]... [--csv]
+#include "bench_common.h"
+#include <math.h>
+
+#define MAX_COUNTS 10
+#define MAX_SIZES 6
+
+enum { G_LINEAR_PAD, G_LINEAR_REPEAT, G_LINEAR_REFLECT, G_RADIAL_PAD, G_RADIAL_NONE,
+       G_RADIAL_FOCAL, G_RADIAL_CONCENTRIC, NUM_GRADS };
+static const char *const grad_names[NUM_GRADS] = {
+    "linear-pad", "linear-repeat", "linear-reflect", "radial-pad", "radial-none",
+    "radial-focal", "radial-concentric",
+};
+
+enum { ORDER_SORTED, ORDER_SHUFFLED, ORDER_DUPLICATES, NUM_ORDERS };
+static const char *const order_names[NUM_ORDERS] = { "sorted", "shuffled", "duplicates" };
+
+typedef struct {
+    int     grad, nstops, size;
+    double *offsets;
+    cairo_t *cr;
+    cairo_pattern_t *pattern;
+} cell_t;
+
+static uint32_t xs_next(uint32_t *s) {
+    uint32_t x = *s;
+    x ^= x << 13; x ^= x >> 17; x ^= x << 5;
+    return *s = x;
+}
+
+static void fill_offsets(double *off, int n, int order) {
+    uint32_t seed = 0x2545f491u;
+    for (int i = 0; i < n; i++)
+        off[i] = order == ORDER_DUPLICATES ? floor(8.0 * i / n) / 8 : n > 1 ? (double)i / (n - 1) : 0.5;
+    if (order == ORDER_SORTED) return;
+    for (int i = n - 1; i > 0; i--) {
+        int j = (int)(xs_next(&seed) % (uint32_t)(i + 1));
+        double t = off[i]; off[i] = off[j]; off[j] = t;
+    }
+}
+
+/* gradients are laid out over a 256 unit span and scaled to the fill size,
+ * so each size sees the same stops per pixel row */
+static cairo_pattern_t *make_gradient(int grad, const double *off, int n, int size) {
+    cairo_pattern_t *p;
+    double s = size / 256.0;
+    switch (grad) {
+    case G_LINEAR_PAD:
+    case G_LINEAR_REPEAT:
+    case G_LINEAR_REFLECT:
+        p = cairo_pattern_create_linear(32 * s, 16 * s, 160 * s, 224 * s);
+        break;
+    case G_RADIAL_FOCAL:
+        p = cairo_pattern_create_radial(200 * s, 128 * s, 0, 128 * s, 128 * s, 72 * s);
+        break;
+    case G_RADIAL_CONCENTRIC:
+        p = cairo_pattern_create_radial(128 * s, 128 * s, 8 * s, 128 * s, 128 * s, 120 * s);
+        break;
+    default:
+        p = cairo_pattern_create_radial(96 * s, 96 * s, 12 * s, 150 * s, 140 * s, 110 * s);
+        break;
+    }
+    for (int i = 0; i < n; i++)
+        cairo_pattern_add_color_stop_rgba(p, off[i], (i & 1) ? 1.0 : 0.1, (i % 3) / 2.0,
+                                          (i % 5) / 4.0, 0.6 + 0.4 * (i & 1));
+    static const cairo_extend_t extend[NUM_GRADS] = {
+        CAIRO_EXTEND_PAD, CAIRO_EXTEND_REPEAT, CAIRO_EXTEND_REFLECT, CAIRO_EXTEND_PAD,
+        CAIRO_EXTEND_NONE, CAIRO_EXTEND_PAD, CAIRO_EXTEND_REPEAT,
+    };
+    cairo_pattern_set_extend(p, extend[grad]);
+    return p;
+}
+
+static void build_cell(void *arg) {
+    cell_t *c = (cell_t*)arg;
+    cairo_pattern_destroy(make_gradient(c->grad, c->offsets, c->nstops, c->size));
+}
+
+static void fill_cell(void *arg) {
+    cell_t *c = (cell_t*)arg;
+    cairo_rectangle(c->cr, 0, 0, c->size, c->size);
+    cairo_fill(c->cr);
+    cairo_surface_flush(cairo_get_target(c->cr));
+}
+
+int main(int argc, char **argv) {
+    int counts[MAX_COUNTS] = { 2, 16, 128, 512, 2048, 4096 };
+    int ncounts = 6, user_counts = 0;
+    int sizes[MAX_SIZES] = { 64, 256, 1024 };
+    int nsizes = 3, user_sizes = 0;
+    double min_ms = 10.0;
+    int csv = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-t") && i + 1 < argc) min_ms = atof(argv[++i]);
+        else if (!strcmp(argv[i], "-n") && i + 1 < argc) {
+            if (!user_counts) { ncounts = 0; user_counts = 1; }
+            if (ncounts < MAX_COUNTS) counts[ncounts++] = atoi(argv[++i]);
+            else i++;
+        } else if (!strcmp(argv[i], "-s") && i + 1 < argc) {
+            if (!user_sizes) { nsizes = 0; user_sizes = 1; }
+            if (nsizes < MAX_SIZES) sizes[nsizes++] = atoi(argv[++i]);
+            else i++;
+        } else if (!strcmp(argv[i], "--csv")) csv = 1;
+        else {
+            fprintf(stderr, "usage: %s [-t min_ms_per_cell] [-n stops]... [-s size]... [--csv]\n", argv[0]);
+            return 1;
+        }
+    }
+    uint64_t min_ns = (uint64_t)(min_ms * 1e6);
+    int max_size = 1;
+    for (int si = 0; si < nsizes; si++) {
+        if (sizes[si] < 1) sizes[si] = 1;
+        if (sizes[si] > max_size) max_size = sizes[si];
+    }
+
+    cairo_surface_t *dst = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, max_size, max_size);
+    cairo_t *cr = cairo_create(dst);
+
+    if (csv) printf("gradient,order,stops,build_us,setup_us,size,ns_per_px\n");
+    for (int g = 0; g < NUM_GRADS; g++) {
+        for (int order = 0; order < NUM_ORDERS; order++) {
+            if (!csv) {
+                printf("\n== %s, %s stops ==\n", grad_names[g], order_names[order]);
+                printf("%7s %10s %10s", "stops", "build_us", "setup_us");
+                for (int si = 0; si < nsizes; si++) printf("  ns/px@%-5d", sizes[si]);
+                printf("\n");
+            }
+            for (int ci = 0; ci < ncounts; ci++) {
+                int n = counts[ci] > 0 ? counts[ci] : 1;
+                double *off = malloc(sizeof(*off) * n);
+                fill_offsets(off, n, order);
+
+                cell_t cell = { g, n, 256, off, cr, NULL };
+                double build = bench_repeat(build_cell, &cell, min_ns);
+
+                double px[MAX_SIZES], setup = 0;
+                for (int si = -1; si < nsizes; si++) {
+                    cell.size = si < 0 ? 1 : sizes[si];
+                    /* the 1x1 fill uses the geometry of the first size */
+                    cell.pattern = make_gradient(g, off, n, si < 0 ? sizes[0] : cell.size);
+                    cairo_set_source(cr, cell.pattern);
+                    fill_cell(&cell);   /* warm up */
+                    double ns = bench_repeat(fill_cell, &cell, min_ns);
+                    cairo_pattern_destroy(cell.pattern);
+                    if (si < 0) setup = ns;
+                    else px[si] = fmax(ns - setup, 0.0) / ((double)cell.size * cell.size);
+                }
+
+                if (csv) {
+                    for (int si = 0; si < nsizes; si++)
+                        printf("%s,%s,%d,%.3f,%.3f,%d,%.3f\n", grad_names[g], order_names[order], n,
+                               build / 1e3, setup / 1e3, sizes[si], px[si]);
+                } else {
+                    printf("%7d %10.3f %10.3f", n, build / 1e3, setup / 1e3);
+                    for (int si = 0; si < nsizes; si++) printf("  %11.3f", px[si]);
+                    printf("\n");
+                }
+                fflush(stdout);
+                free(off);
+            }
+        }
+    }
+
+    cairo_destroy(cr);
+    cairo_surface_destroy(dst);
+    return 0;
+}
@@ -0,0 +1,137 @@
+// bench/image_filter_bench.c
+// Cost of drawing a large source image through each cairo_filter_t, against
+// scale factor and source size: the thumbnailing case. Sources are the
+// procedural images from image_gen.h. Each draw paints the whole image scaled
+// by s into an ARGB32 destination of at most -d pixels per side; the result is
+// ns per covered destination pixel, i.e. min(src*s, d)^2 pixels. Downscales
+// are where GOOD/BEST/GAUSSIAN build convolution kernels spanning many source
+// pixels; upscales mostly measure the interpolation.
+//
+//   image_filter_bench [-t min_ms_per_cell] [-S src_size]... [-x scale]... [-d dst_max]
+//                      [-k kind] [-e none|repeat|reflect|pad] [--csv]
+#include "bench_common.h"
+#include "image_gen.h"
+#include <math.h>
+
+#define MAX_SIZES 6
+#define MAX_SCALES 12
+#define NUM_FILTERS 6
+
+static const char *const filter_names[NUM_FILTERS] = {
+    "fast", "good", "best", "nearest", "bilinear", "gaussian",
+};
+static const char *const extend_names[4] = { "none", "repeat", "reflect", "pad" };
+
+typedef struct {
+    cairo_t         *cr;
+    cairo_surface_t *src;
+    double           scale;
+    cairo_filter_t   filter;
+    cairo_extend_t   extend;
+    int              cover;
+} cell_t;
+
+static void draw_cell(void *arg) {
+    cell_t *c = (cell_t*)arg;
+    cairo_save(c->cr);
+    cairo_rectangle(c->cr, 0, 0, c->cover, c->cover);
+    cairo_clip(c->cr);
+    cairo_scale(c->cr, c->scale, c->scale);
+    cairo_set_source_surface(c->cr, c->src, 0, 0);
+    cairo_pattern_set_filter(cairo_get_source(c->cr), c->filter);
+    cairo_pattern_set_extend(cairo_get_source(c->cr), c->extend);
+    cairo_paint(c->cr);
+    cairo_restore(c->cr);
+    cairo_surface_flush(cairo_get_target(c->cr));
+}
+
+int main(int argc, char **argv) {
+    int sizes[MAX_SIZES] = { 512, 2048, 4096 };
+    int nsizes = 3, user_sizes = 0;
+    double scales[MAX_SCALES] = { 1.0 / 32, 1.0 / 8, 1.0 / 4, 1.0 / 2, 1.0, 2.0, 8.0 };
+    int nscales = 7, user_scales = 0;
+    int dst_max = 1024, kind = IGEN_SMOOTH, csv = 0;
+    cairo_extend_t extend = CAIRO_EXTEND_PAD;
+    double min_ms = 20.0;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-t") && i + 1 < argc) min_ms = atof(argv[++i]);
+        else if (!strcmp(argv[i], "-S") && i + 1 < argc) {
+            if (!user_sizes) { nsizes = 0; user_sizes = 1; }
+            if (nsizes < MAX_SIZES) sizes[nsizes++] = atoi(argv[++i]);
+            else i++;
+        } else if (!strcmp(argv[i], "-x") && i + 1 < argc) {
+            if (!user_scales) { nscales = 0; user_scales = 1; }
+            if (nscales < MAX_SCALES) scales[nscales++] = atof(argv[++i]);
+            else i++;
+        } else if (!strcmp(argv[i], "-d") && i + 1 < argc) dst_max = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-k") && i + 1 < argc) {
+            const char *name = argv[++i];
+            for (kind = 0; kind < NUM_IGEN && strcmp(igen_names[kind], name); kind++) ;
+            if (kind == NUM_IGEN) { fprintf(stderr, "unknown image kind %s\n", name); return 1; }
+        } else if (!strcmp(argv[i], "-e") && i + 1 < argc) {
+            const char *name = argv[++i];
+            int e;
+            for (e = 0; e < 4 && strcmp(extend_names[e], name); e++) ;
+            if (e == 4) { fprintf(stderr, "unknown extend %s\n", name); return 1; }
+            extend = (cairo_extend_t)e;
+        } else if (!strcmp(argv[i], "--csv")) csv = 1;
+        else {
+            fprintf(stderr, "usage: %s [-t min_ms_per_cell] [-S src_size]... [-x scale]... [-d dst_max] "
+                    "[-k kind] [-e none|repeat|reflect|pad] [--csv]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (dst_max < 1) dst_max = 1;
+
+    cairo_surface_t *dst = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, dst_max, dst_max);
+    cairo_t *cr = cairo_create(dst);
+
+    if (csv) printf("kind,extend,src,scale,filter,dst_pixels,ms_per_draw,ns_per_dst_px\n");
+    for (int si = 0; si < nsizes; si++) {
+        int n = sizes[si] > 0 ? sizes[si] : 1;
+        cairo_surface_t *src = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, n, n);
+        if (cairo_surface_status(src) != CAIRO_STATUS_SUCCESS) {
+            fprintf(stderr, "can't allocate a %dx%d source\n", n, n);
+            cairo_surface_destroy(src);
+            continue;
+        }
+        igen_fill(src, kind, 1);
+
+        if (!csv) {
+            printf("\n== src=%dx%d %s, extend=%s, ns per destination pixel ==\n", n, n, igen_names[kind],
+                   extend_names[extend]);
+            printf("%10s %10s", "scale", "dst_px");
+            for (int f = 0; f < NUM_FILTERS; f++) printf(" %10s", filter_names[f]);
+            printf("\n");
+        }
+        for (int xi = 0; xi < nscales; xi++) {
+            double s = scales[xi] > 0 ? scales[xi] : 1.0;
+            int cover = (int)ceil(n * s);
+            if (cover > dst_max) cover = dst_max;
+            if (cover < 1) cover = 1;
+            double px = (double)cover * cover;
+            double ns[NUM_FILTERS];
+            for (int f = 0; f < NUM_FILTERS; f++) {
+                cell_t cell = { cr, src, s, (cairo_filter_t)f, extend, cover };
+                draw_cell(&cell);   /* warm up */
+                ns[f] = bench_repeat(draw_cell, &cell, (uint64_t)(min_ms * 1e6));
+            }
+            if (csv) {
+                for (int f = 0; f < NUM_FILTERS; f++)
+                    printf("%s,%s,%d,%g,%s,%.0f,%.4f,%.3f\n", igen_names[kind], extend_names[extend], n, s,
+                           filter_names[f], px, ns[f] / 1e6, ns[f] / px);
+            } else {
+                printf("%10g %10.0f", s, px);
+                for (int f = 0; f < NUM_FILTERS; f++) printf(" %10.3f", ns[f] / px);
+                printf("\n");
+            }
+            fflush(stdout);
+        }
+        cairo_surface_destroy(src);
+    }
+
+    cairo_destroy(cr);
+    cairo_surface_destroy(dst);
+    return 0;
+}
@@ -0,0 +1,151 @@
+// bench/mesh_bench.c
+// Mesh-gradient rasterization cost versus patch count, destination size and
+// subdivision depth. The patches tile the surface in a grid, so for a fixed
+// surface more patches means smaller patches and shallower subdivision. The
+// shape axis moves depth independently: flat patches have straight sides,
+// curved ones bulge by a third of a cell, and twisted ones have control points
+// pulled across the patch so it folds over itself.
+//
+// "depth" is the subdivision shift cairo-mesh-pattern-rasterizer.c derives
+// from the device-space control polygon (log2 of the steps per side, averaged
+// over the patches). The numbers are meant to be read next to it.
+//
+//   mesh_bench [-t min_ms_per_cell] [-s size]... [-p patches]... [--csv]
+#include "bench_common.h"
+#include <math.h>
+
+#define MAX_SIZES 8
+#define MAX_COUNTS 8
+
+enum { SHAPE_FLAT, SHAPE_CURVED, SHAPE_TWISTED, NUM_SHAPES };
+static const char *const shape_names[NUM_SHAPES] = { "flat", "curved", "twisted" };
+
+typedef struct {
+    cairo_t         *cr;
+    cairo_pattern_t *mesh;
+} cell_t;
+
+typedef struct {
+    double x, y;
+} pt_t;
+
+static double sqlen(pt_t a, pt_t b) {
+    return (a.x - b.x) * (a.x - b.x) + (a.y - b.y) * (a.y - b.y);
+}
+
+/* same estimate as bezier_steps_sq() + sqsteps2shift() in the rasterizer */
+static int side_shift(pt_t p0, pt_t p1, pt_t p2, pt_t p3) {
+    double t = fmax(sqlen(p0, p1), sqlen(p2, p3));
+    t = fmax(t, sqlen(p0, p2) * 0.25);
+    t = fmax(t, sqlen(p1, p3) * 0.25);
+    int e;
+    frexp(fmax(1.0, 18.0 * t), &e);
+    return (e + 1) >> 1;
+}
+
+/* Adds one patch over the cell (x, y, c, c); returns its estimated shift. */
+static int add_patch(cairo_pattern_t *mesh, int shape, double x, double y, double c, int idx) {
+    double bulge = shape == SHAPE_FLAT ? 0.0 : shape == SHAPE_CURVED ? c / 3 : c * 1.5;
+    pt_t corner[4] = { { x, y }, { x + c, y }, { x + c, y + c }, { x, y + c } };
+    /* outward normal of each side, scaled by the bulge */
+    pt_t out[4] = { { 0, -bulge }, { bulge, 0 }, { 0, bulge }, { -bulge, 0 } };
+    int shift = 0;
+
+    cairo_mesh_pattern_begin_patch(mesh);
+    cairo_mesh_pattern_move_to(mesh, corner[0].x, corner[0].y);
+    for (int s = 0; s < 4; s++) {
+        pt_t a = corner[s], b = corner[(s + 1) % 4];
+        /* twisted: the two control points go opposite ways, so the side crosses itself */
+        double flip = shape == SHAPE_TWISTED ? -1.0 : 1.0;
+        pt_t c1 = { a.x + (b.x - a.x) / 3 + out[s].x, a.y + (b.y - a.y) / 3 + out[s].y };
+        pt_t c2 = { a.x + 2 * (b.x - a.x) / 3 + flip * out[s].x, a.y + 2 * (b.y - a.y) / 3 + flip * out[s].y };
+        cairo_mesh_pattern_curve_to(mesh, c1.x, c1.y, c2.x, c2.y, b.x, b.y);
+        int sh = side_shift(a, c1, c2, b);
+        if (sh > shift) shift = sh;
+    }
+    for (int k = 0; k < 4; k++) {
+        double h = (idx * 0.37 + k * 0.25);
+        cairo_mesh_pattern_set_corner_color_rgba(mesh, k, fmod(h, 1.0), fmod(h * 1.7, 1.0),
+                                                 fmod(h * 2.3, 1.0), 0.6 + 0.1 * k);
+    }
+    cairo_mesh_pattern_end_patch(mesh);
+    return shift;
+}
+
+static cairo_pattern_t *make_mesh(int shape, int patches, int size, double *mean_shift) {
+    cairo_pattern_t *mesh = cairo_pattern_create_mesh();
+    int grid = (int)ceil(sqrt((double)patches));
+    double c = (double)size / grid;
+    long total = 0;
+    for (int i = 0; i < patches; i++)
+        total += add_patch(mesh, shape, (i % grid) * c, (i / grid) * c, c, i);
+    *mean_shift = (double)total / patches;
+    return mesh;
+}
+
+static void draw_cell(void *arg) {
+    cell_t *c = (cell_t*)arg;
+    cairo_set_source(c->cr, c->mesh);
+    cairo_paint(c->cr);
+    cairo_surface_flush(cairo_get_target(c->cr));
+}
+
+int main(int argc, char **argv) {
+    int sizes[MAX_SIZES] = { 64, 256, 1024 };
+    int counts[MAX_COUNTS] = { 1, 4, 16, 64, 256 };
+    int nsizes = 3, ncounts = 5, user_sizes = 0, user_counts = 0;
+    double min_ms = 20.0;
+    int csv = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-t") && i + 1 < argc) min_ms = atof(argv[++i]);
+        else if (!strcmp(argv[i], "-s") && i + 1 < argc) {
+            if (!user_sizes) { nsizes = 0; user_sizes = 1; }
+            if (nsizes < MAX_SIZES) sizes[nsizes++] = atoi(argv[++i]);
+            else i++;
+        } else if (!strcmp(argv[i], "-p") && i + 1 < argc) {
+            if (!user_counts) { ncounts = 0; user_counts = 1; }
+            if (ncounts < MAX_COUNTS) counts[ncounts++] = atoi(argv[++i]);
+            else i++;
+        } else if (!strcmp(argv[i], "--csv")) csv = 1;
+        else {
+            fprintf(stderr, "usage: %s [-t min_ms_per_cell] [-s size]... [-p patches]... [--csv]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    if (csv) printf("shape,size,patches,patch_px,depth,ms_per_paint,ns_per_pixel,us_per_patch\n");
+    for (int shape = 0; shape < NUM_SHAPES; shape++) {
+        if (!csv) {
+            printf("\n== shape=%s ==\n", shape_names[shape]);
+            printf("%6s %8s %9s %6s %12s %12s %12s\n", "size", "patches", "patch_px", "depth",
+                   "ms/paint", "ns/pixel", "us/patch");
+        }
+        for (int si = 0; si < nsizes; si++) {
+            int size = sizes[si];
+            for (int ci = 0; ci < ncounts; ci++) {
+                int patches = counts[ci] > 0 ? counts[ci] : 1;
+                double depth;
+                cairo_pattern_t *mesh = make_mesh(shape, patches, size, &depth);
+                cairo_surface_t *dst = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, size, size);
+                cairo_t *cr = cairo_create(dst);
+                cell_t cell = { cr, mesh };
+                draw_cell(&cell);   /* warm up */
+                double ns = bench_repeat(draw_cell, &cell, (uint64_t)(min_ms * 1e6));
+                cairo_destroy(cr);
+                cairo_surface_destroy(dst);
+                cairo_pattern_destroy(mesh);
+
+                double patch_px = (double)size / ceil(sqrt((double)patches));
+                if (csv)
+                    printf("%s,%d,%d,%.1f,%.2f,%.4f,%.3f,%.3f\n", shape_names[shape], size, patches,
+                           patch_px, depth, ns / 1e6, ns / ((double)size * size), ns / patches / 1e3);
+                else
+                    printf("%6d %8d %9.1f %6.2f %12.4f %12.3f %12.3f\n", size, patches, patch_px, depth,
+                           ns / 1e6, ns / ((double)size * size), ns / patches / 1e3);
+                fflush(stdout);
+            }
+        }
+    }
+    return 0;
+}
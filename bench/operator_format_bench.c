@@ -0,0 +1,227 @@
+// bench/operator_format_bench.c
+// Compositing cost matrix: every operator x destination format x source type,
+// for paint, mask and fill, at a few destination sizes. Prints one
+// operator x format table of ns/pixel per (source, primitive, size) block,
+// then the slowest combinations, which are the ones that fell off pixman's
+// fast paths.
+//
+//   operator_format_bench [-t min_ms_per_cell] [-s size]... [--csv]
+#include "bench_common.h"
+#include <math.h>
+#include <string.h>
+
+typedef struct {
+    const char    *name;
+    cairo_format_t format;
+} bench_format_t;
+
+static const bench_format_t formats[] = {
+    { "ARGB32",    CAIRO_FORMAT_ARGB32 },
+    { "RGB24",     CAIRO_FORMAT_RGB24 },
+    { "A8",        CAIRO_FORMAT_A8 },
+    { "A1",        CAIRO_FORMAT_A1 },
+    { "RGB16_565", CAIRO_FORMAT_RGB16_565 },
+    { "RGB30",     CAIRO_FORMAT_RGB30 },
+#if CAIRO_VERSION >= CAIRO_VERSION_ENCODE(1, 17, 2)
+    { "RGB96F",    CAIRO_FORMAT_RGB96F },
+    { "RGBA128F",  CAIRO_FORMAT_RGBA128F },
+#endif
+};
+#define NUM_FORMATS ((int)(sizeof(formats) / sizeof(formats[0])))
+
+enum { SRC_SOLID, SRC_LINEAR, SRC_RADIAL, SRC_SURFACE, SRC_MESH, NUM_SOURCES };
+static const char *const source_names[NUM_SOURCES] = {
+    "solid", "linear", "radial", "surface", "mesh",
+};
+
+enum { PRIM_PAINT, PRIM_MASK, PRIM_FILL, NUM_PRIMS };
+static const char *const prim_names[NUM_PRIMS] = { "paint", "mask", "fill" };
+
+#define MAX_SIZES 8
+
+typedef struct {
+    cairo_t         *cr;
+    cairo_pattern_t *source;
+    cairo_pattern_t *mask;
+    int              prim;
+    int              size;
+} cell_t;
+
+typedef struct {
+    double ns_per_px;
+    int    op, fmt, src, prim, size;
+} result_t;
+
+static cairo_surface_t *make_noise_surface(int w, int h) {
+    cairo_surface_t *s = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, w, h);
+    unsigned char *px = cairo_image_surface_get_data(s);
+    int stride = cairo_image_surface_get_stride(s);
+    uint32_t x = 0x9e3779b9u;
+    for (int y = 0; y < h; y++) {
+        uint32_t *row = (uint32_t*)(px + (size_t)y * stride);
+        for (int i = 0; i < w; i++) {
+            x ^= x << 13; x ^= x >> 17; x ^= x << 5;
+            uint32_t a = 0x40 + (x >> 24) % 0xc0;
+            uint32_t r = ((x >> 16) & 0xff) * a / 255;
+            uint32_t g = ((x >> 8) & 0xff) * a / 255;
+            uint32_t b = (x & 0xff) * a / 255;
+            row[i] = (a << 24) | (r << 16) | (g << 8) | b;   /* premultiplied */
+        }
+    }
+    cairo_surface_mark_dirty(s);
+    return s;
+}
+
+static cairo_pattern_t *make_source(int type, int size) {
+    cairo_pattern_t *p = NULL;
+    switch (type) {
+    case SRC_SOLID:
+        p = cairo_pattern_create_rgba(0.8, 0.3, 0.1, 0.7);
+        break;
+    case SRC_LINEAR:
+        p = cairo_pattern_create_linear(0, 0, size, size);
+        cairo_pattern_add_color_stop_rgba(p, 0.0, 1, 0, 0, 1);
+        cairo_pattern_add_color_stop_rgba(p, 0.5, 0, 1, 0, 0.5);
+        cairo_pattern_add_color_stop_rgba(p, 1.0, 0, 0, 1, 1);
+        break;
+    case SRC_RADIAL:
+        p = cairo_pattern_create_radial(size * 0.4, size * 0.4, 0, size * 0.5, size * 0.5, size * 0.5);
+        cairo_pattern_add_color_stop_rgba(p, 0.0, 1, 1, 0, 1);
+        cairo_pattern_add_color_stop_rgba(p, 1.0, 0, 0, 1, 0.3);
+        break;
+    case SRC_SURFACE: {
+        cairo_surface_t *img = make_noise_surface(64, 64);
+        p = cairo_pattern_create_for_surface(img);
+        cairo_pattern_set_extend(p, CAIRO_EXTEND_REPEAT);
+        cairo_surface_destroy(img);
+        break;
+    }
+    default:
+        p = cairo_pattern_create_mesh();
+        cairo_mesh_pattern_begin_patch(p);
+        cairo_mesh_pattern_move_to(p, 0, 0);
+        cairo_mesh_pattern_curve_to(p, size * 0.3, -size * 0.1, size * 0.7, size * 0.1, size, 0);
+        cairo_mesh_pattern_line_to(p, size, size);
+        cairo_mesh_pattern_curve_to(p, size * 0.7, size * 1.1, size * 0.3, size * 0.9, 0, size);
+        cairo_mesh_pattern_set_corner_color_rgba(p, 0, 1, 0, 0, 1);
+        cairo_mesh_pattern_set_corner_color_rgba(p, 1, 0, 1, 0, 0.5);
+        cairo_mesh_pattern_set_corner_color_rgba(p, 2, 0, 0, 1, 1);
+        cairo_mesh_pattern_set_corner_color_rgba(p, 3, 1, 1, 0, 0.5);
+        cairo_mesh_pattern_end_patch(p);
+        break;
+    }
+    return p;
+}
+
+static void draw_cell(void *arg) {
+    cell_t *c = (cell_t*)arg;
+    cairo_set_source(c->cr, c->source);
+    switch (c->prim) {
+    case PRIM_PAINT:
+        cairo_paint(c->cr);
+        break;
+    case PRIM_MASK:
+        cairo_mask(c->cr, c->mask);
+        break;
+    default:
+        cairo_arc(c->cr, c->size * 0.5, c->size * 0.5, c->size * 0.45, 0, 2 * M_PI);
+        cairo_fill(c->cr);
+        break;
+    }
+    cairo_surface_flush(cairo_get_target(c->cr));
+}
+
+static double covered_pixels(int prim, int size) {
+    if (prim == PRIM_FILL) return M_PI * (size * 0.45) * (size * 0.45);
+    return (double)size * size;
+}
+
+static int cmp_result_desc(const void *a, const void *b) {
+    double x = ((const result_t*)a)->ns_per_px, y = ((const result_t*)b)->ns_per_px;
+    return (x < y) - (x > y);
+}
+
+int main(int argc, char **argv) {
+    int sizes[MAX_SIZES] = { 64, 256, 1024 };
+    int nsizes = 3, user_sizes = 0;
+    double min_ms = 10.0;
+    int csv = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-t") && i + 1 < argc) min_ms = atof(argv[++i]);
+        else if (!strcmp(argv[i], "-s") && i + 1 < argc) {
+            if (!user_sizes) { nsizes = 0; user_sizes = 1; }
+            if (nsizes < MAX_SIZES) sizes[nsizes++] = atoi(argv[++i]);
+            else i++;
+        } else if (!strcmp(argv[i], "--csv")) csv = 1;
+        else {
+            fprintf(stderr, "usage: %s [-t min_ms_per_cell] [-s size]... [--csv]\n", argv[0]);
+            return 1;
+        }
+    }
+    for (int si = 0; si < nsizes; si++)
+        if (sizes[si] < 1) sizes[si] = 1;   /* ns / covered_pixels() below */
+
+    size_t max_results = (size_t)BENCH_NUM_OPERATORS * NUM_FORMATS * NUM_SOURCES * NUM_PRIMS * nsizes;
+    result_t *results = calloc(max_results, sizeof(*results));
+    size_t nresults = 0;
+
+    if (csv) printf("operator,format,source,primitive,size,ns_per_pixel\n");
+
+    for (int si = 0; si < nsizes; si++) {
+        int size = sizes[si];
+        cairo_pattern_t *mask = cairo_pattern_create_radial(size * 0.5, size * 0.5, 0,
+                                                            size * 0.5, size * 0.5, size * 0.5);
+        cairo_pattern_add_color_stop_rgba(mask, 0, 0, 0, 0, 1);
+        cairo_pattern_add_color_stop_rgba(mask, 1, 0, 0, 0, 0);
+
+        for (int src = 0; src < NUM_SOURCES; src++) {
+            cairo_pattern_t *source = make_source(src, size);
+            for (int prim = 0; prim < NUM_PRIMS; prim++) {
+                if (!csv) {
+                    printf("\n== source=%s primitive=%s size=%dx%d (ns/pixel) ==\n",
+                           source_names[src], prim_names[prim], size, size);
+                    printf("%-16s", "operator");
+                    for (int f = 0; f < NUM_FORMATS; f++) printf(" %10s", formats[f].name);
+                    printf("\n");
+                }
+                for (int op = 0; op < BENCH_NUM_OPERATORS; op++) {
+                    if (!csv) printf("%-16s", bench_operator_names[op]);
+                    for (int f = 0; f < NUM_FORMATS; f++) {
+                        cairo_surface_t *dst = cairo_image_surface_create(formats[f].format, size, size);
+                        cairo_t *cr = cairo_create(dst);
+                        cairo_set_operator(cr, (cairo_operator_t)op);
+                        cell_t cell = { cr, source, mask, prim, size };
+                        draw_cell(&cell);   /* warm up caches / pixman lookups */
+                        double ns = bench_repeat(draw_cell, &cell, (uint64_t)(min_ms * 1e6));
+                        double per_px = ns / covered_pixels(prim, size);
+                        cairo_destroy(cr);
+                        cairo_surface_destroy(dst);
+
+                        results[nresults++] = (result_t){ per_px, op, f, src, prim, size };
+                        if (csv)
+                            printf("%s,%s,%s,%s,%d,%.4f\n", bench_operator_names[op], formats[f].name,
+                                   source_names[src], prim_names[prim], size, per_px);
+                        else
+                            printf(" %10.3f", per_px);
+                    }
+                    if (!csv) printf("\n");
+                    fflush(stdout);
+                }
+            }
+            cairo_pattern_destroy(source);
+        }
+        cairo_pattern_destroy(mask);
+    }
+
+    if (!csv) {
+        qsort(results, nresults, sizeof(*results), cmp_result_desc);
+        printf("\n== slowest 25 combinations ==\n");
+        for (size_t i = 0; i < nresults && i < 25; i++)
+            printf("%10.3f ns/px  %-16s %-10s %-8s %-6s %d\n", results[i].ns_per_px,
+                   bench_operator_names[results[i].op], formats[results[i].fmt].name,
+                   source_names[results[i].src], prim_names[results[i].prim], results[i].size);
+    }
+    free(results);
+    return 0;
+}
@@ -0,0 +1,181 @@
+// bench/path_append_bench.c
+// Path ingestion throughput: building a path one cairo_line_to /
+// cairo_rel_line_to / cairo_curve_to call at a time versus handing cairo a
+// prebuilt cairo_path_t through cairo_append_path, for paths of 100 up to
+// millions of segments (map polylines). Also times copy_path of the result and
+// new_path (freeing it). Every number is ns per segment, best of -r runs;
+// "growth" is line_to's ns/segment relative to the smallest count, which
+// shows what cairo_path_fixed's buffer growth adds as the path gets long.
+// "scaled" repeats append_path under a non-identity CTM, where every point
+// goes through the user-to-device transform.
+//
+//   path_append_bench [-r reps] [-n segments]... [--csv]
+#include "bench_common.h"
+#include <math.h>
+
+#define MAX_COUNTS 10
+
+enum { M_LINE_TO, M_REL_LINE_TO, M_CURVE_TO, M_APPEND_LINES, M_APPEND_CURVES, M_APPEND_SCALED,
+       M_COPY_PATH, M_NEW_PATH, NUM_METHODS };
+static const char *const method_names[NUM_METHODS] = {
+    "line_to", "rel_line_to", "curve_to", "append_lines", "append_curves", "append_scaled",
+    "copy_path", "new_path",
+};
+
+/* a wiggly polyline like a coastline, deterministic */
+static void polyline_point(int i, double *x, double *y) {
+    *x = 10 + fmod(i * 0.37, 980.0) + 3 * sin(i * 0.11);
+    *y = 10 + fmod(i * 0.13, 980.0) + 3 * cos(i * 0.07);
+}
+
+static cairo_path_t *make_path(int n, int curves) {
+    int per = curves ? 4 : 2;
+    cairo_path_t *p = malloc(sizeof(*p));
+    p->status = CAIRO_STATUS_SUCCESS;
+    p->num_data = 2 + n * per;
+    p->data = malloc(sizeof(*p->data) * p->num_data);
+    cairo_path_data_t *d = p->data;
+    d[0].header.type = CAIRO_PATH_MOVE_TO;
+    d[0].header.length = 2;
+    polyline_point(0, &d[1].point.x, &d[1].point.y);
+    for (int i = 0; i < n; i++) {
+        cairo_path_data_t *h = &d[2 + i * per];
+        h->header.type = curves ? CAIRO_PATH_CURVE_TO : CAIRO_PATH_LINE_TO;
+        h->header.length = per;
+        for (int k = 1; k < per; k++) polyline_point(i * 3 + k, &h[k].point.x, &h[k].point.y);
+    }
+    return p;
+}
+
+static void free_path(cairo_path_t *p) {
+    free(p->data);
+    free(p);
+}
+
+static void build(cairo_t *cr, int method, int n, cairo_path_t *lines, cairo_path_t *curves) {
+    double x, y, x1, y1, x2, y2;
+    switch (method) {
+    case M_LINE_TO:
+        polyline_point(0, &x, &y);
+        cairo_move_to(cr, x, y);
+        for (int i = 1; i <= n; i++) {
+            polyline_point(i * 3 + 1, &x, &y);
+            cairo_line_to(cr, x, y);
+        }
+        break;
+    case M_REL_LINE_TO:
+        cairo_move_to(cr, 500, 500);
+        for (int i = 1; i <= n; i++) cairo_rel_line_to(cr, (i & 1) ? 0.5 : -0.5, (i & 2) ? 0.25 : -0.25);
+        break;
+    case M_CURVE_TO:
+        polyline_point(0, &x, &y);
+        cairo_move_to(cr, x, y);
+        for (int i = 0; i < n; i++) {
+            polyline_point(i * 3 + 1, &x, &y);
+            polyline_point(i * 3 + 2, &x1, &y1);
+            polyline_point(i * 3 + 3, &x2, &y2);
+            cairo_curve_to(cr, x, y, x1, y1, x2, y2);
+        }
+        break;
+    case M_APPEND_CURVES:
+        cairo_append_path(cr, curves);
+        break;
+    default:
+        cairo_append_path(cr, lines);
+        break;
+    }
+}
+
+int main(int argc, char **argv) {
+    int counts[MAX_COUNTS] = { 100, 1000, 10000, 100000, 1000000 };
+    int ncounts = 5, user_counts = 0, reps = 5, csv = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-r") && i + 1 < argc) reps = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-n") && i + 1 < argc) {
+            if (!user_counts) { ncounts = 0; user_counts = 1; }
+            if (ncounts < MAX_COUNTS) counts[ncounts++] = atoi(argv[++i]);
+            else i++;
+        } else if (!strcmp(argv[i], "--csv")) csv = 1;
+        else {
+            fprintf(stderr, "usage: %s [-r reps] [-n segments]... [--csv]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (reps < 1) reps = 1;
+
+    cairo_surface_t *dst = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, 16, 16);
+    cairo_t *cr = cairo_create(dst);
+
+    if (csv) {
+        printf("segments");
+        for (int m = 0; m < NUM_METHODS; m++) printf(",%s_ns", method_names[m]);
+        printf(",growth\n");
+    } else {
+        printf("== ns per segment, best of %d ==\n%9s", reps, "segments");
+        for (int m = 0; m < NUM_METHODS; m++) printf(" %13s", method_names[m]);
+        printf(" %8s\n", "growth");
+    }
+
+    double base = 0;
+    for (int ci = 0; ci < ncounts; ci++) {
+        int n = counts[ci] > 0 ? counts[ci] : 1;
+        cairo_path_t *lines = make_path(n, 0), *curves = make_path(n, 1);
+        double best[NUM_METHODS];
+        for (int m = 0; m < NUM_METHODS; m++) best[m] = INFINITY;
+
+        for (int r = 0; r < reps; r++) {
+            for (int m = M_LINE_TO; m <= M_APPEND_SCALED; m++) {
+                cairo_new_path(cr);
+                if (m == M_APPEND_SCALED) {
+                    cairo_save(cr);
+                    cairo_translate(cr, 3.5, -2.25);
+                    cairo_scale(cr, 0.75, 1.25);
+                    cairo_rotate(cr, 0.1);
+                }
+                uint64_t t0 = now_ns();
+                build(cr, m, n, lines, curves);
+                double dt = (double)(now_ns() - t0);
+                if (m == M_APPEND_SCALED) cairo_restore(cr);
+                if (dt < best[m]) best[m] = dt;
+            }
+
+            /* copy and free the last (line) path */
+            uint64_t t0 = now_ns();
+            cairo_path_t *copy = cairo_copy_path(cr);
+            double dt = (double)(now_ns() - t0);
+            if (dt < best[M_COPY_PATH]) best[M_COPY_PATH] = dt;
+            cairo_path_destroy(copy);
+
+            t0 = now_ns();
+            cairo_new_path(cr);
+            dt = (double)(now_ns() - t0);
+            if (dt < best[M_NEW_PATH]) best[M_NEW_PATH] = dt;
+        }
+        if (cairo_status(cr) != CAIRO_STATUS_SUCCESS) {
+            fprintf(stderr, "cairo error at %d segments: %s\n", n, cairo_status_to_string(cairo_status(cr)));
+            return 1;
+        }
+
+        double per[NUM_METHODS];
+        for (int m = 0; m < NUM_METHODS; m++) per[m] = best[m] / n;
+        if (ci == 0) base = per[M_LINE_TO];
+        double growth = base > 0 ? per[M_LINE_TO] / base : 0.0;
+        if (csv) {
+            printf("%d", n);
+            for (int m = 0; m < NUM_METHODS; m++) printf(",%.3f", per[m]);
+            printf(",%.3f\n", growth);
+        } else {
+            printf("%9d", n);
+            for (int m = 0; m < NUM_METHODS; m++) printf(" %13.2f", per[m]);
+            printf(" %8.2f\n", growth);
+        }
+        fflush(stdout);
+        free_path(lines);
+        free_path(curves);
+    }
+
+    cairo_destroy(cr);
+    cairo_surface_destroy(dst);
+    return 0;
+}
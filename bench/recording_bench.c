@@ -0,0 +1,192 @@
+// bench/recording_bench.c
+// Recording-surface replay cost against recorded op count and nesting depth.
+// Level 0 records N ops (fills, strokes, text). Each further level is a new
+// recording that paints the previous one through a rotate+scale, which is how
+// cached content ends up wrapped when it is composed into bigger cached
+// content. The top level is then replayed into an ARGB32 image:
+//   identity  - cairo_set_source_surface + paint
+//   scaled    - under a 0.5x scale and a small rotation
+//   subsurf   - a cairo_surface_create_for_rectangle quarter of it
+//   snapshot  - first replay after the recording was drawn to again, which
+//               makes cairo snapshot it instead of reusing its cached state
+// and reported as us per replay and ns per level-0 op.
+//
+//   recording_bench [-t min_ms_per_cell] [-n ops]... [-d depth]... [-s size] [--csv]
+#include "bench_common.h"
+#include <math.h>
+
+#define MAX_COUNTS 8
+#define MAX_DEPTHS 8
+
+enum { R_IDENTITY, R_SCALED, R_SUBSURF, R_SNAPSHOT, NUM_REPLAYS };
+static const char *const replay_names[NUM_REPLAYS] = { "identity", "scaled", "subsurf", "snapshot" };
+
+static void record_ops(cairo_t *rc, int n, int size) {
+    for (int i = 0; i < n; i++) {
+        double x = fmod(i * 37.0, size), y = fmod(i * 91.0, size), r = 2 + i % 13;
+        cairo_set_source_rgba(rc, (i % 3) / 2.0, (i % 5) / 4.0, (i % 7) / 6.0, 0.5 + (i & 1) * 0.5);
+        switch (i % 4) {
+        case 0:
+            cairo_rectangle(rc, x, y, r * 2, r);
+            cairo_fill(rc);
+            break;
+        case 1:
+            cairo_arc(rc, x, y, r, 0, 2 * M_PI);
+            cairo_fill(rc);
+            break;
+        case 2:
+            cairo_move_to(rc, x, y);
+            cairo_line_to(rc, x + r * 3, y + r);
+            cairo_stroke(rc);
+            break;
+        default:
+            cairo_move_to(rc, x, y);
+            cairo_set_font_size(rc, r + 6);
+            cairo_show_text(rc, "rec");
+            break;
+        }
+    }
+}
+
+static cairo_surface_t *build(int n, int depth, int size) {
+    cairo_rectangle_t ext = { 0, 0, size, size };
+    cairo_surface_t *rec = cairo_recording_surface_create(CAIRO_CONTENT_COLOR_ALPHA, &ext);
+    cairo_t *rc = cairo_create(rec);
+    record_ops(rc, n, size);
+    cairo_destroy(rc);
+    for (int l = 1; l < depth; l++) {
+        cairo_surface_t *outer = cairo_recording_surface_create(CAIRO_CONTENT_COLOR_ALPHA, &ext);
+        rc = cairo_create(outer);
+        cairo_translate(rc, size / 2.0, size / 2.0);
+        cairo_rotate(rc, 0.05 * l);
+        cairo_scale(rc, 0.95, 0.95);
+        cairo_translate(rc, -size / 2.0, -size / 2.0);
+        cairo_set_source_surface(rc, rec, 0, 0);
+        cairo_paint(rc);
+        cairo_destroy(rc);
+        cairo_surface_destroy(rec);
+        rec = outer;
+    }
+    return rec;
+}
+
+typedef struct {
+    cairo_t         *cr;
+    cairo_surface_t *rec, *sub;
+    int              mode, size;
+} cell_t;
+
+static void replay_cell(void *arg) {
+    cell_t *c = (cell_t*)arg;
+    cairo_save(c->cr);
+    switch (c->mode) {
+    case R_SCALED:
+        cairo_rotate(c->cr, 0.02);
+        cairo_scale(c->cr, 0.5, 0.5);
+        cairo_set_source_surface(c->cr, c->rec, 0, 0);
+        break;
+    case R_SUBSURF:
+        cairo_set_source_surface(c->cr, c->sub, 0, 0);
+        break;
+    case R_SNAPSHOT: {
+        /* touch the recording so the next use can't reuse its snapshot */
+        cairo_t *rc = cairo_create(c->rec);
+        cairo_rectangle(rc, 0, 0, 1, 1);
+        cairo_fill(rc);
+        cairo_destroy(rc);
+        cairo_set_source_surface(c->cr, c->rec, 0, 0);
+        break;
+    }
+    default:
+        cairo_set_source_surface(c->cr, c->rec, 0, 0);
+        break;
+    }
+    cairo_paint(c->cr);
+    cairo_restore(c->cr);
+    cairo_surface_flush(cairo_get_target(c->cr));
+}
+
+typedef struct {
+    int n, depth, size;
+} build_t;
+
+static void build_cell(void *arg) {
+    build_t *b = (build_t*)arg;
+    cairo_surface_destroy(build(b->n, b->depth, b->size));
+}
+
+int main(int argc, char **argv) {
+    int counts[MAX_COUNTS] = { 10, 100, 1000, 10000, 100000 };
+    int ncounts = 5, user_counts = 0;
+    int depths[MAX_DEPTHS] = { 1, 2, 4, 8 };
+    int ndepths = 4, user_depths = 0;
+    int size = 512, csv = 0;
+    double min_ms = 20.0;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-t") && i + 1 < argc) min_ms = atof(argv[++i]);
+        else if (!strcmp(argv[i], "-n") && i + 1 < argc) {
+            if (!user_counts) { ncounts = 0; user_counts = 1; }
+            if (ncounts < MAX_COUNTS) counts[ncounts++] = atoi(argv[++i]);
+            else i++;
+        } else if (!strcmp(argv[i], "-d") && i + 1 < argc) {
+            if (!user_depths) { ndepths = 0; user_depths = 1; }
+            if (ndepths < MAX_DEPTHS) depths[ndepths++] = atoi(argv[++i]);
+            else i++;
+        } else if (!strcmp(argv[i], "-s") && i + 1 < argc) size = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--csv")) csv = 1;
+        else {
+            fprintf(stderr, "usage: %s [-t min_ms_per_cell] [-n ops]... [-d depth]... [-s size] [--csv]\n",
+                    argv[0]);
+            return 1;
+        }
+    }
+    if (size < 16) size = 16;
+    uint64_t min_ns = (uint64_t)(min_ms * 1e6);
+
+    cairo_surface_t *dst = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, size, size);
+    cairo_t *cr = cairo_create(dst);
+
+    if (csv) printf("depth,ops,record_us,replay,replay_us,ns_per_op\n");
+    for (int di = 0; di < ndepths; di++) {
+        int depth = depths[di] > 0 ? depths[di] : 1;
+        if (!csv) {
+            printf("\n== depth=%d size=%dx%d (us per replay, ns per recorded op) ==\n", depth, size, size);
+            printf("%8s %11s", "ops", "record_us");
+            for (int r = 0; r < NUM_REPLAYS; r++) printf(" %11s", replay_names[r]);
+            printf(" %10s\n", "ns/op");
+        }
+        for (int ci = 0; ci < ncounts; ci++) {
+            int n = counts[ci] > 0 ? counts[ci] : 1;
+            build_t b = { n, depth, size };
+            double record = bench_repeat(build_cell, &b, min_ns);
+
+            cairo_surface_t *rec = build(n, depth, size);
+            cairo_surface_t *sub = cairo_surface_create_for_rectangle(rec, size / 4.0, size / 4.0,
+                                                                      size / 2.0, size / 2.0);
+            double ns[NUM_REPLAYS];
+            for (int r = 0; r < NUM_REPLAYS; r++) {
+                cell_t cell = { cr, rec, sub, r, size };
+                replay_cell(&cell);   /* warm up */
+                ns[r] = bench_repeat(replay_cell, &cell, min_ns);
+            }
+            cairo_surface_destroy(sub);
+            cairo_surface_destroy(rec);
+
+            if (csv) {
+                for (int r = 0; r < NUM_REPLAYS; r++)
+                    printf("%d,%d,%.3f,%s,%.3f,%.1f\n", depth, n, record / 1e3, replay_names[r], ns[r] / 1e3,
+                           ns[r] / n);
+            } else {
+                printf("%8d %11.2f", n, record / 1e3);
+                for (int r = 0; r < NUM_REPLAYS; r++) printf(" %11.2f", ns[r] / 1e3);
+                printf(" %10.1f\n", ns[R_IDENTITY] / n);
+            }
+            fflush(stdout);
+        }
+    }
+
+    cairo_destroy(cr);
+    cairo_surface_destroy(dst);
+    return 0;
+}
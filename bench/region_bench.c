@@ -0,0 +1,158 @@
+// bench/region_bench.c
+// cairo_region_t scaling curve: for each rectangle-set shape from region_gen.h
+// and each rectangle count, times building the region one union_rectangle at
+// a time and in bulk with create_rectangles, the four boolean ops against a
+// second set shifted by half a cell, and contains_rectangle queries. It also
+// reports the resulting number of boxes and the heap held by the region
+// (mallinfo2 delta). Incremental builds are skipped above -i rects since some
+// shapes go quadratic there, which is the point of the staircase row.
+//
+//   region_bench [-r reps] [-n count]... [-c cell] [-i max_incremental] [--csv]
+#include "bench_common.h"
+#include "region_gen.h"
+#include <malloc.h>
+#include <math.h>
+
+#define MAX_COUNTS 12
+#define NUM_QUERIES 4096
+
+enum { B_UNION, B_INTERSECT, B_XOR, B_SUBTRACT, NUM_BOOL };
+static const char *const bool_names[NUM_BOOL] = { "union", "intersect", "xor", "subtract" };
+
+static size_t heap_in_use(void) {
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+    return mallinfo2().uordblks;
+#else
+    return (size_t)(unsigned)mallinfo().uordblks;
+#endif
+}
+
+static void bool_op(cairo_region_t *dst, const cairo_region_t *src, int op) {
+    switch (op) {
+    case B_UNION:     cairo_region_union(dst, src); break;
+    case B_INTERSECT: cairo_region_intersect(dst, src); break;
+    case B_XOR:       cairo_region_xor(dst, src); break;
+    default:          cairo_region_subtract(dst, src); break;
+    }
+}
+
+int main(int argc, char **argv) {
+    int counts[MAX_COUNTS] = { 16, 256, 1024, 4096, 16384, 65536 };
+    int ncounts = 6, user_counts = 0;
+    int reps = 3, cell = 8, max_incremental = 16384, csv = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-r") && i + 1 < argc) reps = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-n") && i + 1 < argc) {
+            if (!user_counts) { ncounts = 0; user_counts = 1; }
+            if (ncounts < MAX_COUNTS) counts[ncounts++] = atoi(argv[++i]);
+            else i++;
+        } else if (!strcmp(argv[i], "-c") && i + 1 < argc) cell = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-i") && i + 1 < argc) max_incremental = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--csv")) csv = 1;
+        else {
+            fprintf(stderr, "usage: %s [-r reps] [-n count]... [-c cell] [-i max_incremental] [--csv]\n",
+                    argv[0]);
+            return 1;
+        }
+    }
+    if (reps < 1) reps = 1;
+
+    if (csv)
+        printf("shape,rects,boxes,heap_bytes,incremental_ms,bulk_ms,union_ms,intersect_ms,xor_ms,"
+               "subtract_ms,result_boxes_xor,contains_ns\n");
+
+    for (int kind = 0; kind < NUM_RGEN; kind++) {
+        if (!csv) {
+            printf("\n== shape=%s cell=%d ==\n", rgen_names[kind], cell);
+            printf("%8s %9s %11s %10s %10s", "rects", "boxes", "heap_B/box", "incr_ms", "bulk_ms");
+            for (int b = 0; b < NUM_BOOL; b++) printf(" %11s", bool_names[b]);
+            printf(" %10s %11s\n", "xor_boxes", "contains_ns");
+        }
+        for (int ci = 0; ci < ncounts; ci++) {
+            int n = counts[ci] > 0 ? counts[ci] : 1;
+            cairo_rectangle_int_t *a = malloc(sizeof(*a) * n), *b = malloc(sizeof(*b) * n);
+            rgen_fill(a, n, kind, 1, cell, 0, 0);
+            rgen_fill(b, n, kind, 2, cell, cell / 2, cell / 2);
+
+            double incr = NAN;
+            if (n <= max_incremental) {
+                incr = INFINITY;
+                for (int r = 0; r < reps; r++) {
+                    cairo_region_t *reg = cairo_region_create();
+                    uint64_t t0 = now_ns();
+                    for (int i = 0; i < n; i++) cairo_region_union_rectangle(reg, &a[i]);
+                    double dt = (double)(now_ns() - t0);
+                    if (dt < incr) incr = dt;
+                    cairo_region_destroy(reg);
+                }
+            }
+
+            double bulk = INFINITY;
+            size_t heap = 0;
+            for (int r = 0; r < reps; r++) {
+                size_t h0 = heap_in_use();
+                uint64_t t0 = now_ns();
+                cairo_region_t *reg = cairo_region_create_rectangles(a, n);
+                double dt = (double)(now_ns() - t0);
+                size_t h1 = heap_in_use();
+                heap = h1 > h0 ? h1 - h0 : 0;
+                if (dt < bulk) bulk = dt;
+                cairo_region_destroy(reg);
+            }
+
+            cairo_region_t *ra = cairo_region_create_rectangles(a, n);
+            cairo_region_t *rb = cairo_region_create_rectangles(b, n);
+            int boxes = cairo_region_num_rectangles(ra), xor_boxes = 0;
+
+            double bool_ns[NUM_BOOL];
+            for (int op = 0; op < NUM_BOOL; op++) {
+                bool_ns[op] = INFINITY;
+                for (int r = 0; r < reps; r++) {
+                    cairo_region_t *dst = cairo_region_copy(ra);
+                    uint64_t t0 = now_ns();
+                    bool_op(dst, rb, op);
+                    double dt = (double)(now_ns() - t0);
+                    if (dt < bool_ns[op]) bool_ns[op] = dt;
+                    if (op == B_XOR) xor_boxes = cairo_region_num_rectangles(dst);
+                    cairo_region_destroy(dst);
+                }
+            }
+
+            cairo_rectangle_int_t ext;
+            cairo_region_get_extents(ra, &ext);
+            uint32_t seed = 7;
+            volatile int sink = 0;
+            uint64_t t0 = now_ns();
+            for (int q = 0; q < NUM_QUERIES; q++) {
+                cairo_rectangle_int_t r = {
+                    ext.x + (int)(rgen_next(&seed) % (uint32_t)(ext.width + 1)),
+                    ext.y + (int)(rgen_next(&seed) % (uint32_t)(ext.height + 1)),
+                    1 + (int)(rgen_next(&seed) % (uint32_t)(2 * cell)),
+                    1 + (int)(rgen_next(&seed) % (uint32_t)(2 * cell)),
+                };
+                sink += cairo_region_contains_rectangle(ra, &r);
+            }
+            double contains = (double)(now_ns() - t0) / NUM_QUERIES;
+            (void)sink;
+
+            if (csv)
+                printf("%s,%d,%d,%zu,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f,%d,%.1f\n", rgen_names[kind], n, boxes,
+                       heap, incr / 1e6, bulk / 1e6, bool_ns[0] / 1e6, bool_ns[1] / 1e6, bool_ns[2] / 1e6,
+                       bool_ns[3] / 1e6, xor_boxes, contains);
+            else {
+                printf("%8d %9d %11.1f %10.3f %10.3f", n, boxes, boxes ? (double)heap / boxes : 0.0,
+                       incr / 1e6, bulk / 1e6);
+                for (int op = 0; op < NUM_BOOL; op++) printf(" %11.3f", bool_ns[op] / 1e6);
+                printf(" %10d %11.1f\n", xor_boxes, contains);
+            }
+            fflush(stdout);
+
+            cairo_region_destroy(ra);
+            cairo_region_destroy(rb);
+            free(a);
+            free(b);
+        }
+    }
+    return 0;
+}
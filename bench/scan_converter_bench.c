@@ -0,0 +1,287 @@
+// bench/scan_converter_bench.c
+// Replays the paths that corpus inputs actually build through fill and stroke
+// under every cairo_antialias_t and a few tolerances, and reports the cost
+// per flattened edge and per covered pixel. Antialias NONE ends up in the mono
+// converter, FAST in tor22, the rest in tor (or the rectangular converter /
+// Bentley-Ottmann for rectilinear paths), so the table shows where each
+// rasterizer stands and the per-path list shows the slow geometries.
+//
+// Links against the stateful harness built with -DBENCH_BUILD; every path the
+// harness is about to fill/stroke/clip (and the op 28 copy_path round trip) is
+// captured in device space through bench_on_path().
+//
+//   scan_converter_bench [-r reps] [-n max_paths] [-o dump_dir] [--csv] <corpus_dir|file|pack>...
+#include "bench_common.h"
+#include "bench_hooks.h"
+#include <math.h>
+
+#define CANVAS_W 500
+#define CANVAS_H 500
+#define MAX_PATH_DATA 200000
+#define MAX_DASHES 8
+#define NUM_ANTIALIAS 7
+#define TOP_N 20
+
+static const double tolerances[] = { 0.01, 0.1, 1.0 };
+#define NUM_TOLERANCES ((int)(sizeof(tolerances) / sizeof(tolerances[0])))
+
+enum { MODE_FILL, MODE_STROKE, NUM_MODES };
+static const char *const mode_names[NUM_MODES] = { "fill", "stroke" };
+
+typedef struct {
+    cairo_path_t     *path;        /* device space */
+    char             *origin;      /* input file that built it */
+    int               op;
+    uint64_t          hash;
+    double            line_width, miter_limit;
+    cairo_line_cap_t  cap;
+    cairo_line_join_t join;
+    cairo_fill_rule_t fill_rule;
+    int               num_dashes;
+    double            dashes[MAX_DASHES], dash_offset;
+} captured_path_t;
+
+typedef struct {
+    double ns;
+    long   edges, pixels;
+    int    path, mode, aa, tol;
+} sample_t;
+
+static captured_path_t *paths;
+static size_t num_paths, max_paths = 5000;
+static const char *current_origin;
+
+static uint64_t hash_path(const cairo_path_t *p) {
+    const uint8_t *b = (const uint8_t*)p->data;
+    size_t n = (size_t)p->num_data * sizeof(cairo_path_data_t);
+    uint64_t h = 1469598103934665603ull;
+    for (size_t i = 0; i < n; i++) { h ^= b[i]; h *= 1099511628211ull; }
+    return h;
+}
+
+void bench_on_path(cairo_t *cr, int op) {
+    if (num_paths >= max_paths) return;
+
+    cairo_save(cr);
+    cairo_identity_matrix(cr);
+    cairo_path_t *p = cairo_copy_path(cr);
+    cairo_restore(cr);
+
+    if (!p || p->status != CAIRO_STATUS_SUCCESS || p->num_data < 2 || p->num_data > MAX_PATH_DATA) {
+        cairo_path_destroy(p);
+        return;
+    }
+    uint64_t h = hash_path(p);
+    for (size_t i = 0; i < num_paths; i++) {
+        if (paths[i].hash == h) { cairo_path_destroy(p); return; }
+    }
+
+    captured_path_t *c = &paths[num_paths++];
+    memset(c, 0, sizeof(*c));
+    c->path = p;
+    c->origin = strdup(current_origin ? current_origin : "?");
+    c->op = op;
+    c->hash = h;
+    c->line_width = cairo_get_line_width(cr);
+    c->miter_limit = cairo_get_miter_limit(cr);
+    c->cap = cairo_get_line_cap(cr);
+    c->join = cairo_get_line_join(cr);
+    c->fill_rule = cairo_get_fill_rule(cr);
+    int nd = cairo_get_dash_count(cr);
+    if (nd > 0 && nd <= MAX_DASHES) {
+        c->num_dashes = nd;
+        cairo_get_dash(cr, c->dashes, &c->dash_offset);
+    }
+}
+
+static void capture_input(const char *name, const uint8_t *data, size_t size, void *ctx) {
+    (void)ctx;
+    current_origin = name;
+    LLVMFuzzerTestOneInput(data, size);
+    current_origin = NULL;
+}
+
+static long count_flat_edges(cairo_t *cr, const captured_path_t *c, double tol) {
+    cairo_new_path(cr);
+    cairo_set_tolerance(cr, tol);
+    cairo_append_path(cr, c->path);
+    cairo_path_t *flat = cairo_copy_path_flat(cr);
+    cairo_new_path(cr);
+    long edges = 0;
+    for (int i = 0; i < flat->num_data; i += flat->data[i].header.length) {
+        cairo_path_data_type_t t = flat->data[i].header.type;
+        if (t == CAIRO_PATH_LINE_TO || t == CAIRO_PATH_CLOSE_PATH) edges++;
+    }
+    cairo_path_destroy(flat);
+    return edges;
+}
+
+static long count_covered(cairo_surface_t *s) {
+    cairo_surface_flush(s);
+    const unsigned char *px = cairo_image_surface_get_data(s);
+    int stride = cairo_image_surface_get_stride(s);
+    long n = 0;
+    for (int y = 0; y < CANVAS_H; y++)
+        for (int x = 0; x < CANVAS_W; x++)
+            n += px[(size_t)y * stride + x] != 0;
+    return n;
+}
+
+static void clear(cairo_t *cr) {
+    cairo_save(cr);
+    cairo_set_operator(cr, CAIRO_OPERATOR_CLEAR);
+    cairo_paint(cr);
+    cairo_restore(cr);
+}
+
+static void render(cairo_t *cr, const captured_path_t *c, int mode, int aa, double tol) {
+    cairo_new_path(cr);
+    cairo_set_antialias(cr, (cairo_antialias_t)aa);
+    cairo_set_tolerance(cr, tol);
+    cairo_append_path(cr, c->path);
+    if (mode == MODE_FILL) {
+        cairo_set_fill_rule(cr, c->fill_rule);
+        cairo_fill(cr);
+    } else {
+        cairo_set_line_width(cr, c->line_width);
+        cairo_set_line_cap(cr, c->cap);
+        cairo_set_line_join(cr, c->join);
+        cairo_set_miter_limit(cr, c->miter_limit);
+        cairo_set_dash(cr, c->dashes, c->num_dashes, c->dash_offset);
+        cairo_stroke(cr);
+    }
+    cairo_surface_flush(cairo_get_target(cr));
+}
+
+static void dump_path(const char *dir, size_t idx, const captured_path_t *c) {
+    char fname[4096];
+    snprintf(fname, sizeof(fname), "%s/path_%zu_%016llx.txt", dir, idx, (unsigned long long)c->hash);
+    FILE *fp = fopen(fname, "w");
+    if (!fp) { perror(fname); return; }
+    fprintf(fp, "# from %s (op %d) width=%g cap=%d join=%d miter=%g rule=%d dashes=%d\n",
+            c->origin, c->op, c->line_width, c->cap, c->join, c->miter_limit, c->fill_rule,
+            c->num_dashes);
+    for (int i = 0; i < c->path->num_data; i += c->path->data[i].header.length) {
+        const cairo_path_data_t *d = &c->path->data[i];
+        switch (d->header.type) {
+        case CAIRO_PATH_MOVE_TO: fprintf(fp, "M %.17g %.17g\n", d[1].point.x, d[1].point.y); break;
+        case CAIRO_PATH_LINE_TO: fprintf(fp, "L %.17g %.17g\n", d[1].point.x, d[1].point.y); break;
+        case CAIRO_PATH_CURVE_TO:
+            fprintf(fp, "C %.17g %.17g %.17g %.17g %.17g %.17g\n", d[1].point.x, d[1].point.y,
+                    d[2].point.x, d[2].point.y, d[3].point.x, d[3].point.y);
+            break;
+        default: fprintf(fp, "Z\n"); break;
+        }
+    }
+    fclose(fp);
+}
+
+static int cmp_sample_desc(const void *a, const void *b) {
+    const sample_t *x = a, *y = b;
+    double rx = x->ns / (x->edges ? x->edges : 1), ry = y->ns / (y->edges ? y->edges : 1);
+    return (rx < ry) - (rx > ry);
+}
+
+int main(int argc, char **argv) {
+    int reps = 3, csv = 0;
+    const char *dump_dir = NULL;
+    int argi = 1;
+    for (; argi < argc && argv[argi][0] == '-'; argi++) {
+        if (!strcmp(argv[argi], "-r") && argi + 1 < argc) reps = atoi(argv[++argi]);
+        else if (!strcmp(argv[argi], "-n") && argi + 1 < argc) max_paths = (size_t)atol(argv[++argi]);
+        else if (!strcmp(argv[argi], "-o") && argi + 1 < argc) dump_dir = argv[++argi];
+        else if (!strcmp(argv[argi], "--csv")) csv = 1;
+        else break;
+    }
+    if (argi >= argc) {
+        fprintf(stderr, "usage: %s [-r reps] [-n max_paths] [-o dump_dir] [--csv] <corpus_dir|file|pack>...\n",
+                argv[0]);
+        return 1;
+    }
+    if (reps < 1) reps = 1;
+
+    srand(0);
+    paths = calloc(max_paths, sizeof(*paths));
+    for (; argi < argc; argi++)
+        bench_for_each_input(argv[argi], capture_input, NULL);
+    fprintf(stderr, "captured %zu distinct paths\n", num_paths);
+    if (num_paths == 0) return 1;
+
+    cairo_surface_t *surf = cairo_image_surface_create(CAIRO_FORMAT_A8, CANVAS_W, CANVAS_H);
+    cairo_t *cr = cairo_create(surf);
+    cairo_set_source_rgba(cr, 0, 0, 0, 1);
+
+    size_t nsamples = num_paths * NUM_MODES * NUM_ANTIALIAS * NUM_TOLERANCES;
+    sample_t *samples = calloc(nsamples, sizeof(*samples));
+    size_t ns = 0;
+
+    if (csv) printf("origin,op,path,mode,antialias,tolerance,edges,pixels,ns\n");
+    for (size_t pi = 0; pi < num_paths; pi++) {
+        const captured_path_t *c = &paths[pi];
+        for (int ti = 0; ti < NUM_TOLERANCES; ti++) {
+            long edges = count_flat_edges(cr, c, tolerances[ti]);
+            for (int mode = 0; mode < NUM_MODES; mode++) {
+                for (int aa = 0; aa < NUM_ANTIALIAS; aa++) {
+                    clear(cr);
+                    render(cr, c, mode, aa, tolerances[ti]);
+                    long pixels = count_covered(surf);
+
+                    double best = INFINITY;
+                    for (int r = 0; r < reps; r++) {
+                        clear(cr);
+                        uint64_t t0 = now_ns();
+                        render(cr, c, mode, aa, tolerances[ti]);
+                        double dt = (double)(now_ns() - t0);
+                        if (dt < best) best = dt;
+                    }
+                    samples[ns++] = (sample_t){ best, edges, pixels, (int)pi, mode, aa, ti };
+                    if (csv)
+                        printf("%s,%d,%zu,%s,%s,%g,%ld,%ld,%.0f\n", c->origin, c->op, pi,
+                               mode_names[mode], bench_antialias_names[aa], tolerances[ti],
+                               edges, pixels, best);
+                }
+            }
+        }
+    }
+
+    if (!csv) {
+        printf("%-7s %-9s %9s %12s %12s %14s\n", "mode", "antialias", "tolerance",
+               "total_ms", "ns/edge", "ns/covered_px");
+        for (int mode = 0; mode < NUM_MODES; mode++)
+            for (int aa = 0; aa < NUM_ANTIALIAS; aa++)
+                for (int ti = 0; ti < NUM_TOLERANCES; ti++) {
+                    double tot = 0;
+                    long edges = 0, pixels = 0;
+                    for (size_t i = 0; i < ns; i++) {
+                        if (samples[i].mode != mode || samples[i].aa != aa || samples[i].tol != ti) continue;
+                        tot += samples[i].ns;
+                        edges += samples[i].edges;
+                        pixels += samples[i].pixels;
+                    }
+                    printf("%-7s %-9s %9g %12.3f %12.2f %14.2f\n", mode_names[mode],
+                           bench_antialias_names[aa], tolerances[ti], tot / 1e6,
+                           edges ? tot / edges : 0.0, pixels ? tot / pixels : 0.0);
+                }
+
+        qsort(samples, ns, sizeof(*samples), cmp_sample_desc);
+        printf("\n== %d slowest (path, config) by ns/edge ==\n", TOP_N);
+        for (size_t i = 0; i < ns && i < TOP_N; i++) {
+            const sample_t *s = &samples[i];
+            const captured_path_t *c = &paths[s->path];
+            printf("%10.1f ns/edge %8ld edges %8ld px  %-6s %-8s tol=%-5g path=%d op=%d %s\n",
+                   s->ns / (s->edges ? s->edges : 1), s->edges, s->pixels, mode_names[s->mode],
+                   bench_antialias_names[s->aa], tolerances[s->tol], s->path, c->op, c->origin);
+            if (dump_dir) dump_path(dump_dir, (size_t)s->path, c);
+        }
+    }
+
+    cairo_destroy(cr);
+    cairo_surface_destroy(surf);
+    for (size_t i = 0; i < num_paths; i++) {
+        cairo_path_destroy(paths[i].path);
+        free(paths[i].origin);
+    }
+    free(paths);
+    free(samples);
+    return 0;
+}
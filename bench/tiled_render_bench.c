@@ -0,0 +1,334 @@
+// bench/tiled_render_bench.c
+// Tiled multi-threaded rendering of recorded inputs. Every corpus input is
+// played into a recording surface (backend forced through bench_pick_backend(),
+// recording taken in bench_on_recording()), which is then rendered at -z zoom:
+//   full   - once, single-threaded, into one ARGB32 image (the reference)
+//   tiled  - cut into -s sized tiles that a pool of T threads pulls from; each
+//            thread has its own image surface and a translated, clipped
+//            cairo_t, and copies its tiles into a shared stitched image
+// for T = 1..-j. All threads replay the same recording at once, so cairo's
+// shared caches (glyphs, scaled fonts, pattern/snapshot caches, the recording's
+// own snapshot) see real contention.
+//
+// The stitched image is compared to the reference after every thread count.
+// A pixel that differs by more than -e in any channel is a mismatch; a
+// mismatch within one pixel of a tile edge counts as a seam. Mismatching
+// inputs are listed, and with -o the reference and stitched images are written
+// there as PNGs. The table at the end gives best-of -r times summed over the
+// corpus, speedup against the 1-thread tiled run and per-thread efficiency;
+// efficiency dropping well below 1 with plenty of tiles points at locks.
+//
+//   tiled_render_bench [-j max_threads] [-s tile] [-z zoom] [-r reps] [-e tolerance]
+//                      [-n top] [-o png_dir] [--csv] <corpus_dir|file|pack>...
+#include "bench_common.h"
+#include "bench_hooks.h"
+#include <math.h>
+#include <pthread.h>
+
+#define MAX_THREADS 64
+
+static int max_threads = 8, tile = 128, reps = 3, tolerance = 0, top_n = 20;
+static double zoom = 4.0;
+static const char *png_dir;
+
+static cairo_surface_t *recorded;
+
+int bench_pick_backend(int sel) {
+    (void)sel;
+    return BE_RECORDING;
+}
+
+void bench_on_recording(cairo_surface_t *surface) {
+    if (recorded) cairo_surface_destroy(recorded);
+    recorded = cairo_surface_reference(surface);
+}
+
+/* ---------- one render job, shared by the pool ---------- */
+typedef struct {
+    cairo_surface_t *rec;
+    uint8_t         *stitched;
+    int              stride, w, h, tiles_x, tiles;
+    int              threads;       /* workers that take part in this run */
+    int              next;          /* atomic tile cursor */
+} job_t;
+
+typedef struct {
+    pthread_t        tid;
+    cairo_surface_t *tile_surface;  /* tile x tile, private to the thread */
+} worker_t;
+
+typedef struct {
+    int               n;
+    worker_t          workers[MAX_THREADS];
+    pthread_barrier_t start, done;
+    job_t            *job;
+    int               quit;
+} pool_t;
+
+static void paint_recording(cairo_t *cr, cairo_surface_t *rec) {
+    cairo_scale(cr, zoom, zoom);
+    cairo_set_source_surface(cr, rec, 0, 0);
+    cairo_paint(cr);
+}
+
+static void render_tile(worker_t *w, job_t *job, int t) {
+    int tx = (t % job->tiles_x) * tile, ty = (t / job->tiles_x) * tile;
+    int tw = job->w - tx < tile ? job->w - tx : tile;
+    int th = job->h - ty < tile ? job->h - ty : tile;
+
+    cairo_t *cr = cairo_create(w->tile_surface);
+    cairo_set_operator(cr, CAIRO_OPERATOR_CLEAR);
+    cairo_paint(cr);
+    cairo_set_operator(cr, CAIRO_OPERATOR_OVER);
+    cairo_translate(cr, -tx, -ty);
+    cairo_rectangle(cr, tx, ty, tw, th);
+    cairo_clip(cr);
+    paint_recording(cr, job->rec);
+    cairo_destroy(cr);
+    cairo_surface_flush(w->tile_surface);
+
+    const uint8_t *src = cairo_image_surface_get_data(w->tile_surface);
+    int src_stride = cairo_image_surface_get_stride(w->tile_surface);
+    for (int y = 0; y < th; y++)
+        memcpy(job->stitched + (size_t)(ty + y) * job->stride + (size_t)tx * 4,
+               src + (size_t)y * src_stride, (size_t)tw * 4);
+}
+
+static void run_tiles(worker_t *w, job_t *job) {
+    int t;
+    while ((t = __atomic_fetch_add(&job->next, 1, __ATOMIC_RELAXED)) < job->tiles)
+        render_tile(w, job, t);
+}
+
+typedef struct {
+    pool_t *pool;
+    int     index;
+} worker_arg_t;
+
+static void *worker_main(void *arg) {
+    pool_t *pool = ((worker_arg_t*)arg)->pool;
+    worker_t *w = &pool->workers[((worker_arg_t*)arg)->index];
+    free(arg);
+    for (;;) {
+        pthread_barrier_wait(&pool->start);
+        if (pool->quit) break;
+        if (w - pool->workers < pool->job->threads) run_tiles(w, pool->job);
+        pthread_barrier_wait(&pool->done);
+    }
+    return NULL;
+}
+
+/* n - 1 helper threads; the caller is worker 0. A run with fewer threads
+ * leaves the other workers waiting at the barriers. */
+static void pool_init(pool_t *pool, int n) {
+    memset(pool, 0, sizeof(*pool));
+    pool->n = n;
+    pthread_barrier_init(&pool->start, NULL, (unsigned)n);
+    pthread_barrier_init(&pool->done, NULL, (unsigned)n);
+    for (int i = 0; i < n; i++) {
+        pool->workers[i].tile_surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, tile, tile);
+        if (i == 0) continue;
+        worker_arg_t *arg = malloc(sizeof(*arg));
+        *arg = (worker_arg_t){ pool, i };
+        pthread_create(&pool->workers[i].tid, NULL, worker_main, arg);
+    }
+}
+
+static void pool_run(pool_t *pool, job_t *job, int threads) {
+    job->threads = threads;
+    job->next = 0;
+    pool->job = job;
+    pthread_barrier_wait(&pool->start);
+    run_tiles(&pool->workers[0], job);
+    pthread_barrier_wait(&pool->done);
+}
+
+static void pool_destroy(pool_t *pool) {
+    pool->quit = 1;
+    pthread_barrier_wait(&pool->start);
+    for (int i = 0; i < pool->n; i++) {
+        if (i) pthread_join(pool->workers[i].tid, NULL);
+        cairo_surface_destroy(pool->workers[i].tile_surface);
+    }
+    pthread_barrier_destroy(&pool->start);
+    pthread_barrier_destroy(&pool->done);
+}
+
+/* ---------- comparison ---------- */
+typedef struct {
+    uint64_t mismatched, seam;
+    int      max_diff;
+} diff_t;
+
+static diff_t compare(const uint8_t *ref, const uint8_t *got, int stride, int w, int h) {
+    diff_t d = { 0, 0, 0 };
+    for (int y = 0; y < h; y++) {
+        const uint8_t *a = ref + (size_t)y * stride, *b = got + (size_t)y * stride;
+        int ey = y % tile == 0 || y % tile == tile - 1;
+        for (int x = 0; x < w; x++) {
+            int m = 0;
+            for (int c = 0; c < 4; c++) {
+                int diff = abs(a[x * 4 + c] - b[x * 4 + c]);
+                if (diff > m) m = diff;
+            }
+            if (m <= tolerance) continue;
+            d.mismatched++;
+            if (ey || x % tile == 0 || x % tile == tile - 1) d.seam++;
+            if (m > d.max_diff) d.max_diff = m;
+        }
+    }
+    return d;
+}
+
+static void dump_png(const char *origin, const char *what, int threads, const uint8_t *pixels,
+                     int stride, int w, int h) {
+    char path[4096];
+    const char *base = strrchr(origin, '/');
+    base = base ? base + 1 : origin;
+    if (threads)
+        snprintf(path, sizeof(path), "%s/%s.%s%d.png", png_dir, base, what, threads);
+    else
+        snprintf(path, sizeof(path), "%s/%s.%s.png", png_dir, base, what);
+    cairo_surface_t *s = cairo_image_surface_create_for_data((unsigned char*)pixels, CAIRO_FORMAT_ARGB32,
+                                                             w, h, stride);
+    cairo_surface_write_to_png(s, path);
+    cairo_surface_destroy(s);
+}
+
+/* ---------- per input ---------- */
+static pool_t pool;
+static double full_total;
+static double tiled_total[MAX_THREADS + 1];
+static size_t num_inputs, num_mismatched;
+static int csv;
+
+static void render_input(const char *name, const uint8_t *data, size_t size, void *ctx) {
+    (void)ctx;
+    LLVMFuzzerTestOneInput(data, size);
+    cairo_surface_t *rec = recorded;
+    recorded = NULL;
+    if (!rec) return;
+
+    cairo_rectangle_t ext;
+    if (!cairo_recording_surface_get_extents(rec, &ext)) ext = (cairo_rectangle_t){ 0, 0, 256, 256 };
+    int w = (int)ceil(ext.width * zoom), h = (int)ceil(ext.height * zoom);
+    cairo_surface_t *full = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, w, h);
+    cairo_surface_t *stitched = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, w, h);
+    if (cairo_surface_status(full) || cairo_surface_status(stitched)) {
+        cairo_surface_destroy(full);
+        cairo_surface_destroy(stitched);
+        cairo_surface_destroy(rec);
+        return;
+    }
+    int stride = cairo_image_surface_get_stride(full);
+    uint8_t *ref = cairo_image_surface_get_data(full);
+
+    double best_full = INFINITY;
+    for (int r = 0; r < reps; r++) {
+        cairo_t *cr = cairo_create(full);
+        cairo_set_operator(cr, CAIRO_OPERATOR_CLEAR);
+        cairo_paint(cr);
+        cairo_set_operator(cr, CAIRO_OPERATOR_OVER);
+        uint64_t t0 = now_ns();
+        paint_recording(cr, rec);
+        cairo_surface_flush(full);
+        double dt = (double)(now_ns() - t0);
+        cairo_destroy(cr);
+        if (dt < best_full) best_full = dt;
+    }
+    full_total += best_full;
+
+    job_t job = { rec, cairo_image_surface_get_data(stitched), stride, w, h,
+                  (w + tile - 1) / tile, 0, 0, 0 };
+    job.tiles = job.tiles_x * ((h + tile - 1) / tile);
+    if (stride != cairo_image_surface_get_stride(stitched)) abort();
+
+    int bad = 0;
+    if (csv) printf("%s,%d,%d,%.0f", name, w, h, best_full);
+    for (int t = 1; t <= max_threads; t++) {
+        double best = INFINITY;
+        for (int r = 0; r < reps; r++) {
+            uint64_t t0 = now_ns();
+            pool_run(&pool, &job, t);
+            double dt = (double)(now_ns() - t0);
+            if (dt < best) best = dt;
+        }
+        tiled_total[t] += best;
+        cairo_surface_mark_dirty(stitched);
+
+        diff_t d = compare(ref, job.stitched, stride, w, h);
+        if (csv) printf(",%.0f,%llu", best, (unsigned long long)d.mismatched);
+        if (!d.mismatched) continue;
+        if (!bad && num_mismatched < (size_t)top_n && !csv)
+            printf("mismatch %s: %d threads, %llu px (%llu on seams), max diff %d\n", name, t,
+                   (unsigned long long)d.mismatched, (unsigned long long)d.seam, d.max_diff);
+        if (png_dir) {
+            if (!bad) dump_png(name, "full", 0, ref, stride, w, h);
+            dump_png(name, "tiled", t, job.stitched, stride, w, h);
+        }
+        bad = 1;
+    }
+    if (csv) printf("\n");
+    num_inputs++;
+    num_mismatched += bad;
+
+    cairo_surface_destroy(full);
+    cairo_surface_destroy(stitched);
+    cairo_surface_destroy(rec);
+}
+
+int main(int argc, char **argv) {
+    int argi = 1;
+    for (; argi < argc && argv[argi][0] == '-'; argi++) {
+        if (!strcmp(argv[argi], "-j") && argi + 1 < argc) max_threads = atoi(argv[++argi]);
+        else if (!strcmp(argv[argi], "-s") && argi + 1 < argc) tile = atoi(argv[++argi]);
+        else if (!strcmp(argv[argi], "-z") && argi + 1 < argc) zoom = atof(argv[++argi]);
+        else if (!strcmp(argv[argi], "-r") && argi + 1 < argc) reps = atoi(argv[++argi]);
+        else if (!strcmp(argv[argi], "-e") && argi + 1 < argc) tolerance = atoi(argv[++argi]);
+        else if (!strcmp(argv[argi], "-n") && argi + 1 < argc) top_n = atoi(argv[++argi]);
+        else if (!strcmp(argv[argi], "-o") && argi + 1 < argc) png_dir = argv[++argi];
+        else if (!strcmp(argv[argi], "--csv")) csv = 1;
+        else break;
+    }
+    if (argi >= argc) {
+        fprintf(stderr, "usage: %s [-j max_threads] [-s tile] [-z zoom] [-r reps] [-e tolerance]\n"
+                        "       [-n top] [-o png_dir] [--csv] <corpus_dir|file|pack>...\n", argv[0]);
+        return 1;
+    }
+    if (max_threads < 1) max_threads = 1;
+    if (max_threads > MAX_THREADS) max_threads = MAX_THREADS;
+    if (tile < 8) tile = 8;
+    if (reps < 1) reps = 1;
+    if (!(zoom > 0) || zoom > 32) zoom = 4.0;
+    if (png_dir) mkdir(png_dir, 0755);
+
+    pool_init(&pool, max_threads);
+
+    if (csv) {
+        printf("origin,width,height,full_ns");
+        for (int t = 1; t <= max_threads; t++) printf(",t%d_ns,t%d_mismatch", t, t);
+        printf("\n");
+    }
+    srand(0);
+    for (; argi < argc; argi++)
+        bench_for_each_input(argv[argi], render_input, NULL);
+
+    pool_destroy(&pool);
+    if (recorded) cairo_surface_destroy(recorded);
+
+    if (num_inputs == 0) {
+        fprintf(stderr, "no input produced a recording\n");
+        return 1;
+    }
+    if (csv) return 0;
+
+    printf("\n== %zu inputs, zoom %.2f, %dx%d tiles, best of %d; %zu mismatching ==\n", num_inputs, zoom, tile,
+           tile, reps, num_mismatched);
+    printf("%-8s %12s %9s %11s\n", "threads", "total_ms", "speedup", "efficiency");
+    printf("%-8s %12.3f %9s %11s\n", "full", full_total / 1e6, "-", "-");
+    for (int t = 1; t <= max_threads; t++) {
+        double speedup = tiled_total[t] > 0 ? tiled_total[1] / tiled_total[t] : 0.0;
+        printf("%-8d %12.3f %9.2f %11.2f\n", t, tiled_total[t] / 1e6, speedup, speedup / t);
+    }
+    return num_mismatched ? 2 : 0;
+}
@@ -0,0 +1,199 @@
+// bench/vector_backend_bench.c
+// Replays corpus inputs into the PDF, SVG and PostScript surfaces and reports
+// what the vector backends emit: bytes and write calls per page, ms per page,
+// and how that time splits between drawing (ops + show_page) and
+// cairo_surface_finish, where fonts, patterns and the object table get written.
+// Every input is replayed -r times per backend and the output hashes compared,
+// so nondeterministic emission shows up as well.
+//
+// Links against the stateful harness built with -DBENCH_BUILD; the backend byte
+// of each input is overridden through bench_pick_backend() and the harness's
+// output sink is read through bench_on_vector(). SOURCE_DATE_EPOCH is set and
+// the PDF dates pinned so timestamps don't count as nondeterminism (PS honours
+// SOURCE_DATE_EPOCH only in newer cairo).
+//
+//   vector_backend_bench [-r reps] [-b pdf,svg,ps] [-n top] [--csv] <corpus_dir|file|pack>...
+#include "bench_common.h"
+#include "bench_hooks.h"
+#include <cairo-pdf.h>
+#include <math.h>
+
+enum { VB_PDF, VB_SVG, VB_PS, NUM_VB };
+static const char *const vb_names[NUM_VB] = { "pdf", "svg", "ps" };
+static const backend_e vb_backend[NUM_VB] = { BE_PDF, BE_SVG, BE_PS };
+
+typedef struct {
+    char    *origin;
+    int      backend;
+    uint64_t bytes, writes, hash;
+    double   draw_ns, finish_ns;
+    int      nondet;
+} record_t;
+
+static record_t *records;
+static size_t num_records, cap_records;
+static int reps = 2, top_n = 10;
+static int enabled[NUM_VB] = { 1, 1, 1 };
+
+/* per replay, filled by the hooks */
+static int forced = -1;
+static int seen_phases;
+static uint64_t t_created, t_drawn, t_finished;
+static output_sink_t last_sink;
+
+int bench_pick_backend(int sel) {
+    return forced >= 0 ? forced : sel;
+}
+
+void bench_on_vector(int phase, cairo_surface_t *surface, const output_sink_t *sink) {
+    uint64_t t = now_ns();
+    seen_phases |= 1 << phase;
+    switch (phase) {
+    case BENCH_VECTOR_CREATED:
+#if CAIRO_VERSION >= CAIRO_VERSION_ENCODE(1, 16, 0)
+        if (cairo_surface_get_type(surface) == CAIRO_SURFACE_TYPE_PDF) {
+            cairo_pdf_surface_set_metadata(surface, CAIRO_PDF_METADATA_CREATE_DATE, "2000-01-01T00:00:00Z");
+            cairo_pdf_surface_set_metadata(surface, CAIRO_PDF_METADATA_MOD_DATE, "2000-01-01T00:00:00Z");
+        }
+#endif
+        t = now_ns();
+        t_created = t;
+        break;
+    case BENCH_VECTOR_DRAWN:
+        t_drawn = t;
+        break;
+    case BENCH_VECTOR_FINISHED:
+        t_finished = t;
+        last_sink = *sink;
+        break;
+    }
+}
+
+static void replay_input(const char *name, const uint8_t *data, size_t size, void *ctx) {
+    (void)ctx;
+    for (int b = 0; b < NUM_VB; b++) {
+        if (!enabled[b]) continue;
+        record_t r = { .backend = b, .draw_ns = INFINITY, .finish_ns = INFINITY };
+        int ok = 1;
+        forced = vb_backend[b];
+        for (int i = 0; i < reps && ok; i++) {
+            seen_phases = 0;
+            srand(0);   /* the harness draws some operands from rand() */
+            LLVMFuzzerTestOneInput(data, size);
+            if (seen_phases != 7) { ok = 0; break; }
+            double draw = (double)(t_drawn - t_created), fin = (double)(t_finished - t_drawn);
+            if (draw < r.draw_ns) r.draw_ns = draw;
+            if (fin < r.finish_ns) r.finish_ns = fin;
+            if (i == 0) {
+                r.bytes = last_sink.bytes;
+                r.writes = last_sink.writes;
+                r.hash = last_sink.hash;
+            } else if (last_sink.hash != r.hash || last_sink.bytes != r.bytes) {
+                r.nondet = 1;
+            }
+        }
+        forced = -1;
+        if (!ok) continue;
+
+        if (num_records == cap_records) {
+            cap_records = cap_records ? cap_records * 2 : 1024;
+            records = realloc(records, cap_records * sizeof(*records));
+        }
+        r.origin = strdup(name);
+        records[num_records++] = r;
+    }
+}
+
+static int by_finish_desc(const void *a, const void *b) {
+    const record_t *x = *(record_t *const *)a, *y = *(record_t *const *)b;
+    return (x->finish_ns < y->finish_ns) - (x->finish_ns > y->finish_ns);
+}
+
+static void parse_backends(const char *list) {
+    for (int b = 0; b < NUM_VB; b++) enabled[b] = strstr(list, vb_names[b]) != NULL;
+}
+
+int main(int argc, char **argv) {
+    int csv = 0;
+    int argi = 1;
+    for (; argi < argc && argv[argi][0] == '-'; argi++) {
+        if (!strcmp(argv[argi], "-r") && argi + 1 < argc) reps = atoi(argv[++argi]);
+        else if (!strcmp(argv[argi], "-b") && argi + 1 < argc) parse_backends(argv[++argi]);
+        else if (!strcmp(argv[argi], "-n") && argi + 1 < argc) top_n = atoi(argv[++argi]);
+        else if (!strcmp(argv[argi], "--csv")) csv = 1;
+        else break;
+    }
+    if (argi >= argc) {
+        fprintf(stderr, "usage: %s [-r reps] [-b pdf,svg,ps] [-n top] [--csv] <corpus_dir|file|pack>...\n",
+                argv[0]);
+        return 1;
+    }
+    if (reps < 1) reps = 1;
+    if (reps < 2) fprintf(stderr, "note: -r 1 skips the determinism check\n");
+
+    setenv("SOURCE_DATE_EPOCH", "946684800", 0);
+    for (; argi < argc; argi++)
+        bench_for_each_input(argv[argi], replay_input, NULL);
+    if (num_records == 0) {
+        fprintf(stderr, "no input produced a vector surface\n");
+        return 1;
+    }
+
+    if (csv) {
+        printf("origin,backend,bytes,writes,hash,draw_ns,finish_ns,deterministic\n");
+        for (size_t i = 0; i < num_records; i++) {
+            const record_t *r = &records[i];
+            printf("%s,%s,%llu,%llu,%016llx,%.0f,%.0f,%d\n", r->origin, vb_names[r->backend],
+                   (unsigned long long)r->bytes, (unsigned long long)r->writes,
+                   (unsigned long long)r->hash, r->draw_ns, r->finish_ns, !r->nondet);
+        }
+        return 0;
+    }
+
+    printf("%-4s %7s %10s %11s %10s %10s %10s %10s %8s %10s %7s\n", "be", "pages", "total_MB",
+           "bytes/page", "writes/pg", "bytes/wr", "draw_ms", "finish_ms", "finish%", "ms/page", "nondet");
+    for (int b = 0; b < NUM_VB; b++) {
+        if (!enabled[b]) continue;
+        size_t n = 0, nondet = 0;
+        double bytes = 0, writes = 0, draw = 0, fin = 0;
+        for (size_t i = 0; i < num_records; i++) {
+            const record_t *r = &records[i];
+            if (r->backend != b) continue;
+            n++;
+            bytes += (double)r->bytes;
+            writes += (double)r->writes;
+            draw += r->draw_ns;
+            fin += r->finish_ns;
+            nondet += r->nondet;
+        }
+        if (!n) continue;
+        printf("%-4s %7zu %10.2f %11.0f %10.1f %10.1f %10.3f %10.3f %7.1f%% %10.3f %7zu\n",
+               vb_names[b], n, bytes / 1e6, bytes / n, writes / n, writes > 0 ? bytes / writes : 0.0,
+               draw / n / 1e6, fin / n / 1e6, draw + fin > 0 ? 100.0 * fin / (draw + fin) : 0.0,
+               (draw + fin) / n / 1e6, nondet);
+    }
+
+    record_t **sorted = malloc(num_records * sizeof(*sorted));
+    for (int b = 0; b < NUM_VB; b++) {
+        if (!enabled[b]) continue;
+        size_t n = 0;
+        for (size_t i = 0; i < num_records; i++)
+            if (records[i].backend == b) sorted[n++] = &records[i];
+        if (!n) continue;
+        qsort(sorted, n, sizeof(*sorted), by_finish_desc);
+        printf("\nslowest %s finish:\n", vb_names[b]);
+        for (size_t i = 0; i < n && i < (size_t)top_n; i++)
+            printf("  %10.3f ms finish %10.3f ms draw %10llu bytes  %s\n", sorted[i]->finish_ns / 1e6,
+                   sorted[i]->draw_ns / 1e6, (unsigned long long)sorted[i]->bytes, sorted[i]->origin);
+    }
+    free(sorted);
+
+    size_t shown = 0;
+    for (size_t i = 0; i < num_records; i++) {
+        if (!records[i].nondet) continue;
+        if (shown++ == 0) printf("\nnondeterministic output:\n");
+        if (shown <= (size_t)top_n) printf("  %-4s %s\n", vb_names[records[i].backend], records[i].origin);
+    }
+    if (shown > (size_t)top_n) printf("  ... %zu more\n", shown - (size_t)top_n);
+    return 0;
+}
@@ -0,0 +1,280 @@
+// fuzz/adaptive_ops.h
+// Adaptive op scheduling for the stateful harness (-DADAPTIVE_OPS).
+//
+// The harness keeps, per opcode slot, how often it ran, how much CPU time it
+// took and how much new coverage the runs it took part in found. New coverage
+// is read straight from the inline 8-bit counters (__sancov_cntrs) at the end of
+// every run and compared against our own "ever seen" bitmap; the new edges are
+// credited evenly to the distinct ops of that run. Statistics are halved every
+// ADAPT_DECAY_EVERY runs so old discoveries stop dominating once the farm
+// plateaus.
+//
+// LLVMFuzzerCustomMutator uses those statistics as a UCB1 bandit: each
+// enabled op is scored by (new edges per CPU ms) plus an exploration bonus,
+// and half the mutations retype an existing op or insert a new op (opcode plus
+// random operand bytes sized from its ops.def signature) drawn with
+// probability proportional to its score. Op positions come from the last run
+// of the same input; the other half is plain LLVMFuzzerMutate.
+//
+// Current statistics and weights are written to $ADAPT_STATS
+// (default ./adaptive_stats.txt) every ADAPT_DUMP_EVERY runs and at exit.
+#ifndef ADAPTIVE_OPS_H
+#define ADAPTIVE_OPS_H
+
+#include "op_registry.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define ADAPT_DECAY_EVERY  20000
+#define ADAPT_DUMP_EVERY   10000
+#define ADAPT_UCB_C        0.5
+#define ADAPT_MAX_POS      512     /* op offsets remembered per input */
+#define ADAPT_POS_CACHE    4096    /* inputs remembered */
+
+extern uint8_t __start___sancov_cntrs[] __attribute__((weak));
+extern uint8_t __stop___sancov_cntrs[] __attribute__((weak));
+size_t LLVMFuzzerMutate(uint8_t *data, size_t size, size_t max_size);
+
+typedef struct {
+    double pulls;       /* runs containing the op */
+    double edges;       /* new edges credited */
+    double cost_ns;     /* time in the op, scaled to CPU time (adapt_now) */
+} adapt_stat_t;
+
+typedef struct {
+    uint64_t hash;
+    uint32_t n;
+    uint32_t pos[ADAPT_MAX_POS];
+} adapt_positions_t;
+
+static adapt_stat_t adapt_stats[OP_SLOTS];
+static double adapt_weights[OP_SLOTS];
+static double adapt_total_pulls;
+static uint64_t adapt_runs, adapt_total_new;
+static uint8_t *adapt_seen;
+static size_t adapt_ncounters;
+static const char *adapt_stats_path;
+
+/* per run */
+static uint8_t adapt_in_run[OP_SLOTS];
+static double adapt_run_cost[OP_SLOTS];
+static uint64_t adapt_op_start;
+static uint64_t adapt_exec_wall, adapt_exec_cpu;
+static adapt_positions_t adapt_cur;
+static adapt_positions_t *adapt_pos_cache;
+
+/* Ops are timed with CLOCK_MONOTONIC, which the vDSO answers without a
+ * syscall. Process CPU time is a real syscall, so it is only read at the
+ * ends of a run, and the run's op times are scaled by its CPU/wall ratio so
+ * ops aren't charged for preemption or I/O waits of the host. */
+static inline uint64_t adapt_clock(clockid_t id) {
+    struct timespec ts;
+    clock_gettime(id, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static inline uint64_t adapt_now(void) {
+    return adapt_clock(CLOCK_MONOTONIC);
+}
+
+static uint64_t adapt_hash(const uint8_t *data, size_t size) {
+    uint64_t h = 1469598103934665603ull;
+    for (size_t i = 0; i < size; i++) { h ^= data[i]; h *= 1099511628211ull; }
+    return h;
+}
+
+/* Rough operand length of an op: the fixed part of its signature, taking the
+ * first alternative of a (..|..) and skipping repeated [..] groups. */
+static size_t adapt_operand_bytes(int op) {
+    size_t n = 0;
+    int depth = 0, counting = 1;
+    for (const char *s = op_signatures[op]; s && *s; s++) {
+        switch (*s) {
+        case '[': case '(': depth++; counting = depth == 1 && *s == '('; break;
+        case ']': case ')': depth--; counting = depth == 0; break;
+        case '|': if (depth == 1) counting = 0; break;
+        case 'i': if (counting) n += 4; break;
+        case 'd': case 'u': case 'a': case 'k': case 's': if (counting) n += 8; break;
+        case 'm': if (counting) n += 48; break;
+        default: break;
+        }
+    }
+    return n;
+}
+
+static void adapt_dump(void);
+
+static void adapt_init(void) {
+    adapt_stats_path = getenv("ADAPT_STATS");
+    if (!adapt_stats_path) adapt_stats_path = "adaptive_stats.txt";
+    if (__start___sancov_cntrs && (uintptr_t)__stop___sancov_cntrs > (uintptr_t)__start___sancov_cntrs) {
+        adapt_ncounters = (size_t)(__stop___sancov_cntrs - __start___sancov_cntrs);
+        adapt_seen = calloc(adapt_ncounters, 1);
+    } else {
+        fprintf(stderr, "[adapt] no inline 8-bit counters, scheduling on cost only\n");
+    }
+    adapt_pos_cache = calloc(ADAPT_POS_CACHE, sizeof(*adapt_pos_cache));
+    atexit(adapt_dump);
+}
+
+static inline void adapt_exec_begin(void) {
+    if (!adapt_stats_path) adapt_init();
+    memset(adapt_in_run, 0, sizeof(adapt_in_run));
+    memset(adapt_run_cost, 0, sizeof(adapt_run_cost));
+    adapt_cur.n = 0;
+    adapt_exec_cpu = adapt_clock(CLOCK_PROCESS_CPUTIME_ID);
+    adapt_exec_wall = adapt_now();
+}
+
+static inline void adapt_op_begin(int op, size_t offset) {
+    adapt_in_run[op] = 1;
+    if (adapt_cur.n < ADAPT_MAX_POS) adapt_cur.pos[adapt_cur.n++] = (uint32_t)offset;
+    adapt_op_start = adapt_now();
+}
+
+static inline void adapt_op_end(int op) {
+    adapt_run_cost[op] += (double)(adapt_now() - adapt_op_start);
+}
+
+static size_t adapt_count_new_edges(void) {
+    size_t fresh = 0;
+    const uint8_t *c = __start___sancov_cntrs;
+    for (size_t i = 0; i < adapt_ncounters; i++) {
+        if (c[i] && !adapt_seen[i]) {
+            adapt_seen[i] = 1;
+            fresh++;
+        }
+    }
+    return fresh;
+}
+
+static void adapt_update_weights(void) {
+    double best = 0.0;
+    double rate[OP_SLOTS];
+    for (int op = 0; op < OP_SLOTS; op++) {
+        const adapt_stat_t *s = &adapt_stats[op];
+        rate[op] = s->pulls > 0 ? s->edges / (s->cost_ns / 1e6 + 1e-3) : 0.0;
+        if (rate[op] > best) best = rate[op];
+    }
+    double lnN = log(adapt_total_pulls + 1.0);
+    for (int op = 0; op < OP_SLOTS; op++) {
+        if (!op_enabled(op)) { adapt_weights[op] = 0.0; continue; }
+        double exploit = best > 0 ? rate[op] / best : 0.0;
+        double explore = ADAPT_UCB_C * sqrt(lnN / (adapt_stats[op].pulls + 1.0));
+        adapt_weights[op] = exploit + explore;
+    }
+}
+
+static void adapt_dump(void) {
+    char tmp[512];
+    snprintf(tmp, sizeof(tmp), "%s.tmp", adapt_stats_path);
+    FILE *fp = fopen(tmp, "w");
+    if (!fp) return;
+    adapt_update_weights();
+    double total = 0.0;
+    for (int op = 0; op < OP_SLOTS; op++) total += adapt_weights[op];
+    fprintf(fp, "# runs %llu, new edges %llu (statistics decayed every %d runs)\n",
+            (unsigned long long)adapt_runs, (unsigned long long)adapt_total_new, ADAPT_DECAY_EVERY);
+    fprintf(fp, "%-4s %-20s %-8s %10s %10s %12s %12s %8s\n", "slot", "name", "family",
+            "runs", "new_edges", "ns/run", "edges/cpu_ms", "weight");
+    for (int op = 0; op < OP_SLOTS; op++) {
+        if (!op_enabled(op)) continue;
+        const adapt_stat_t *s = &adapt_stats[op];
+        fprintf(fp, "%-4d %-20s %-8s %10.0f %10.1f %12.0f %12.4f %8.4f\n", op, op_names[op],
+                op_family_names[op_families[op]], s->pulls, s->edges,
+                s->pulls > 0 ? s->cost_ns / s->pulls : 0.0,
+                s->pulls > 0 ? s->edges / (s->cost_ns / 1e6 + 1e-3) : 0.0,
+                total > 0 ? adapt_weights[op] / total : 0.0);
+    }
+    fclose(fp);
+    rename(tmp, adapt_stats_path);
+}
+
+static void adapt_exec_end(const uint8_t *data, size_t size) {
+    size_t fresh = adapt_ncounters ? adapt_count_new_edges() : 0;
+    double wall = (double)(adapt_now() - adapt_exec_wall);
+    double cpu = (double)(adapt_clock(CLOCK_PROCESS_CPUTIME_ID) - adapt_exec_cpu);
+    /* other threads of the process can push CPU time past wall time */
+    double cpu_share = wall > 0 && cpu < wall ? cpu / wall : 1.0;
+    int distinct = 0;
+    for (int op = 0; op < OP_SLOTS; op++) distinct += adapt_in_run[op];
+    for (int op = 0; op < OP_SLOTS; op++) {
+        if (!adapt_in_run[op]) continue;
+        adapt_stats[op].pulls += 1.0;
+        adapt_stats[op].cost_ns += adapt_run_cost[op] * cpu_share;
+        adapt_stats[op].edges += (double)fresh / distinct;
+    }
+    adapt_total_pulls += distinct;
+    adapt_total_new += fresh;
+
+    uint64_t h = adapt_hash(data, size);
+    adapt_positions_t *slot = &adapt_pos_cache[h % ADAPT_POS_CACHE];
+    memcpy(slot->pos, adapt_cur.pos, adapt_cur.n * sizeof(uint32_t));
+    slot->n = adapt_cur.n;
+    slot->hash = h;
+
+    if (++adapt_runs % ADAPT_DECAY_EVERY == 0) {
+        for (int op = 0; op < OP_SLOTS; op++) {
+            adapt_stats[op].pulls *= 0.5;
+            adapt_stats[op].edges *= 0.5;
+            adapt_stats[op].cost_ns *= 0.5;
+        }
+        adapt_total_pulls *= 0.5;
+    }
+    if (adapt_runs % ADAPT_DUMP_EVERY == 0) adapt_dump();
+}
+
+static int adapt_pick_op(unsigned *rng) {
+    double total = 0.0;
+    for (int op = 0; op < OP_SLOTS; op++) total += adapt_weights[op];
+    if (total <= 0.0) return rand_r(rng) % OP_SLOTS;
+    double r = (double)rand_r(rng) / RAND_MAX * total;
+    for (int op = 0; op < OP_SLOTS; op++) {
+        r -= adapt_weights[op];
+        if (r <= 0.0 && adapt_weights[op] > 0.0) return op;
+    }
+    return OP_SLOTS - 1;
+}
+
+size_t LLVMFuzzerCustomMutator(uint8_t *data, size_t size, size_t max_size, unsigned int seed) {
+    static unsigned calls;
+    unsigned rng = seed;
+    if (!adapt_stats_path) adapt_init();
+    if (size < 2 || (rand_r(&rng) & 1))
+        return LLVMFuzzerMutate(data, size, max_size);
+    if (calls++ % 256 == 0) adapt_update_weights();
+
+    /* op offsets from the last run of this exact input, if we have them */
+    uint64_t h = adapt_hash(data, size);
+    const adapt_positions_t *known = &adapt_pos_cache[h % ADAPT_POS_CACHE];
+    size_t at;
+    if (known->hash == h && known->n > 0)
+        at = known->pos[rand_r(&rng) % known->n];
+    else
+        at = 1 + rand_r(&rng) % (size - 1);   /* byte 0 picks the backend */
+    if (at >= size) at = size - 1;
+
+    int op = adapt_pick_op(&rng);
+    uint8_t opcode = (uint8_t)(op + OP_SLOTS * (rand_r(&rng) % (256 / OP_SLOTS)));
+
+    if (rand_r(&rng) & 1) {
+        data[at] = opcode;                     /* retype */
+        return size;
+    }
+
+    /* insert opcode + operands before the op at `at` */
+    size_t n = 1 + adapt_operand_bytes(op);
+    if (size + n > max_size) {
+        data[at] = opcode;
+        return size;
+    }
+    memmove(data + at + n, data + at, size - at);
+    data[at] = opcode;
+    for (size_t i = 1; i < n; i++) data[at + i] = (uint8_t)rand_r(&rng);
+    return size + n;
+}
+
+#endif
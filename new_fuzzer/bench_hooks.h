@@ -0,0 +1,47 @@
+// fuzz/bench_hooks.h
+// Hooks the stateful harness calls when it is built with -DBENCH_BUILD, so the
+// benchmarks in bench/ can link against it and observe what a corpus input
+// actually does. The harness provides weak no-op defaults; a benchmark only
+// overrides the hooks it needs.
+#ifndef BENCH_HOOKS_H
+#define BENCH_HOOKS_H
+
+#include <cairo.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "output_sink.h"
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size);
+
+/* The harness's output surfaces; an input selects one with byte 0 % 4. */
+typedef enum {
+    BE_RECORDING = 0,
+    BE_IMAGE     = 1,
+    BE_PDF       = 2,
+    BE_SVG       = 3,
+    BE_PS        = 4    /* only reachable through bench_pick_backend() */
+} backend_e;
+
+/* Called right before an op consumes the current path (fill, stroke, clip)
+ * and after the copy/append round trip of op 28. */
+void bench_on_path(cairo_t *cr, int op);
+
+/* Gets the backend the input selected (a backend_e) and returns the one to use
+ * instead; BE_PS is only reachable this way. */
+int bench_pick_backend(int sel);
+
+/* PDF/SVG/PS only: called once the surface exists, after the last op and
+ * show_page, and after cairo_surface_finish, with the sink's running totals. */
+enum { BENCH_VECTOR_CREATED, BENCH_VECTOR_DRAWN, BENCH_VECTOR_FINISHED };
+void bench_on_vector(int phase, cairo_surface_t *surface, const output_sink_t *sink);
+
+/* Around the draw of op clip_stack: depth is the number of nested clips,
+ * complexity the vertices in them. */
+enum { BENCH_CLIP_BEGIN, BENCH_CLIP_END };
+void bench_on_clip_draw(int phase, int depth, int complexity);
+
+/* Recording backend only: called after the last op with the recording the
+ * input drew. Take a reference to keep it past the harness's destroy. */
+void bench_on_recording(cairo_surface_t *surface);
+
+#endif
@@ -0,0 +1,218 @@
+// fuzz/cairo_mesh_fuzzer.c
+// Mesh-pattern target for cairo-mesh-pattern-rasterizer.c.
+//
+// Op 17 of the stateful harness builds meshes out of extreme doubles, up to a
+// thousand curves per patch (most rejected by cairo), and paints them onto a
+// fixed 64x64 scratch surface. Here every patch is described by a small
+// structured record, so mutations move one control point or one color instead
+// of reshuffling the whole stream, and the destination size, format, transform
+// and draw operation come from the input too.
+//
+// Input layout (all integers little endian, missing bytes read as 0):
+//   u16 width, u16 height        destination is 1 + v % MESH_MAX_DIM
+//   u8  format                   ARGB32, RGB24, A8, RGB30, RGB16_565
+//   u8  flags                    bit0 draw through a recording surface,
+//                                bit1 clip to a rectangle, bit2 antialias NONE,
+//                                bit3 set a pattern matrix
+//   u8  draw                     paint, paint_with_alpha, fill rect, fill arc,
+//                                mask a solid source with the mesh
+//   u8  operator
+//   6 x s16 ctm                  xx yx xy yy / 64, x0 y0 / 4
+//   [6 x s16 pattern matrix]     when flags bit3, same scaling
+//   [4 x s16 clip rect]          when flags bit1, / 4
+//   u8  patches                  1 + v % MESH_MAX_PATCHES
+//   per patch:
+//     u8  scale                  coordinates are s16 * 2^(v % 32 - 12)
+//     u8  shape                  low 2 bits: sides - 1 (cairo closes the rest
+//                                with lines), bits 4..7: side i is a curve
+//     s16 x, y                   move_to
+//     per side: s16 x, y (line) or 3 x (s16 x, y) (curve)
+//     u8  control points         bits 0..3: set control point i, s16 x, y each
+//     u8  colors                 bits 0..3: set corner i, bits 4..7: as rgb;
+//                                u8 r, g, b[, a] each
+#include <cairo.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MESH_MAX_DIM 768
+#define MESH_MAX_PATCHES 64
+#define MAX_CAIRO_OPERATOR 28
+
+static const cairo_format_t mesh_formats[] = {
+    CAIRO_FORMAT_ARGB32, CAIRO_FORMAT_RGB24, CAIRO_FORMAT_A8,
+    CAIRO_FORMAT_RGB30, CAIRO_FORMAT_RGB16_565,
+};
+#define NUM_MESH_FORMATS ((int)(sizeof(mesh_formats) / sizeof(mesh_formats[0])))
+
+// -------- byte extraction --------
+static uint8_t pick_u8(const uint8_t **data, size_t *len) {
+    if (*len < 1) return 0;
+    uint8_t v = **data;
+    *data += 1;
+    *len -= 1;
+    return v;
+}
+
+static int pick_s16(const uint8_t **data, size_t *len) {
+    if (*len < 2) { *data += *len; *len = 0; return 0; }
+    int v = (int16_t)((*data)[0] | ((*data)[1] << 8));
+    *data += 2;
+    *len -= 2;
+    return v;
+}
+
+static unsigned pick_u16(const uint8_t **data, size_t *len) {
+    return (unsigned)pick_s16(data, len) & 0xffff;
+}
+
+static void pick_matrix(const uint8_t **data, size_t *len, cairo_matrix_t *m) {
+    /* a short tail would give an all-zero, non-invertible matrix */
+    if (*len < 12) { *data += *len; *len = 0; cairo_matrix_init_identity(m); return; }
+    double xx = pick_s16(data, len) / 64.0, yx = pick_s16(data, len) / 64.0;
+    double xy = pick_s16(data, len) / 64.0, yy = pick_s16(data, len) / 64.0;
+    double x0 = pick_s16(data, len) / 4.0, y0 = pick_s16(data, len) / 4.0;
+    cairo_matrix_init(m, xx, yx, xy, yy, x0, y0);
+}
+
+// -------- mesh construction --------
+static void build_patch(cairo_pattern_t *mesh, const uint8_t **data, size_t *len) {
+    double scale = ldexp(1.0, (int)(pick_u8(data, len) % 32) - 12);
+    uint8_t shape = pick_u8(data, len);
+    int sides = (shape & 3) + 1;
+
+    cairo_mesh_pattern_begin_patch(mesh);
+    double x = pick_s16(data, len) * scale, y = pick_s16(data, len) * scale;
+    cairo_mesh_pattern_move_to(mesh, x, y);
+    for (int s = 0; s < sides; s++) {
+        if (shape & (0x10 << s)) {
+            double x1 = pick_s16(data, len) * scale, y1 = pick_s16(data, len) * scale;
+            double x2 = pick_s16(data, len) * scale, y2 = pick_s16(data, len) * scale;
+            double x3 = pick_s16(data, len) * scale, y3 = pick_s16(data, len) * scale;
+            cairo_mesh_pattern_curve_to(mesh, x1, y1, x2, y2, x3, y3);
+        } else {
+            double x1 = pick_s16(data, len) * scale, y1 = pick_s16(data, len) * scale;
+            cairo_mesh_pattern_line_to(mesh, x1, y1);
+        }
+    }
+
+    uint8_t cps = pick_u8(data, len);
+    for (int i = 0; i < 4; i++) {
+        if (!(cps & (1 << i))) continue;
+        double cx = pick_s16(data, len) * scale, cy = pick_s16(data, len) * scale;
+        cairo_mesh_pattern_set_control_point(mesh, i, cx, cy);
+    }
+
+    uint8_t colors = pick_u8(data, len);
+    for (int i = 0; i < 4; i++) {
+        if (!(colors & (1 << i))) continue;
+        double r = pick_u8(data, len) / 255.0, g = pick_u8(data, len) / 255.0;
+        double b = pick_u8(data, len) / 255.0;
+        if (colors & (0x10 << i))
+            cairo_mesh_pattern_set_corner_color_rgb(mesh, i, r, g, b);
+        else
+            cairo_mesh_pattern_set_corner_color_rgba(mesh, i, r, g, b, pick_u8(data, len) / 255.0);
+    }
+    cairo_mesh_pattern_end_patch(mesh);
+}
+
+/* read everything back through the query API */
+static void query_mesh(cairo_pattern_t *mesh) {
+    unsigned int count = 0;
+    if (cairo_mesh_pattern_get_patch_count(mesh, &count) != CAIRO_STATUS_SUCCESS) return;
+    for (unsigned int p = 0; p < count; p++) {
+        cairo_path_t *path = cairo_mesh_pattern_get_path(mesh, p);
+        cairo_path_destroy(path);
+        for (unsigned int i = 0; i < 4; i++) {
+            double r, g, b, a, x, y;
+            cairo_mesh_pattern_get_corner_color_rgba(mesh, p, i, &r, &g, &b, &a);
+            cairo_mesh_pattern_get_control_point(mesh, p, i, &x, &y);
+        }
+    }
+}
+
+static void draw_mesh(cairo_t *cr, cairo_pattern_t *mesh, uint8_t draw, double w, double h) {
+    switch (draw % 5) {
+    case 0:
+        cairo_set_source(cr, mesh);
+        cairo_paint(cr);
+        break;
+    case 1:
+        cairo_set_source(cr, mesh);
+        cairo_paint_with_alpha(cr, (draw >> 3) / 31.0);
+        break;
+    case 2:
+        cairo_set_source(cr, mesh);
+        cairo_rectangle(cr, w * 0.125, h * 0.125, w * 0.75, h * 0.5);
+        cairo_fill(cr);
+        break;
+    case 3:
+        cairo_set_source(cr, mesh);
+        cairo_arc(cr, w / 2, h / 2, (w < h ? w : h) / 2.5, 0, 2 * M_PI);
+        cairo_fill(cr);
+        break;
+    case 4:
+        cairo_set_source_rgba(cr, 0.2, 0.4, 0.8, 1.0);
+        cairo_mask(cr, mesh);
+        break;
+    }
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+    if (size < 8) return 0;
+    const uint8_t *in = data;
+    size_t remaining = size;
+
+    int w = 1 + (int)(pick_u16(&in, &remaining) % MESH_MAX_DIM);
+    int h = 1 + (int)(pick_u16(&in, &remaining) % MESH_MAX_DIM);
+    cairo_format_t format = mesh_formats[pick_u8(&in, &remaining) % NUM_MESH_FORMATS];
+    uint8_t flags = pick_u8(&in, &remaining);
+    uint8_t draw = pick_u8(&in, &remaining);
+    cairo_operator_t op = (cairo_operator_t)(pick_u8(&in, &remaining) % (MAX_CAIRO_OPERATOR + 1));
+
+    cairo_matrix_t ctm, pm;
+    pick_matrix(&in, &remaining, &ctm);
+    if (flags & 8) pick_matrix(&in, &remaining, &pm);
+    double clip[4] = { 0, 0, 0, 0 };
+    if (flags & 2)
+        for (int i = 0; i < 4; i++) clip[i] = pick_s16(&in, &remaining) / 4.0;
+
+    cairo_pattern_t *mesh = cairo_pattern_create_mesh();
+    int patches = 1 + pick_u8(&in, &remaining) % MESH_MAX_PATCHES;
+    for (int p = 0; p < patches && remaining > 0; p++)
+        build_patch(mesh, &in, &remaining);
+    if (flags & 8) cairo_pattern_set_matrix(mesh, &pm);
+    query_mesh(mesh);
+
+    cairo_surface_t *dst = cairo_image_surface_create(format, w, h);
+    cairo_surface_t *target = dst;
+    if (flags & 1) {
+        cairo_rectangle_t ext = { 0, 0, w, h };
+        target = cairo_recording_surface_create(CAIRO_CONTENT_COLOR_ALPHA, &ext);
+    }
+
+    cairo_t *cr = cairo_create(target);
+    cairo_set_operator(cr, op);
+    if (flags & 4) cairo_set_antialias(cr, CAIRO_ANTIALIAS_NONE);
+    if (flags & 2) {
+        cairo_rectangle(cr, clip[0], clip[1], clip[2], clip[3]);
+        cairo_clip(cr);
+    }
+    cairo_transform(cr, &ctm);
+    draw_mesh(cr, mesh, draw, w, h);
+    cairo_destroy(cr);
+
+    if (target != dst) {
+        /* replay the recording onto the image, which rasterizes the copy */
+        cr = cairo_create(dst);
+        cairo_set_source_surface(cr, target, 0, 0);
+        cairo_paint(cr);
+        cairo_destroy(cr);
+        cairo_surface_destroy(target);
+    }
+
+    cairo_surface_destroy(dst);
+    cairo_pattern_destroy(mesh);
+    return 0;
+}
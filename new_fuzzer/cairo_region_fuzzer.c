@@ -0,0 +1,323 @@
+// fuzz/cairo_region_fuzzer.c
+// cairo_region_t target at sizes where pixman's region code actually works.
+//
+// Op 30 of the stateful harness unions at most 8 small rectangles into two
+// regions and does one boolean op. This target keeps a bank of REGION_BANK
+// regions and runs a little program on them: bulk rectangles straight from the
+// input, generated rectangle sets of up to a few thousand entries (see
+// region_gen.h), chained union/intersect/xor/subtract between regions and with
+// single rectangles, translate and copy.
+//
+// Every region also has a bitmap model of its MODEL_WIN x MODEL_WIN window at
+// the origin. Boolean ops are pointwise, so the model is updated alongside
+// cairo and compared with a rasterization of the region after every step, and
+// contains_point / contains_rectangle / equal answers are checked against it.
+// num_rectangles and get_rectangle are checked for pixman's invariants (non
+// empty boxes, y-x banded, no overlap, all inside get_extents). Any mismatch
+// aborts.
+//
+// Input: a sequence of commands, first byte % NUM_CMDS, operands as read
+// below (integers little endian, missing bytes read as 0).
+#include <cairo.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "region_gen.h"
+
+#define REGION_BANK 4
+#define MODEL_WIN 128
+#define MAX_FUZZ_RECTS 4096
+#define MAX_GEN_RECTS 2048
+#define MAX_CMDS 64
+
+#define CHECK(cond, ...) do { \
+    if (!(cond)) { \
+        fprintf(stderr, "region check failed: %s: ", #cond); \
+        fprintf(stderr, __VA_ARGS__); \
+        fputc('\n', stderr); \
+        abort(); \
+    } \
+} while (0)
+
+enum { CMD_FUZZ_RECTS, CMD_GEN_RECTS, CMD_BOOL, CMD_BOOL_RECT, CMD_TRANSLATE,
+       CMD_COPY, CMD_RESET, CMD_QUERY, CMD_EQUAL, NUM_CMDS };
+
+enum { BOOL_UNION, BOOL_INTERSECT, BOOL_XOR, BOOL_SUBTRACT };
+
+typedef struct {
+    cairo_region_t *region;
+    uint8_t         model[MODEL_WIN][MODEL_WIN];
+} slot_t;
+
+static slot_t bank[REGION_BANK];
+static uint8_t scratch[MODEL_WIN][MODEL_WIN];
+
+// -------- byte extraction --------
+static uint8_t pick_u8(const uint8_t **data, size_t *len) {
+    if (*len < 1) return 0;
+    uint8_t v = **data;
+    *data += 1;
+    *len -= 1;
+    return v;
+}
+
+static int pick_s16(const uint8_t **data, size_t *len) {
+    if (*len < 2) { *data += *len; *len = 0; return 0; }
+    int v = (int16_t)((*data)[0] | ((*data)[1] << 8));
+    *data += 2;
+    *len -= 2;
+    return v;
+}
+
+static uint32_t pick_u32(const uint8_t **data, size_t *len) {
+    uint32_t lo = (uint32_t)pick_s16(data, len) & 0xffff;
+    return lo | (((uint32_t)pick_s16(data, len) & 0xffff) << 16);
+}
+
+static cairo_rectangle_int_t pick_rect(const uint8_t **data, size_t *len) {
+    cairo_rectangle_int_t r;
+    r.x = pick_s16(data, len) % 512;
+    r.y = pick_s16(data, len) % 512;
+    r.width = 1 + pick_u8(data, len);
+    r.height = 1 + pick_u8(data, len);
+    return r;
+}
+
+// -------- model --------
+static void model_set_rect(uint8_t m[MODEL_WIN][MODEL_WIN], const cairo_rectangle_int_t *r, uint8_t v) {
+    int x0 = r->x < 0 ? 0 : r->x, y0 = r->y < 0 ? 0 : r->y;
+    long x1 = (long)r->x + r->width, y1 = (long)r->y + r->height;
+    if (x1 > MODEL_WIN) x1 = MODEL_WIN;
+    if (y1 > MODEL_WIN) y1 = MODEL_WIN;
+    for (int y = y0; y < y1; y++)
+        for (int x = x0; x < x1; x++) m[y][x] = v;
+}
+
+static void model_apply(uint8_t d[MODEL_WIN][MODEL_WIN], uint8_t s[MODEL_WIN][MODEL_WIN], int op) {
+    for (int y = 0; y < MODEL_WIN; y++)
+        for (int x = 0; x < MODEL_WIN; x++) {
+            switch (op) {
+            case BOOL_UNION:     d[y][x] |= s[y][x]; break;
+            case BOOL_INTERSECT: d[y][x] &= s[y][x]; break;
+            case BOOL_XOR:       d[y][x] ^= s[y][x]; break;
+            default:             d[y][x] &= !s[y][x]; break;
+            }
+        }
+}
+
+/* pixman invariants, then the window rasterized into scratch */
+static void check_structure(const cairo_region_t *region) {
+    int n = cairo_region_num_rectangles(region);
+    cairo_rectangle_int_t ext, prev = { 0, 0, 0, 0 };
+    cairo_region_get_extents(region, &ext);
+    CHECK((n == 0) == !!cairo_region_is_empty(region), "n=%d", n);
+    if (n == 0) return;
+
+    long minx = ext.x + (long)ext.width, miny = ext.y + (long)ext.height, maxx = ext.x, maxy = ext.y;
+    for (int i = 0; i < n; i++) {
+        cairo_rectangle_int_t r;
+        cairo_region_get_rectangle(region, i, &r);
+        CHECK(r.width > 0 && r.height > 0, "rect %d is %dx%d", i, r.width, r.height);
+        CHECK(r.x >= ext.x && r.y >= ext.y &&
+              (long)r.x + r.width <= (long)ext.x + ext.width &&
+              (long)r.y + r.height <= (long)ext.y + ext.height, "rect %d outside extents", i);
+        if (i > 0) {
+            if (r.y == prev.y) {
+                CHECK(r.height == prev.height, "rect %d: band height changes", i);
+                CHECK(r.x >= prev.x + prev.width, "rect %d overlaps/unsorted in band", i);
+            } else {
+                CHECK(r.y >= prev.y + prev.height, "rect %d: bands overlap", i);
+            }
+        }
+        if (r.x < minx) minx = r.x;
+        if (r.y < miny) miny = r.y;
+        if (r.x + (long)r.width > maxx) maxx = r.x + (long)r.width;
+        if (r.y + (long)r.height > maxy) maxy = r.y + (long)r.height;
+        prev = r;
+    }
+    CHECK(minx == ext.x && miny == ext.y && maxx == ext.x + (long)ext.width &&
+          maxy == ext.y + (long)ext.height, "extents are not the bounding box");
+}
+
+static void rasterize_window(const cairo_region_t *region, uint8_t m[MODEL_WIN][MODEL_WIN]) {
+    memset(m, 0, sizeof(uint8_t) * MODEL_WIN * MODEL_WIN);
+    int n = cairo_region_num_rectangles(region);
+    for (int i = 0; i < n; i++) {
+        cairo_rectangle_int_t r;
+        cairo_region_get_rectangle(region, i, &r);
+        model_set_rect(m, &r, 1);
+    }
+}
+
+static int usable(const slot_t *s) {
+    return cairo_region_status(s->region) == CAIRO_STATUS_SUCCESS;
+}
+
+static void check_slot(slot_t *s, int idx) {
+    if (!usable(s)) return;
+    check_structure(s->region);
+    rasterize_window(s->region, scratch);
+    for (int y = 0; y < MODEL_WIN; y++)
+        for (int x = 0; x < MODEL_WIN; x++)
+            CHECK(scratch[y][x] == s->model[y][x], "region %d differs from model at %d,%d", idx, x, y);
+}
+
+static void resync(slot_t *s) {
+    if (usable(s)) rasterize_window(s->region, s->model);
+}
+
+static void add_rects(slot_t *s, const cairo_rectangle_int_t *rects, int n, int bulk) {
+    if (bulk) {
+        cairo_region_t *tmp = cairo_region_create_rectangles(rects, n);
+        cairo_region_union(s->region, tmp);
+        cairo_region_destroy(tmp);
+    } else {
+        for (int i = 0; i < n; i++) cairo_region_union_rectangle(s->region, &rects[i]);
+    }
+    for (int i = 0; i < n; i++) model_set_rect(s->model, &rects[i], 1);
+}
+
+static void bool_op(cairo_region_t *dst, const cairo_region_t *src, int op) {
+    switch (op) {
+    case BOOL_UNION:     cairo_region_union(dst, src); break;
+    case BOOL_INTERSECT: cairo_region_intersect(dst, src); break;
+    case BOOL_XOR:       cairo_region_xor(dst, src); break;
+    default:             cairo_region_subtract(dst, src); break;
+    }
+}
+
+static void bool_rect(cairo_region_t *dst, const cairo_rectangle_int_t *r, int op) {
+    switch (op) {
+    case BOOL_UNION:     cairo_region_union_rectangle(dst, r); break;
+    case BOOL_INTERSECT: cairo_region_intersect_rectangle(dst, r); break;
+    case BOOL_XOR:       cairo_region_xor_rectangle(dst, r); break;
+    default:             cairo_region_subtract_rectangle(dst, r); break;
+    }
+}
+
+static void query(slot_t *s, const uint8_t **in, size_t *remaining) {
+    if (!usable(s)) return;
+    for (int i = 0; i < 16 && *remaining > 0; i++) {
+        int x = pick_u8(in, remaining) % MODEL_WIN, y = pick_u8(in, remaining) % MODEL_WIN;
+        CHECK(!!cairo_region_contains_point(s->region, x, y) == s->model[y][x],
+              "contains_point(%d,%d)", x, y);
+    }
+    cairo_rectangle_int_t r;
+    r.x = pick_u8(in, remaining) % MODEL_WIN;
+    r.y = pick_u8(in, remaining) % MODEL_WIN;
+    r.width = 1 + pick_u8(in, remaining) % (MODEL_WIN - r.x);
+    r.height = 1 + pick_u8(in, remaining) % (MODEL_WIN - r.y);
+    long covered = 0;
+    for (int y = r.y; y < r.y + r.height; y++)
+        for (int x = r.x; x < r.x + r.width; x++) covered += s->model[y][x];
+    cairo_region_overlap_t want = covered == 0 ? CAIRO_REGION_OVERLAP_OUT
+        : covered == (long)r.width * r.height ? CAIRO_REGION_OVERLAP_IN : CAIRO_REGION_OVERLAP_PART;
+    cairo_region_overlap_t got = cairo_region_contains_rectangle(s->region, &r);
+    CHECK(got == want, "contains_rectangle(%d,%d,%d,%d) = %d, model says %d",
+          r.x, r.y, r.width, r.height, got, want);
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+    const uint8_t *in = data;
+    size_t remaining = size;
+    static cairo_rectangle_int_t *rects;
+    if (!rects) rects = malloc(sizeof(*rects) * (MAX_FUZZ_RECTS > MAX_GEN_RECTS ? MAX_FUZZ_RECTS : MAX_GEN_RECTS));
+
+    for (int i = 0; i < REGION_BANK; i++) {
+        bank[i].region = cairo_region_create();
+        memset(bank[i].model, 0, sizeof(bank[i].model));
+    }
+
+    for (int cmd = 0; cmd < MAX_CMDS && remaining > 0; cmd++) {
+        uint8_t c = pick_u8(&in, &remaining);
+        int d = pick_u8(&in, &remaining) % REGION_BANK;
+        slot_t *dst = &bank[d];
+        switch (c % NUM_CMDS) {
+        case CMD_FUZZ_RECTS: {
+            int bulk = c >> 7;
+            int n = 1 + (int)(((unsigned)pick_s16(&in, &remaining) & 0xffff) % MAX_FUZZ_RECTS);
+            int got = 0;
+            while (got < n && remaining > 0) rects[got++] = pick_rect(&in, &remaining);
+            add_rects(dst, rects, got, bulk);
+            break;
+        }
+        case CMD_GEN_RECTS: {
+            int kind = pick_u8(&in, &remaining) % NUM_RGEN;
+            int n = 1 + (int)(((unsigned)pick_s16(&in, &remaining) & 0xffff) % MAX_GEN_RECTS);
+            int cell = 1 + pick_u8(&in, &remaining) % 16;
+            int ox = pick_s16(&in, &remaining) % 256, oy = pick_s16(&in, &remaining) % 256;
+            uint32_t seed = pick_u32(&in, &remaining);
+            rgen_fill(rects, n, kind, seed, cell, ox, oy);
+            add_rects(dst, rects, n, c >> 7);
+            break;
+        }
+        case CMD_BOOL: {
+            slot_t *src = &bank[pick_u8(&in, &remaining) % REGION_BANK];
+            int op = pick_u8(&in, &remaining) % 4;
+            if (src == dst) {
+                /* aliasing is allowed by the API; the model needs a copy */
+                memcpy(scratch, src->model, sizeof(scratch));
+                bool_op(dst->region, src->region, op);
+                model_apply(dst->model, scratch, op);
+            } else {
+                bool_op(dst->region, src->region, op);
+                model_apply(dst->model, src->model, op);
+            }
+            if (!usable(src)) resync(dst);
+            break;
+        }
+        case CMD_BOOL_RECT: {
+            int op = pick_u8(&in, &remaining) % 4;
+            cairo_rectangle_int_t r = pick_rect(&in, &remaining);
+            bool_rect(dst->region, &r, op);
+            memset(scratch, 0, sizeof(scratch));
+            model_set_rect(scratch, &r, 1);
+            model_apply(dst->model, scratch, op);
+            break;
+        }
+        case CMD_TRANSLATE:
+            /* parts outside the window move in, so the model is re-read */
+            cairo_region_translate(dst->region, pick_s16(&in, &remaining) % 256,
+                                   pick_s16(&in, &remaining) % 256);
+            check_structure(dst->region);
+            resync(dst);
+            break;
+        case CMD_COPY: {
+            slot_t *src = &bank[pick_u8(&in, &remaining) % REGION_BANK];
+            if (src == dst) break;
+            cairo_region_destroy(dst->region);
+            dst->region = cairo_region_copy(src->region);
+            memcpy(dst->model, src->model, sizeof(dst->model));
+            if (usable(src) && usable(dst))
+                CHECK(cairo_region_equal(dst->region, src->region), "copy is not equal");
+            break;
+        }
+        case CMD_RESET: {
+            cairo_rectangle_int_t r = pick_rect(&in, &remaining);
+            cairo_region_destroy(dst->region);
+            memset(dst->model, 0, sizeof(dst->model));
+            if (c >> 7) {
+                dst->region = cairo_region_create_rectangle(&r);
+                model_set_rect(dst->model, &r, 1);
+            } else {
+                dst->region = cairo_region_create();
+            }
+            break;
+        }
+        case CMD_QUERY:
+            query(dst, &in, &remaining);
+            break;
+        case CMD_EQUAL: {
+            slot_t *other = &bank[pick_u8(&in, &remaining) % REGION_BANK];
+            if (usable(dst) && usable(other) && cairo_region_equal(dst->region, other->region))
+                CHECK(!memcmp(dst->model, other->model, sizeof(dst->model)), "equal regions, different models");
+            break;
+        }
+        }
+        check_slot(dst, d);
+    }
+
+    for (int i = 0; i < REGION_BANK; i++) cairo_region_destroy(bank[i].region);
+    return 0;
+}
@@ -29,12 +29,7 @@
 #define MIN_PATCHES 1
 #define MAX_CURVES 4
 
-typedef enum {
-    BE_RECORDING = 0,
-    BE_IMAGE     = 1,
-    BE_PDF       = 2,
-    BE_SVG       = 3
-} backend_e;
+#include "bench_hooks.h"   /* backend_e, shared with bench/ */
 
 // Debug macro
 #ifdef COVERAGE_BUILD
@@ -73,6 +68,9 @@ static void read_matrix_from_bytes(cairo_matrix_t *out,
                                    const uint8_t *data, size_t size, size_t pos);
 static double clamp_pos(double v, double minv);
 
+// User font helpers (glyph outlines come from the fuzz input)
+static cairo_font_face_t* make_user_font_face(const uint8_t **data, size_t *len);
+
 
 
 
@@ -86,6 +84,69 @@ static void alarm_handler(int sig) {
 char* current_file = NULL;
 #endif
 
+#include "op_registry.h"
+#include "extra_counters.h"
+#include "output_sink.h"
+#include "image_gen.h"
+
+#ifdef BENCH_BUILD
+#  define BENCH_HOOK(call) call
+__attribute__((weak)) void bench_on_path(cairo_t *cr, int op) { (void)cr; (void)op; }
+__attribute__((weak)) int bench_pick_backend(int sel) { return sel; }
+__attribute__((weak)) void bench_on_clip_draw(int phase, int depth, int complexity) {
+    (void)phase; (void)depth; (void)complexity;
+}
+__attribute__((weak)) void bench_on_vector(int phase, cairo_surface_t *surface,
+                                           const output_sink_t *sink) {
+    (void)phase; (void)surface; (void)sink;
+}
+__attribute__((weak)) void bench_on_recording(cairo_surface_t *surface) { (void)surface; }
+#else
+#  define BENCH_HOOK(call) do{}while(0)
+#endif
+
+#ifdef COST_FEEDBACK
+#include "cost_feedback.h"
+#  define COST_HOOK(call) call
+#else
+#  define COST_HOOK(call) do{}while(0)
+#endif
+
+#ifdef MEM_AMPLIFICATION
+#include "mem_amplification.h"
+#  define MEM_HOOK(call) call
+#else
+#  define MEM_HOOK(call) do{}while(0)
+#endif
+
+#ifdef ADAPTIVE_OPS
+#include "adaptive_ops.h"
+#  define ADAPT_HOOK(call) call
+#else
+#  define ADAPT_HOOK(call) do{}while(0)
+#endif
+
+#ifdef OBSERVER_STATS
+#include "observer_stats.h"
+#  define OBS_HOOK(call) call
+#else
+#  define OBS_HOOK(call) do{}while(0)
+#endif
+
+#ifdef FONT_CACHE_STATS
+#include "font_cache_stats.h"
+#  define FONT_HOOK(call) call
+#else
+#  define FONT_HOOK(call) do{}while(0)
+#endif
+
+#ifdef STATE_FEATURES
+#include "state_features.h"
+#  define STATE_HOOK(call) call
+#else
+#  define STATE_HOOK(call) do{}while(0)
+#endif
+
 #ifdef DEBUG_OPS
 #  define DEBUG(op, fmt, ...) fprintf(stderr, "[OP %02d] " fmt "\n", (op), ##__VA_ARGS__)
 #else
@@ -133,6 +194,13 @@ static double pick_double_scale(const uint8_t **data, size_t *len) {
     return pick_double(data, len) * 5.0;
 }
 
+/* xorshift32, for the ops that stretch a short input into thousands of items */
+static inline uint32_t fill_rng_next(uint32_t *s) {
+    uint32_t x = *s ? *s : 0x9e3779b9u;
+    x ^= x << 13; x ^= x >> 17; x ^= x << 5;
+    return *s = x;
+}
+
 static inline double clamp_pos(double v, double def) {
     if (!isfinite(v)) return def;
     if (v < 0.0) return 0.0;
@@ -320,12 +388,151 @@ static cairo_font_face_t *make_font_face(const uint8_t *data, size_t size, size_
     return cairo_toy_font_face_create(family, slant, weight);
 }
 
-/* ---------- backend selection (B: Recording, Image, PDF, SVG) ---------- */
-static cairo_status_t null_write(void *closure, const unsigned char *data, unsigned int length) {
-    (void)closure; (void)data; (void)length;
+/* ---------- user font: glyph outlines replayed from fuzz bytes ----------
+ * The font face keeps a private copy of a slice of the input. render_glyph
+ * picks a start offset from the glyph index and replays a short program of
+ * path ops from there, so every glyph gets its own outline without going
+ * through FreeType / fontconfig at all. */
+#define MAX_GLYPH_PROGRAM 1024
+#define MAX_GLYPH_OPS 48
+
+typedef struct {
+    uint8_t *bytes;
+    size_t   len;
+} glyph_program_t;
+
+static cairo_user_data_key_t glyph_program_key;
+
+static void glyph_program_destroy(void *p) {
+    glyph_program_t *prog = (glyph_program_t*)p;
+    if (!prog) return;
+    free(prog->bytes);
+    free(prog);
+}
+
+/* em-space coordinate in [-2, 2], so outlines mostly land near the glyph box */
+static inline double pick_em(const uint8_t **in, size_t *remaining) {
+    if (*remaining < 2) return 0.0;
+    int16_t v;
+    memcpy(&v, *in, sizeof(v));
+    *in += 2;
+    *remaining -= 2;
+    return (double)v / 16384.0;
+}
+
+static cairo_status_t user_font_init(cairo_scaled_font_t *sf, cairo_t *cr,
+                                     cairo_font_extents_t *extents) {
+    glyph_program_t *prog = cairo_font_face_get_user_data(
+        cairo_scaled_font_get_font_face(sf), &glyph_program_key);
+    (void)cr;
+    if (!prog || prog->len < 2) return CAIRO_STATUS_SUCCESS;
+    extents->ascent  = (prog->bytes[0] / 255.0) * 1.5;
+    extents->descent = (prog->bytes[1] / 255.0) * 0.5;
+    return CAIRO_STATUS_SUCCESS;
+}
+
+static cairo_status_t user_font_unicode_to_glyph(cairo_scaled_font_t *sf,
+                                                 unsigned long unicode,
+                                                 unsigned long *glyph) {
+    (void)sf;
+    *glyph = unicode & 0xff;
     return CAIRO_STATUS_SUCCESS;
 }
 
+static cairo_status_t user_font_render_glyph(cairo_scaled_font_t *sf, unsigned long glyph,
+                                             cairo_t *cr, cairo_text_extents_t *extents) {
+    glyph_program_t *prog = cairo_font_face_get_user_data(
+        cairo_scaled_font_get_font_face(sf), &glyph_program_key);
+    FONT_HOOK(font_glyph_rendered(sf, glyph));
+    if (!prog || prog->len == 0) return CAIRO_STATUS_SUCCESS;
+
+    size_t off = (glyph * 13) % prog->len;
+    const uint8_t *in = prog->bytes + off;
+    size_t remaining  = prog->len - off;
+
+    extents->x_advance = (*in / 255.0) * 1.25;
+
+    for (int i = 0; i < MAX_GLYPH_OPS && remaining > 0; i++) {
+        uint8_t gop = *in++ % 7;
+        remaining--;
+        switch (gop) {
+        case 0: {
+            double x = pick_em(&in, &remaining);
+            double y = pick_em(&in, &remaining);
+            cairo_move_to(cr, x, y);
+            break;
+        }
+        case 1: {
+            double x = pick_em(&in, &remaining);
+            double y = pick_em(&in, &remaining);
+            cairo_line_to(cr, x, y);
+            break;
+        }
+        case 2: {
+            double x1 = pick_em(&in, &remaining), y1 = pick_em(&in, &remaining);
+            double x2 = pick_em(&in, &remaining), y2 = pick_em(&in, &remaining);
+            double x3 = pick_em(&in, &remaining), y3 = pick_em(&in, &remaining);
+            cairo_curve_to(cr, x1, y1, x2, y2, x3, y3);
+            break;
+        }
+        case 3: {
+            double cx = pick_em(&in, &remaining);
+            double cy = pick_em(&in, &remaining);
+            double r  = fabs(pick_em(&in, &remaining)) + 0.01;
+            cairo_arc(cr, cx, cy, r, 0, 2 * M_PI);
+            break;
+        }
+        case 4:
+            cairo_close_path(cr);
+            break;
+        case 5: {
+            /* finish the current contour set, alternating fill rules */
+            cairo_set_fill_rule(cr, (cairo_fill_rule_t)(i & 1));
+            cairo_fill(cr);
+            break;
+        }
+        default: {
+            cairo_set_line_width(cr, fabs(pick_em(&in, &remaining)) * 0.25 + 0.01);
+            cairo_stroke(cr);
+            break;
+        }
+        }
+    }
+    cairo_fill(cr);
+    return CAIRO_STATUS_SUCCESS;
+}
+
+static cairo_font_face_t *make_user_font_face(const uint8_t **in, size_t *remaining) {
+    size_t plen = (size_t)(abs(pick_int(in, remaining)) % MAX_GLYPH_PROGRAM) + 1;
+    if (plen > *remaining) plen = *remaining;
+    if (plen == 0) return NULL;
+
+    glyph_program_t *prog = malloc(sizeof(*prog));
+    if (!prog) return NULL;
+    prog->bytes = malloc(plen);
+    if (!prog->bytes) { free(prog); return NULL; }
+    memcpy(prog->bytes, *in, plen);
+    prog->len = plen;
+    *in += plen;
+    *remaining -= plen;
+
+    cairo_font_face_t *face = cairo_user_font_face_create();
+    if (cairo_font_face_set_user_data(face, &glyph_program_key, prog,
+                                      glyph_program_destroy) != CAIRO_STATUS_SUCCESS) {
+        glyph_program_destroy(prog);
+        cairo_font_face_destroy(face);
+        return NULL;
+    }
+    cairo_user_font_face_set_init_func(face, user_font_init);
+    cairo_user_font_face_set_render_glyph_func(face, user_font_render_glyph);
+    cairo_user_font_face_set_unicode_to_glyph_func(face, user_font_unicode_to_glyph);
+    return face;
+}
+
+/* ---------- backend selection (B: Recording, Image, PDF, SVG) ---------- */
+/* what the current input's vector surface has written so far */
+static output_sink_t vector_sink;
+
 static cairo_surface_t *create_pdf_surface_stream(double w, double h) {
 #ifdef COVERAGE_BUILD
     /* Write to file for coverage builds */
@@ -333,8 +540,9 @@ static cairo_surface_t *create_pdf_surface_stream(double w, double h) {
     snprintf(path, sizeof(path), "cairo_out/out_%d_%ld.pdf", (int)getpid(), (long)rand());
     return cairo_pdf_surface_create(path, w, h);
 #else
-    /* Stream that discards bytes */
-    return cairo_pdf_surface_create_for_stream(null_write, NULL, w, h);
+    /* Stream that only counts and hashes the bytes */
+    output_sink_reset(&vector_sink);
+    return cairo_pdf_surface_create_for_stream(output_sink_write, &vector_sink, w, h);
 #endif
 }
 
@@ -344,10 +552,16 @@ static cairo_surface_t *create_svg_surface_stream(double w, double h) {
     snprintf(path, sizeof(path), "cairo_out/out_%d_%ld.svg", (int)getpid(), (long)rand());
     return cairo_svg_surface_create(path, w, h);
 #else
-    return cairo_svg_surface_create_for_stream(null_write, NULL, w, h);
+    output_sink_reset(&vector_sink);
+    return cairo_svg_surface_create_for_stream(output_sink_write, &vector_sink, w, h);
 #endif
 }
 
+static cairo_surface_t *create_ps_surface_stream(double w, double h) {
+    output_sink_reset(&vector_sink);
+    return cairo_ps_surface_create_for_stream(output_sink_write, &vector_sink, w, h);
+}
+
 static cairo_surface_t *choose_backend_surface_B(const uint8_t **in, size_t *remaining,
                                                  double w, double h, backend_e *chosen) {
     /* derive selection from the first byte available */
@@ -357,6 +571,7 @@ static cairo_surface_t *choose_backend_surface_B(const uint8_t **in, size_t *rem
         *in += 1;
         *remaining -= 1;
     }
+    BENCH_HOOK(sel = bench_pick_backend(sel));
     if (chosen) *chosen = (backend_e)sel;
 
     switch (sel) {
@@ -366,6 +581,8 @@ static cairo_surface_t *choose_backend_surface_B(const uint8_t **in, size_t *rem
             return create_pdf_surface_stream(w, h);
         case BE_SVG:
             return create_svg_surface_stream(w, h);
+        case BE_PS:
+            return create_ps_surface_stream(w, h);
         case BE_RECORDING:
         default: {
             cairo_rectangle_t ext = {0, 0, w, h};
@@ -385,725 +602,1343 @@ static char* read_string_at(const uint8_t *data, size_t size, size_t *off, size_
     return s;
 }
 
-/* ====================== LLVMFuzzerTestOneInput ====================== */
+/* ====================== op handlers (see ops.def) ====================== */
+
+typedef struct {
+    cairo_t       *cr;
+    const uint8_t *in;          /* operand cursor */
+    size_t         remaining;
+    const uint8_t *data;        /* whole input, for the ops that peek at it */
+    size_t         size;
+    size_t         ops;         /* ops run so far, including this one */
+    int            op;
+    int            group_depth; /* push_group minus pop_group, as run by the ops */
+    int            clip_depth;  /* clips since the last reset_clip, same */
+} op_ctx_t;
+
+static void op_move_to(op_ctx_t *c) {
+    double x = pick_double_extreme(&c->in, &c->remaining);
+    double y = pick_double_extreme(&c->in, &c->remaining);
+    DEBUG_OP(c->op, "move_to(%.2f, %.2f)", x, y);
+    cairo_move_to(c->cr, x, y);
+}
 
-int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
-    if (size == 0 || !data) return 0;
+static void op_line_to(op_ctx_t *c) {
+    double x = pick_double_extreme(&c->in, &c->remaining);
+    double y = pick_double_extreme(&c->in, &c->remaining);
+    DEBUG_OP(c->op, "line_to(%.2f, %.2f)", x, y);
+    cairo_line_to(c->cr, x, y);
+}
 
-    const uint8_t *in = data;
-    size_t remaining  = size;
+static void op_curve_to(op_ctx_t *c) {
+    double x1 = pick_double_extreme(&c->in,&c->remaining);
+    double y1 = pick_double_extreme(&c->in,&c->remaining);
+    double x2 = pick_double_extreme(&c->in,&c->remaining);
+    double y2 = pick_double_extreme(&c->in,&c->remaining);
+    double x3 = pick_double_extreme(&c->in,&c->remaining);
+    double y3 = pick_double_extreme(&c->in,&c->remaining);
+    DEBUG_OP(c->op, "curve_to((%.2f,%.2f),(%.2f,%.2f),(%.2f,%.2f))", x1,y1,x2,y2,x3,y3);
+    cairo_curve_to(c->cr, x1,y1,x2,y2,x3,y3);
+}
 
-    double w = WIDTH, h = HEIGHT;
-    backend_e be = BE_RECORDING;
-    cairo_surface_t *surface = choose_backend_surface_B(&in, &remaining, w, h, &be);
-    if (!surface) return 0;
+static void op_set_dash(op_ctx_t *c) {
+    int dash_count = (abs(pick_int(&c->in,&c->remaining)) % 8) + 1;
+    double dashes[8];
+    for (int i = 0; i < dash_count; i++)
+        dashes[i] = fabs(pick_double_unit(&c->in,&c->remaining)) * 20.0 + 0.1;
+    double off = fabs(pick_double_unit(&c->in,&c->remaining)) * 10.0;
+    DEBUG_OP(c->op, "set_dash(count=%d, off=%.2f)", dash_count, off);
+    cairo_set_dash(c->cr, dashes, dash_count, off);
+}
 
-    if (cairo_surface_status(surface) != CAIRO_STATUS_SUCCESS) {
-        cairo_surface_destroy(surface);
-        return 0;
-    }
+static void op_arc(op_ctx_t *c) {
+    double cx = pick_double_extreme(&c->in,&c->remaining);
+    double cy = pick_double_extreme(&c->in,&c->remaining);
+    double r  = clamp_pos(fabs(pick_double_unit(&c->in,&c->remaining)) * (WIDTH*0.5), 1.0);
+    double a1 = pick_double(&c->in,&c->remaining) * 2 * M_PI;
+    double a2 = pick_double(&c->in,&c->remaining) * 2 * M_PI;
+    DEBUG_OP(c->op, "arc((%.2f,%.2f), r=%.2f, a1=%.2f, a2=%.2f)", cx,cy,r,a1,a2);
+    cairo_arc(c->cr, cx, cy, r, a1, a2);
+}
 
-    cairo_t *cr = cairo_create(surface);
-    if (!cr || cairo_status(cr) != CAIRO_STATUS_SUCCESS) {
-        if (cr) cairo_destroy(cr);
-        cairo_surface_destroy(surface);
-        return 0;
-    }
+static void op_rectangle(op_ctx_t *c) {
+    double rx = pick_double_extreme(&c->in,&c->remaining);
+    double ry = pick_double_extreme(&c->in,&c->remaining);
+    double rw = fabs(pick_double_unit(&c->in,&c->remaining)) * WIDTH;
+    double rh = fabs(pick_double_unit(&c->in,&c->remaining)) * HEIGHT;
+    DEBUG_OP(c->op, "rectangle(%.2f,%.2f, %.2f×%.2f)", rx,ry,rw,rh);
+    cairo_rectangle(c->cr, rx, ry, rw, rh);
+}
 
-    /* neutral background */
-    cairo_save(cr);
-    cairo_set_source_rgb(cr, 1.0, 1.0, 1.0);
-    cairo_paint(cr);
-    cairo_restore(cr);
+static void op_fill_or_stroke(op_ctx_t *c) {
+    BENCH_HOOK(bench_on_path(c->cr, c->op));
+    int which = pick_int(&c->in,&c->remaining) & 1;
+    // DEBUG_OP(c->op, which ? "fill()" : "stroke()");
+    if (which) cairo_fill(c->cr); else cairo_stroke(c->cr);
+}
 
-    size_t max_ops = 2000;
-    size_t ops = 0;
-    size_t pos_seed = 0;
+static void op_set_line_width(op_ctx_t *c) {
+    double lw = fabs(pick_double_unit(&c->in,&c->remaining)) * 20.0 + 0.1;
+    DEBUG_OP(c->op, "set_line_width(%.3f)", lw);
+    cairo_set_line_width(c->cr, lw);
+}
 
-    while (remaining > 0 && ops++ < max_ops) {
-        uint8_t op = *in++ % 61;
-        remaining--;
-#ifdef COVERAGE_BUILD
-        fprintf(stderr, "Current operation: %u\n", op);
-#endif
+static void op_set_line_cap(op_ctx_t *c) {
+    int cap = abs(pick_int(&c->in,&c->remaining)) % 3;
+    DEBUG_OP(c->op, "set_line_cap(%d)", cap);
+    cairo_set_line_cap(c->cr, (cairo_line_cap_t)cap);
+}
 
-        switch (op) {
-        case 0: {
-            double x = pick_double_extreme(&in, &remaining);
-            double y = pick_double_extreme(&in, &remaining);
-            DEBUG_OP(op, "move_to(%.2f, %.2f)", x, y);
-            cairo_move_to(cr, x, y);
-            break;
-        }
-        case 1: {
-            double x = pick_double_extreme(&in, &remaining);
-            double y = pick_double_extreme(&in, &remaining);
-            DEBUG_OP(op, "line_to(%.2f, %.2f)", x, y);
-            cairo_line_to(cr, x, y);
-            break;
-        }
-        case 2: {
-            double x1 = pick_double_extreme(&in,&remaining);
-            double y1 = pick_double_extreme(&in,&remaining);
-            double x2 = pick_double_extreme(&in,&remaining);
-            double y2 = pick_double_extreme(&in,&remaining);
-            double x3 = pick_double_extreme(&in,&remaining);
-            double y3 = pick_double_extreme(&in,&remaining);
-            DEBUG_OP(op, "curve_to((%.2f,%.2f),(%.2f,%.2f),(%.2f,%.2f))", x1,y1,x2,y2,x3,y3);
-            cairo_curve_to(cr, x1,y1,x2,y2,x3,y3);
-            break;
-        }
-        case 3: {
-            int dash_count = (abs(pick_int(&in,&remaining)) % 8) + 1;
-            double dashes[8];
-            for (int i = 0; i < dash_count; i++)
-                dashes[i] = fabs(pick_double_unit(&in,&remaining)) * 20.0 + 0.1;
-            double off = fabs(pick_double_unit(&in,&remaining)) * 10.0;
-            DEBUG_OP(op, "set_dash(count=%d, off=%.2f)", dash_count, off);
-            cairo_set_dash(cr, dashes, dash_count, off);
-            break;
-        }
-        case 4: {
-            double cx = pick_double_extreme(&in,&remaining);
-            double cy = pick_double_extreme(&in,&remaining);
-            double r  = clamp_pos(fabs(pick_double_unit(&in,&remaining)) * (WIDTH*0.5), 1.0);
-            double a1 = pick_double(&in,&remaining) * 2 * M_PI;
-            double a2 = pick_double(&in,&remaining) * 2 * M_PI;
-            DEBUG_OP(op, "arc((%.2f,%.2f), r=%.2f, a1=%.2f, a2=%.2f)", cx,cy,r,a1,a2);
-            cairo_arc(cr, cx, cy, r, a1, a2);
-            break;
-        }
-        case 5: {
-            double rx = pick_double_extreme(&in,&remaining);
-            double ry = pick_double_extreme(&in,&remaining);
-            double rw = fabs(pick_double_unit(&in,&remaining)) * WIDTH;
-            double rh = fabs(pick_double_unit(&in,&remaining)) * HEIGHT;
-            DEBUG_OP(op, "rectangle(%.2f,%.2f, %.2f×%.2f)", rx,ry,rw,rh);
-            cairo_rectangle(cr, rx, ry, rw, rh);
-            break;
-        }
-        case 6: {
-            int which = pick_int(&in,&remaining) & 1;
-            // DEBUG_OP(op, which ? "fill()" : "stroke()");
-            if (which) cairo_fill(cr); else cairo_stroke(cr);
-            break;
-        }
-        case 7: {
-            double lw = fabs(pick_double_unit(&in,&remaining)) * 20.0 + 0.1;
-            DEBUG_OP(op, "set_line_width(%.3f)", lw);
-            cairo_set_line_width(cr, lw);
-            break;
-        }
-        case 8: {
-            int cap = abs(pick_int(&in,&remaining)) % 3;
-            DEBUG_OP(op, "set_line_cap(%d)", cap);
-            cairo_set_line_cap(cr, (cairo_line_cap_t)cap);
-            break;
-        }
-        case 9: {
-            int j = abs(pick_int(&in,&remaining)) % 3;
-            DEBUG_OP(op, "set_line_join(%d)", j);
-            cairo_set_line_join(cr, (cairo_line_join_t)j);
-            break;
+static void op_set_line_join(op_ctx_t *c) {
+    int j = abs(pick_int(&c->in,&c->remaining)) % 3;
+    DEBUG_OP(c->op, "set_line_join(%d)", j);
+    cairo_set_line_join(c->cr, (cairo_line_join_t)j);
+}
+
+static void op_set_miter_limit(op_ctx_t *c) {
+    double ml = fabs(pick_double_unit(&c->in,&c->remaining)) * 20.0 + 1.0;
+    DEBUG_OP(c->op, "set_miter_limit(%.3f)", ml);
+    cairo_set_miter_limit(c->cr, ml);
+}
+
+static void op_transform(op_ctx_t *c) {
+    int which = abs(pick_int(&c->in,&c->remaining)) % 3;
+    if (which == 0) {
+        double sx = pick_double_scale(&c->in,&c->remaining);
+        double sy = pick_double_scale(&c->in,&c->remaining);
+        DEBUG_OP(c->op, "scale(%.3f, %.3f)", sx, sy);
+        cairo_scale(c->cr, sx, sy);
+    } else if (which == 1) {
+        double ang = pick_double(&c->in,&c->remaining);
+        DEBUG_OP(c->op, "rotate(%.3f)", ang);
+        cairo_rotate(c->cr, ang);
+    } else {
+        double tx = pick_double_extreme(&c->in,&c->remaining);
+        double ty = pick_double_extreme(&c->in,&c->remaining);
+        DEBUG_OP(c->op, "translate(%.2f, %.2f)", tx, ty);
+        cairo_translate(c->cr, tx, ty);
+    }
+}
+
+static void op_set_source(op_ctx_t *c) {
+    int t = abs(pick_int(&c->in,&c->remaining)) % 3;
+    if (t == 0) {
+        double r = fabs(pick_double_unit(&c->in,&c->remaining));
+        double g = fabs(pick_double_unit(&c->in,&c->remaining));
+        double b = fabs(pick_double_unit(&c->in,&c->remaining));
+        double a = fabs(pick_double_unit(&c->in,&c->remaining));
+        DEBUG_OP(c->op, "set_source_rgba(%.2f,%.2f,%.2f,%.2f)", r,g,b,a);
+        cairo_set_source_rgba(c->cr, r,g,b,a);
+    } else if (t == 1) {
+        double x0 = pick_double_extreme(&c->in,&c->remaining);
+        double y0 = pick_double_extreme(&c->in,&c->remaining);
+        double x1 = pick_double_extreme(&c->in,&c->remaining);
+        double y1 = pick_double_extreme(&c->in,&c->remaining);
+        cairo_pattern_t *p = cairo_pattern_create_linear(x0,y0,x1,y1);
+        if (p) {
+            cairo_pattern_add_color_stop_rgba(p, 0, 1,0,0,1);
+            cairo_pattern_add_color_stop_rgba(p, 1, 0,1,0,1);
         }
-        case 10: {
-            double ml = fabs(pick_double_unit(&in,&remaining)) * 20.0 + 1.0;
-            DEBUG_OP(op, "set_miter_limit(%.3f)", ml);
-            cairo_set_miter_limit(cr, ml);
-            break;
+        DEBUG_OP(c->op, "linear src ((%.1f,%.1f)->(%.1f,%.1f))", x0,y0,x1,y1);
+        safe_set_source(c->cr, p);
+    } else {
+        double cx0 = pick_double_extreme(&c->in,&c->remaining);
+        double cy0 = pick_double_extreme(&c->in,&c->remaining);
+        double r0  = fabs(pick_double_unit(&c->in,&c->remaining)) * WIDTH * .25 + 1.0;
+        double cx1 = pick_double_extreme(&c->in,&c->remaining);
+        double cy1 = pick_double_extreme(&c->in,&c->remaining);
+        double r1  = r0 + fabs(pick_double_unit(&c->in,&c->remaining)) * WIDTH * .25;
+        cairo_pattern_t *p = cairo_pattern_create_radial(cx0,cy0,r0,cx1,cy1,r1);
+        if (p) {
+            cairo_pattern_add_color_stop_rgba(p, 0, 0,1,0,1);
+            cairo_pattern_add_color_stop_rgba(p, 1, 1,1,0,1);
         }
-        case 11: {
-            int which = abs(pick_int(&in,&remaining)) % 3;
-            if (which == 0) {
-                double sx = pick_double_scale(&in,&remaining);
-                double sy = pick_double_scale(&in,&remaining);
-                DEBUG_OP(op, "scale(%.3f, %.3f)", sx, sy);
-                cairo_scale(cr, sx, sy);
-            } else if (which == 1) {
-                double ang = pick_double(&in,&remaining);
-                DEBUG_OP(op, "rotate(%.3f)", ang);
-                cairo_rotate(cr, ang);
-            } else {
-                double tx = pick_double_extreme(&in,&remaining);
-                double ty = pick_double_extreme(&in,&remaining);
-                DEBUG_OP(op, "translate(%.2f, %.2f)", tx, ty);
-                cairo_translate(cr, tx, ty);
+        DEBUG_OP(c->op, "radial src c0=(%.1f,%.1f,r=%.1f) c1=(%.1f,%.1f,r=%.1f)", cx0,cy0,r0,cx1,cy1,r1);
+        safe_set_source(c->cr, p);
+    }
+}
+
+static void op_clip_rect(op_ctx_t *c) {
+    double rx = pick_double_extreme(&c->in,&c->remaining);
+    double ry = pick_double_extreme(&c->in,&c->remaining);
+    double rw = fabs(pick_double_unit(&c->in,&c->remaining)) * WIDTH;
+    double rh = fabs(pick_double_unit(&c->in,&c->remaining)) * HEIGHT;
+    DEBUG_OP(c->op, "clip rect (%.1f,%.1f, %.1f×%.1f)", rx,ry,rw,rh);
+    cairo_save(c->cr);
+    cairo_rectangle(c->cr, rx, ry, rw, rh);
+    cairo_clip(c->cr);
+    if ((c->ops % 7) == 0) cairo_reset_clip(c->cr);
+    cairo_restore(c->cr);
+}
+
+static void op_select_font_text(op_ctx_t *c) {
+    char *s = pick_string(&c->in,&c->remaining);
+    int slant  = abs(pick_int(&c->in,&c->remaining)) % 3;
+    int weight = abs(pick_int(&c->in,&c->remaining)) % 2;
+    double sizev = fabs(pick_double_unit(&c->in,&c->remaining)) * 80.0 + 1.0;
+    double x = pick_double_extreme(&c->in,&c->remaining);
+    double y = pick_double_extreme(&c->in,&c->remaining);
+    DEBUG_OP(c->op, "text '%s' size=%.1f slant=%d weight=%d at (%.1f,%.1f)", s,sizev,slant,weight,x,y);
+    cairo_select_font_face(c->cr, s, (cairo_font_slant_t)slant, (cairo_font_weight_t)weight);
+    cairo_set_font_size(c->cr, sizev);
+    cairo_move_to(c->cr, x, y);
+    FONT_HOOK(font_glyphs((int)strlen(s)));
+    if (pick_int(&c->in,&c->remaining) & 1) cairo_show_text(c->cr, s);
+    else { cairo_text_path(c->cr, s); cairo_fill(c->cr); }
+    free(s);
+}
+
+static void op_font_options(op_ctx_t *c) {
+    cairo_font_options_t *opts = cairo_font_options_create();
+    cairo_font_options_set_hint_style  (opts, abs(pick_int(&c->in,&c->remaining)) % 5);
+    cairo_font_options_set_hint_metrics(opts, abs(pick_int(&c->in,&c->remaining)) % 3);
+    DEBUG_OP(c->op, "font_options set");
+    cairo_set_font_options(c->cr, opts);
+    cairo_font_options_destroy(opts);
+}
+
+static void op_create_pattern(op_ctx_t *c) {
+    int ptype = abs(pick_int(&c->in,&c->remaining)) % 5;
+    cairo_pattern_t *p = NULL;
+    if (ptype == 0) {
+        p = cairo_pattern_create_rgb(fabs(pick_double_unit(&c->in,&c->remaining)),
+                                     fabs(pick_double_unit(&c->in,&c->remaining)),
+                                     fabs(pick_double_unit(&c->in,&c->remaining)));
+    } else if (ptype == 1) {
+        p = cairo_pattern_create_rgba(fabs(pick_double_unit(&c->in,&c->remaining)),
+                                      fabs(pick_double_unit(&c->in,&c->remaining)),
+                                      fabs(pick_double_unit(&c->in,&c->remaining)),
+                                      fabs(pick_double_unit(&c->in,&c->remaining)));
+    } else if (ptype == 2) {
+        double x0 = pick_double_extreme(&c->in,&c->remaining);
+        double y0 = pick_double_extreme(&c->in,&c->remaining);
+        double x1 = pick_double_extreme(&c->in,&c->remaining);
+        double y1 = pick_double_extreme(&c->in,&c->remaining);
+        p = cairo_pattern_create_linear(x0,y0,x1,y1);
+        if (p) {
+            int stops = (abs(pick_int(&c->in,&c->remaining)) % 3) + 1;
+            for (int i = 0; i < stops; i++) {
+                double t = (stops > 1) ? ((double)i/(stops-1)) : 0.0;
+                cairo_pattern_add_color_stop_rgba(p, t,
+                    fabs(pick_double_unit(&c->in,&c->remaining)),
+                    fabs(pick_double_unit(&c->in,&c->remaining)),
+                    fabs(pick_double_unit(&c->in,&c->remaining)),
+                    fabs(pick_double_unit(&c->in,&c->remaining)));
             }
-            break;
         }
-        case 12: {
-            int t = abs(pick_int(&in,&remaining)) % 3;
-            if (t == 0) {
-                double r = fabs(pick_double_unit(&in,&remaining));
-                double g = fabs(pick_double_unit(&in,&remaining));
-                double b = fabs(pick_double_unit(&in,&remaining));
-                double a = fabs(pick_double_unit(&in,&remaining));
-                DEBUG_OP(op, "set_source_rgba(%.2f,%.2f,%.2f,%.2f)", r,g,b,a);
-                cairo_set_source_rgba(cr, r,g,b,a);
-            } else if (t == 1) {
-                double x0 = pick_double_extreme(&in,&remaining);
-                double y0 = pick_double_extreme(&in,&remaining);
-                double x1 = pick_double_extreme(&in,&remaining);
-                double y1 = pick_double_extreme(&in,&remaining);
-                cairo_pattern_t *p = cairo_pattern_create_linear(x0,y0,x1,y1);
-                if (p) {
-                    cairo_pattern_add_color_stop_rgba(p, 0, 1,0,0,1);
-                    cairo_pattern_add_color_stop_rgba(p, 1, 0,1,0,1);
-                }
-                DEBUG_OP(op, "linear src ((%.1f,%.1f)->(%.1f,%.1f))", x0,y0,x1,y1);
-                safe_set_source(cr, p);
-            } else {
-                double cx0 = pick_double_extreme(&in,&remaining);
-                double cy0 = pick_double_extreme(&in,&remaining);
-                double r0  = fabs(pick_double_unit(&in,&remaining)) * WIDTH * .25 + 1.0;
-                double cx1 = pick_double_extreme(&in,&remaining);
-                double cy1 = pick_double_extreme(&in,&remaining);
-                double r1  = r0 + fabs(pick_double_unit(&in,&remaining)) * WIDTH * .25;
-                cairo_pattern_t *p = cairo_pattern_create_radial(cx0,cy0,r0,cx1,cy1,r1);
-                if (p) {
-                    cairo_pattern_add_color_stop_rgba(p, 0, 0,1,0,1);
-                    cairo_pattern_add_color_stop_rgba(p, 1, 1,1,0,1);
-                }
-                DEBUG_OP(op, "radial src c0=(%.1f,%.1f,r=%.1f) c1=(%.1f,%.1f,r=%.1f)", cx0,cy0,r0,cx1,cy1,r1);
-                safe_set_source(cr, p);
+    } else if (ptype == 3) {
+        double cx0 = pick_double_extreme(&c->in,&c->remaining);
+        double cy0 = pick_double_extreme(&c->in,&c->remaining);
+        double r0  = fabs(pick_double_unit(&c->in,&c->remaining)) * (WIDTH*.25) + 1.0;
+        double cx1 = pick_double_extreme(&c->in,&c->remaining);
+        double cy1 = pick_double_extreme(&c->in,&c->remaining);
+        double r1  = r0 + fabs(pick_double_unit(&c->in,&c->remaining)) * (WIDTH*.25);
+        p = cairo_pattern_create_radial(cx0,cy0,r0,cx1,cy1,r1);
+        if (p) {
+            int stops = (abs(pick_int(&c->in,&c->remaining)) % 3) + 1;
+            for (int i = 0; i < stops; i++) {
+                double t = (stops > 1) ? ((double)i/(stops-1)) : 0.0;
+                cairo_pattern_add_color_stop_rgba(p, t,
+                    fabs(pick_double_unit(&c->in,&c->remaining)),
+                    fabs(pick_double_unit(&c->in,&c->remaining)),
+                    fabs(pick_double_unit(&c->in,&c->remaining)),
+                    fabs(pick_double_unit(&c->in,&c->remaining)));
             }
-            break;
         }
-        case 13: {
-            double rx = pick_double_extreme(&in,&remaining);
-            double ry = pick_double_extreme(&in,&remaining);
-            double rw = fabs(pick_double_unit(&in,&remaining)) * WIDTH;
-            double rh = fabs(pick_double_unit(&in,&remaining)) * HEIGHT;
-            DEBUG_OP(op, "clip rect (%.1f,%.1f, %.1f×%.1f)", rx,ry,rw,rh);
-            cairo_save(cr);
-            cairo_rectangle(cr, rx, ry, rw, rh);
-            cairo_clip(cr);
-            if ((ops % 7) == 0) cairo_reset_clip(cr);
-            cairo_restore(cr);
-            break;
+    } else {
+        cairo_surface_t *img = make_small_image_surface();
+        if (img) {
+            p = cairo_pattern_create_for_surface(img);
+            cairo_surface_destroy(img);
         }
-        case 14: {
-            char *s = pick_string(&in,&remaining);
-            int slant  = abs(pick_int(&in,&remaining)) % 3;
-            int weight = abs(pick_int(&in,&remaining)) % 2;
-            double sizev = fabs(pick_double_unit(&in,&remaining)) * 80.0 + 1.0;
-            double x = pick_double_extreme(&in,&remaining);
-            double y = pick_double_extreme(&in,&remaining);
-            DEBUG_OP(op, "text '%s' size=%.1f slant=%d weight=%d at (%.1f,%.1f)", s,sizev,slant,weight,x,y);
-            cairo_select_font_face(cr, s, (cairo_font_slant_t)slant, (cairo_font_weight_t)weight);
-            cairo_set_font_size(cr, sizev);
-            cairo_move_to(cr, x, y);
-            if (pick_int(&in,&remaining) & 1) cairo_show_text(cr, s);
-            else { cairo_text_path(cr, s); cairo_fill(cr); }
-            free(s);
-            break;
+    }
+
+    if (p) {
+        cairo_matrix_t m = rand_matrix(&c->in,&c->remaining);
+        cairo_pattern_set_matrix(p, &m);
+        cairo_pattern_set_extend(p, (cairo_extend_t)(abs(pick_int(&c->in,&c->remaining)) % 4));
+        cairo_pattern_set_filter(p, (cairo_filter_t)(abs(pick_int(&c->in,&c->remaining)) % 5));
+        DEBUG_OP(c->op, "pattern created type=%d", ptype);
+        cairo_pattern_destroy(p);
+    }
+}
+
+static void op_mesh(op_ctx_t *c) {
+    cairo_pattern_t *mesh = cairo_pattern_create_mesh();
+    if (!mesh) return;
+    int patches = (abs(pick_int(&c->in,&c->remaining)) % (MAX_PATCHES+1)) + MIN_PATCHES;
+    for (int p = 0; p < patches && c->remaining > 0; p++) {
+        cairo_mesh_pattern_begin_patch(mesh);
+        cairo_mesh_pattern_move_to(mesh,
+            pick_double_extreme(&c->in,&c->remaining),
+            pick_double_extreme(&c->in,&c->remaining));
+        int curves = abs(pick_int(&c->in,&c->remaining)) % (MAX_CURVES+1);
+        for (int i = 0; i < curves; i++) {
+            cairo_mesh_pattern_curve_to(mesh,
+                pick_double_extreme(&c->in,&c->remaining), pick_double_extreme(&c->in,&c->remaining),
+                pick_double_extreme(&c->in,&c->remaining), pick_double_extreme(&c->in,&c->remaining),
+                pick_double_extreme(&c->in,&c->remaining), pick_double_extreme(&c->in,&c->remaining));
         }
-        case 15: {
-            cairo_font_options_t *opts = cairo_font_options_create();
-            cairo_font_options_set_hint_style  (opts, abs(pick_int(&in,&remaining)) % 5);
-            cairo_font_options_set_hint_metrics(opts, abs(pick_int(&in,&remaining)) % 3);
-            DEBUG_OP(op, "font_options set");
-            cairo_set_font_options(cr, opts);
-            cairo_font_options_destroy(opts);
-            break;
+        for (int corner = 0; corner < 4; corner++) {
+            cairo_mesh_pattern_set_corner_color_rgba(mesh, corner,
+                fabs(pick_double_unit(&c->in,&c->remaining)),
+                fabs(pick_double_unit(&c->in,&c->remaining)),
+                fabs(pick_double_unit(&c->in,&c->remaining)),
+                fabs(pick_double_unit(&c->in,&c->remaining)));
         }
-        case 16: {
-            int ptype = abs(pick_int(&in,&remaining)) % 5;
-            cairo_pattern_t *p = NULL;
-            if (ptype == 0) {
-                p = cairo_pattern_create_rgb(fabs(pick_double_unit(&in,&remaining)),
-                                             fabs(pick_double_unit(&in,&remaining)),
-                                             fabs(pick_double_unit(&in,&remaining)));
-            } else if (ptype == 1) {
-                p = cairo_pattern_create_rgba(fabs(pick_double_unit(&in,&remaining)),
-                                              fabs(pick_double_unit(&in,&remaining)),
-                                              fabs(pick_double_unit(&in,&remaining)),
-                                              fabs(pick_double_unit(&in,&remaining)));
-            } else if (ptype == 2) {
-                double x0 = pick_double_extreme(&in,&remaining);
-                double y0 = pick_double_extreme(&in,&remaining);
-                double x1 = pick_double_extreme(&in,&remaining);
-                double y1 = pick_double_extreme(&in,&remaining);
-                p = cairo_pattern_create_linear(x0,y0,x1,y1);
-                if (p) {
-                    int stops = (abs(pick_int(&in,&remaining)) % 3) + 1;
-                    for (int i = 0; i < stops; i++) {
-                        double t = (stops > 1) ? ((double)i/(stops-1)) : 0.0;
-                        cairo_pattern_add_color_stop_rgba(p, t,
-                            fabs(pick_double_unit(&in,&remaining)),
-                            fabs(pick_double_unit(&in,&remaining)),
-                            fabs(pick_double_unit(&in,&remaining)),
-                            fabs(pick_double_unit(&in,&remaining)));
-                    }
-                }
-            } else if (ptype == 3) {
-                double cx0 = pick_double_extreme(&in,&remaining);
-                double cy0 = pick_double_extreme(&in,&remaining);
-                double r0  = fabs(pick_double_unit(&in,&remaining)) * (WIDTH*.25) + 1.0;
-                double cx1 = pick_double_extreme(&in,&remaining);
-                double cy1 = pick_double_extreme(&in,&remaining);
-                double r1  = r0 + fabs(pick_double_unit(&in,&remaining)) * (WIDTH*.25);
-                p = cairo_pattern_create_radial(cx0,cy0,r0,cx1,cy1,r1);
-                if (p) {
-                    int stops = (abs(pick_int(&in,&remaining)) % 3) + 1;
-                    for (int i = 0; i < stops; i++) {
-                        double t = (stops > 1) ? ((double)i/(stops-1)) : 0.0;
-                        cairo_pattern_add_color_stop_rgba(p, t,
-                            fabs(pick_double_unit(&in,&remaining)),
-                            fabs(pick_double_unit(&in,&remaining)),
-                            fabs(pick_double_unit(&in,&remaining)),
-                            fabs(pick_double_unit(&in,&remaining)));
-                    }
-                }
-            } else {
-                cairo_surface_t *img = make_small_image_surface();
-                if (img) {
-                    p = cairo_pattern_create_for_surface(img);
-                    cairo_surface_destroy(img);
-                }
-            }
+        cairo_mesh_pattern_end_patch(mesh);
+    }
 
-            if (p) {
-                cairo_matrix_t m = rand_matrix(&in,&remaining);
-                cairo_pattern_set_matrix(p, &m);
-                cairo_pattern_set_extend(p, (cairo_extend_t)(abs(pick_int(&in,&remaining)) % 4));
-                cairo_pattern_set_filter(p, (cairo_filter_t)(abs(pick_int(&in,&remaining)) % 5));
-                DEBUG_OP(op, "pattern created type=%d", ptype);
-                cairo_pattern_destroy(p);
-            }
-            break;
-        }
-        case 17: {
-            cairo_pattern_t *mesh = cairo_pattern_create_mesh();
-            if (!mesh) break;
-            int patches = (abs(pick_int(&in,&remaining)) % (MAX_PATCHES+1)) + MIN_PATCHES;
-            for (int p = 0; p < patches && remaining > 0; p++) {
-                cairo_mesh_pattern_begin_patch(mesh);
-                cairo_mesh_pattern_move_to(mesh,
-                    pick_double_extreme(&in,&remaining),
-                    pick_double_extreme(&in,&remaining));
-                int curves = abs(pick_int(&in,&remaining)) % (MAX_CURVES+1);
-                for (int i = 0; i < curves; i++) {
-                    cairo_mesh_pattern_curve_to(mesh,
-                        pick_double_extreme(&in,&remaining), pick_double_extreme(&in,&remaining),
-                        pick_double_extreme(&in,&remaining), pick_double_extreme(&in,&remaining),
-                        pick_double_extreme(&in,&remaining), pick_double_extreme(&in,&remaining));
-                }
-                for (int c = 0; c < 4; c++) {
-                    cairo_mesh_pattern_set_corner_color_rgba(mesh, c,
-                        fabs(pick_double_unit(&in,&remaining)),
-                        fabs(pick_double_unit(&in,&remaining)),
-                        fabs(pick_double_unit(&in,&remaining)),
-                        fabs(pick_double_unit(&in,&remaining)));
-                }
-                cairo_mesh_pattern_end_patch(mesh);
-            }
+    cairo_surface_t *img = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, 64, 64);
+    cairo_t *tmp = cairo_create(img);
+    cairo_set_operator(tmp, (cairo_operator_t)(abs(pick_int(&c->in,&c->remaining)) % (MAX_CAIRO_OPERATOR+1)));
+    cairo_set_source(tmp, mesh);
+    cairo_paint_with_alpha(tmp, fabs(pick_double_unit(&c->in,&c->remaining)));
+    cairo_destroy(tmp);
+    cairo_surface_destroy(img);
+    cairo_pattern_destroy(mesh);
+    DEBUG_OP(c->op, "mesh pattern drawn");
+}
 
-            cairo_surface_t *img = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, 64, 64);
-            cairo_t *tmp = cairo_create(img);
-            cairo_set_operator(tmp, (cairo_operator_t)(abs(pick_int(&in,&remaining)) % (MAX_CAIRO_OPERATOR+1)));
-            cairo_set_source(tmp, mesh);
-            cairo_paint_with_alpha(tmp, fabs(pick_double_unit(&in,&remaining)));
-            cairo_destroy(tmp);
-            cairo_surface_destroy(img);
-            cairo_pattern_destroy(mesh);
-            DEBUG_OP(op, "mesh pattern drawn");
-            break;
-        }
-        case 18: {
-            cairo_pattern_t *p = cairo_pattern_create_linear(0,0,10,10);
-            if (p) {
-                cairo_pattern_add_color_stop_rgba(p, 0, .1,.2,.3,1);
-                cairo_pattern_add_color_stop_rgba(p, 1, .9,.8,.7,1);
-                cairo_matrix_t mm = rand_matrix(&in,&remaining);
-                cairo_pattern_set_matrix(p, &mm);
-                cairo_pattern_set_extend(p, CAIRO_EXTEND_REPEAT);
-                safe_set_source(cr, cairo_pattern_reference(p));
-                cairo_pattern_destroy(p);
+static void op_repeat_source(op_ctx_t *c) {
+    cairo_pattern_t *p = cairo_pattern_create_linear(0,0,10,10);
+    if (p) {
+        cairo_pattern_add_color_stop_rgba(p, 0, .1,.2,.3,1);
+        cairo_pattern_add_color_stop_rgba(p, 1, .9,.8,.7,1);
+        cairo_matrix_t mm = rand_matrix(&c->in,&c->remaining);
+        cairo_pattern_set_matrix(p, &mm);
+        cairo_pattern_set_extend(p, CAIRO_EXTEND_REPEAT);
+        safe_set_source(c->cr, cairo_pattern_reference(p));
+        cairo_pattern_destroy(p);
+    }
+}
+
+static void op_pattern_queries(op_ctx_t *c) {
+    cairo_pattern_t *p = cairo_pattern_create_rgba(
+        fabs(pick_double_unit(&c->in,&c->remaining)),
+        fabs(pick_double_unit(&c->in,&c->remaining)),
+        fabs(pick_double_unit(&c->in,&c->remaining)),
+        fabs(pick_double_unit(&c->in,&c->remaining)));
+    if (p) {
+        double r,g,b,a;
+        cairo_pattern_get_rgba(p, &r,&g,&b,&a);
+        cairo_pattern_destroy(p);
+    }
+    cairo_surface_t *img = make_small_image_surface();
+    if (img) {
+        cairo_pattern_t *ps = cairo_pattern_create_for_surface(img);
+        int destroyed = 0;
+        if (ps) {
+            cairo_surface_t *out = NULL;
+            cairo_pattern_get_surface(ps, &out);
+            if (out) {
+                destroyed = 1;
+                cairo_surface_destroy(out);
             }
-            break;
+            cairo_pattern_destroy(ps);
         }
-        case 19: {
-            cairo_pattern_t *p = cairo_pattern_create_rgba(
-                fabs(pick_double_unit(&in,&remaining)),
-                fabs(pick_double_unit(&in,&remaining)),
-                fabs(pick_double_unit(&in,&remaining)),
-                fabs(pick_double_unit(&in,&remaining)));
-            if (p) {
-                double r,g,b,a;
-                cairo_pattern_get_rgba(p, &r,&g,&b,&a);
-                cairo_pattern_destroy(p);
-            }
-            cairo_surface_t *img = make_small_image_surface();
-            if (img) {
-                cairo_pattern_t *ps = cairo_pattern_create_for_surface(img);
-                int destroyed = 0;
-                if (ps) {
-                    cairo_surface_t *out = NULL;
-                    cairo_pattern_get_surface(ps, &out);
-                    if (out) {
-                        destroyed = 1;
-                        cairo_surface_destroy(out);
-                    }
-                    cairo_pattern_destroy(ps);
-                }
-                if (!destroyed) {
-                    cairo_surface_destroy(img);
-                }
-                // Originally this was here, but this caused UAF
-                // cairo_surface_destroy(img);
-            }
-            break;
+        if (!destroyed) {
+            cairo_surface_destroy(img);
         }
-        case 20: {
-            double dx = pick_double_extreme(&in,&remaining);
-            double dy = pick_double_extreme(&in,&remaining);
-            DEBUG_OP(op, "rel_move_to(%.2f, %.2f)", dx, dy);
-            cairo_rel_move_to(cr, dx, dy);
-            break;
+        // Originally this was here, but this caused UAF
+        // cairo_surface_destroy(img);
+    }
+}
+
+static void op_rel_move_to(op_ctx_t *c) {
+    double dx = pick_double_extreme(&c->in,&c->remaining);
+    double dy = pick_double_extreme(&c->in,&c->remaining);
+    DEBUG_OP(c->op, "rel_move_to(%.2f, %.2f)", dx, dy);
+    cairo_rel_move_to(c->cr, dx, dy);
+}
+
+static void op_rel_line_to_n(op_ctx_t *c) {
+    int reps = (abs(pick_int(&c->in,&c->remaining)) % 100) + 50;
+    DEBUG_OP(c->op, "rel_line_to reps=%d", reps);
+    for (int i = 0; i < reps && c->remaining > 0; i++) {
+        cairo_rel_line_to(c->cr,
+            pick_double_extreme(&c->in,&c->remaining),
+            pick_double_extreme(&c->in,&c->remaining));
+    }
+}
+
+static void op_rel_curve_to_n(op_ctx_t *c) {
+    int reps = (abs(pick_int(&c->in,&c->remaining)) % 50) + 10;
+    DEBUG_OP(c->op, "rel_curve_to reps=%d", reps);
+    for (int i = 0; i < reps && c->remaining > 0; i++) {
+        cairo_rel_curve_to(c->cr,
+            pick_double_extreme(&c->in,&c->remaining), pick_double_extreme(&c->in,&c->remaining),
+            pick_double_extreme(&c->in,&c->remaining), pick_double_extreme(&c->in,&c->remaining),
+            pick_double_extreme(&c->in,&c->remaining), pick_double_extreme(&c->in,&c->remaining));
+    }
+}
+
+static void op_close_fill_stroke(op_ctx_t *c) {
+    DEBUG_OP(c->op, "close_path + (fill_preserve?) + stroke");
+    cairo_close_path(c->cr);
+    BENCH_HOOK(bench_on_path(c->cr, c->op));
+    if (pick_int(&c->in,&c->remaining) & 1) cairo_fill_preserve(c->cr);
+    cairo_stroke(c->cr);
+}
+
+static void op_group_lines_paint(op_ctx_t *c) {
+    cairo_push_group(c->cr);
+    int n = (abs(pick_int(&c->in,&c->remaining)) % 20) + 5;
+    for (int i = 0; i < n; i++) {
+        cairo_line_to(c->cr,
+            pick_double_extreme(&c->in,&c->remaining),
+            pick_double_extreme(&c->in,&c->remaining));
+    }
+    cairo_pop_group_to_source(c->cr);
+    cairo_paint_with_alpha(c->cr, fabs(pick_double_unit(&c->in,&c->remaining)));
+}
+
+static void op_mask_surface(op_ctx_t *c) {
+    cairo_surface_t *img = make_small_image_surface();
+    if (img) {
+        double x = pick_double_extreme(&c->in,&c->remaining);
+        double y = pick_double_extreme(&c->in,&c->remaining);
+        DEBUG_OP(c->op, "mask_surface at (%.1f,%.1f)", x,y);
+        cairo_mask_surface(c->cr, img, x, y);
+        cairo_surface_destroy(img);
+    }
+}
+
+static void op_fill_preserve(op_ctx_t *c) {
+    cairo_set_fill_rule(c->cr, (cairo_fill_rule_t)(abs(pick_int(&c->in,&c->remaining)) % 2));
+    BENCH_HOOK(bench_on_path(c->cr, c->op));
+    cairo_fill_preserve(c->cr);
+}
+
+static void op_arc_clip_stroke(op_ctx_t *c) {
+    double cx = pick_double_extreme(&c->in,&c->remaining);
+    double cy = pick_double_extreme(&c->in,&c->remaining);
+    double r  = fabs(pick_double_unit(&c->in,&c->remaining)) * 30.0 + 3.0;
+    cairo_arc(c->cr, cx, cy, r, 0, 2*M_PI);
+    BENCH_HOOK(bench_on_path(c->cr, c->op));
+    cairo_clip_preserve(c->cr);
+    c->clip_depth++;
+    cairo_stroke(c->cr);
+}
+
+static void op_copy_append_path(op_ctx_t *c) {
+    cairo_path_t *p = cairo_copy_path(c->cr);
+    if (p) {
+        cairo_new_path(c->cr);
+        cairo_append_path(c->cr, p);
+        cairo_path_destroy(p);
+        BENCH_HOOK(bench_on_path(c->cr, c->op));
+    }
+}
+
+static void op_set_operator(op_ctx_t *c) {
+    cairo_set_operator(c->cr, (cairo_operator_t)(abs(pick_int(&c->in,&c->remaining)) % (MAX_CAIRO_OPERATOR+1)));
+}
+
+static void op_region_ops(op_ctx_t *c) {
+    cairo_region_t *r1 = cairo_region_create();
+    cairo_region_t *r2 = cairo_region_create();
+    for (int i = 0; i < 8 && c->remaining > 0; i++) {
+        cairo_rectangle_int_t rect = {
+            abs(pick_int(&c->in,&c->remaining)) % 500,
+            abs(pick_int(&c->in,&c->remaining)) % 500,
+            (abs(pick_int(&c->in,&c->remaining)) % 200) + 1,
+            (abs(pick_int(&c->in,&c->remaining)) % 200) + 1
+        };
+        cairo_region_union_rectangle(r1, &rect);
+        cairo_region_union_rectangle(r2, &rect);
+    }
+    switch (abs(pick_int(&c->in,&c->remaining)) % 4) {
+        case 0: cairo_region_intersect(r1, r2); break;
+        case 1: cairo_region_xor(r1, r2); break;
+        case 2: cairo_region_subtract(r1, r2); break;
+        default: cairo_region_union(r1, r2); break;
+    }
+    cairo_region_destroy(r1);
+    cairo_region_destroy(r2);
+}
+
+static void op_push_group(op_ctx_t *c) {
+    cairo_push_group(c->cr);
+    c->group_depth++;
+}
+
+static void op_pop_group_paint(op_ctx_t *c) {
+    cairo_pop_group_to_source(c->cr);
+    if (c->group_depth > 0) c->group_depth--;
+    cairo_paint_with_alpha(c->cr, fabs(pick_double_unit(&c->in,&c->remaining)));
+}
+
+static void op_set_antialias(op_ctx_t *c) {
+    cairo_set_antialias(c->cr, (cairo_antialias_t)(abs(pick_int(&c->in,&c->remaining)) % 5));
+}
+
+static void op_set_operator_alt(op_ctx_t *c) {
+    cairo_set_operator(c->cr, (cairo_operator_t)(abs(pick_int(&c->in,&c->remaining)) % (MAX_CAIRO_OPERATOR+1)));
+}
+
+static void op_clip_rect_reset(op_ctx_t *c) {
+    double x = pick_double_extreme(&c->in,&c->remaining);
+    double y = pick_double_extreme(&c->in,&c->remaining);
+    double rw = fabs(pick_double_unit(&c->in,&c->remaining)) * WIDTH;
+    double rh = fabs(pick_double_unit(&c->in,&c->remaining)) * HEIGHT;
+    cairo_rectangle(c->cr, x,y,rw,rh);
+    cairo_clip(c->cr);
+    c->clip_depth++;
+    if (pick_int(&c->in,&c->remaining) & 1) {
+        cairo_reset_clip(c->cr);
+        c->clip_depth = 0;
+    }
+}
+
+static void op_show_word(op_ctx_t *c) {
+    cairo_select_font_face(c->cr, "Sans", CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_BOLD);
+    cairo_set_font_size(c->cr, (fabs(pick_double_unit(&c->in,&c->remaining))+1.0)*12.0);
+    cairo_move_to(c->cr, pick_double_extreme(&c->in,&c->remaining), pick_double_extreme(&c->in,&c->remaining));
+    static const char *words[] = {"cairo","SVG","RGBA","mesh","recording"};
+    const char *word = words[abs(pick_int(&c->in,&c->remaining)) % 5];
+    FONT_HOOK(font_glyphs((int)strlen(word)));
+    cairo_show_text(c->cr, word);
+}
+
+static void op_stroke_fill(op_ctx_t *c) {
+    BENCH_HOOK(bench_on_path(c->cr, c->op));
+    cairo_stroke_preserve(c->cr);
+    cairo_fill(c->cr);
+}
+
+static void op_mask_pattern(op_ctx_t *c) {
+    cairo_surface_t *img = make_small_image_surface();
+    if (img) {
+        cairo_pattern_t *p = cairo_pattern_create_for_surface(img);
+        cairo_mask(c->cr, p);
+        cairo_pattern_destroy(p);
+        cairo_surface_destroy(img);
+    }
+}
+
+static void op_set_matrix(op_ctx_t *c) {
+    cairo_matrix_t m = rand_matrix(&c->in,&c->remaining);
+    cairo_set_matrix(c->cr, &m);
+}
+
+static void op_invert_matrix(op_ctx_t *c) {
+    cairo_matrix_t m;
+    cairo_get_matrix(c->cr, &m);
+    cairo_matrix_invert(&m);
+    cairo_set_matrix(c->cr, &m);
+}
+
+static void op_new_path(op_ctx_t *c) {
+    cairo_new_path(c->cr);
+}
+
+static void op_new_sub_path(op_ctx_t *c) {
+    cairo_new_sub_path(c->cr);
+}
+
+static void op_fill_extents(op_ctx_t *c) {
+    double x1,y1,x2,y2;
+    cairo_fill_extents(c->cr, &x1,&y1,&x2,&y2);
+    (void)x1;(void)y1;(void)x2;(void)y2;
+}
+
+static void op_stroke_extents(op_ctx_t *c) {
+    double x1,y1,x2,y2;
+    cairo_stroke_extents(c->cr, &x1,&y1,&x2,&y2);
+    (void)x1;(void)y1;(void)x2;(void)y2;
+}
+
+static void op_set_tolerance(op_ctx_t *c) {
+    cairo_set_tolerance(c->cr, fabs(pick_double_unit(&c->in,&c->remaining)) * 10.0 + 1e-6);
+}
+
+static void op_paint(op_ctx_t *c) {
+    cairo_paint(c->cr);
+}
+
+static void op_aliased_clips(op_ctx_t *c) {
+    cairo_set_antialias(c->cr, CAIRO_ANTIALIAS_NONE);
+    cairo_move_to(c->cr, pick_double_extreme(&c->in,&c->remaining), pick_double_extreme(&c->in,&c->remaining));
+    cairo_line_to(c->cr, pick_double_extreme(&c->in,&c->remaining), pick_double_extreme(&c->in,&c->remaining));
+    cairo_clip(c->cr);
+    cairo_set_antialias(c->cr, CAIRO_ANTIALIAS_DEFAULT);
+    cairo_move_to(c->cr, pick_double_extreme(&c->in,&c->remaining), pick_double_extreme(&c->in,&c->remaining));
+    cairo_line_to(c->cr, pick_double_extreme(&c->in,&c->remaining), pick_double_extreme(&c->in,&c->remaining));
+    cairo_clip(c->cr);
+    c->clip_depth += 2;
+}
+
+static void op_font_extents(op_ctx_t *c) {
+    cairo_font_extents_t fe;
+    FONT_HOOK(font_resolved());
+    cairo_font_extents(c->cr, &fe);
+}
+
+static void op_text_extents(op_ctx_t *c) {
+    cairo_text_extents_t te;
+    FONT_HOOK(font_glyphs(5));
+    cairo_text_extents(c->cr, "cairo", &te);
+}
+
+static void op_image_source(op_ctx_t *c) {
+    int iw = (abs(pick_int(&c->in,&c->remaining)) % 256) + 1;
+    int ih = (abs(pick_int(&c->in,&c->remaining)) % 256) + 1;
+    int fmt_sel = abs(pick_int(&c->in,&c->remaining)) % 3;
+    cairo_format_t fmt = (fmt_sel==1) ? CAIRO_FORMAT_RGB24
+                       : (fmt_sel==2) ? CAIRO_FORMAT_A8
+                                      : CAIRO_FORMAT_ARGB32;
+    cairo_surface_t *img = cairo_image_surface_create(fmt, iw, ih);
+    if (img && cairo_surface_status(img) == CAIRO_STATUS_SUCCESS) {
+        fill_image_with_fuzz(img, &c->in, &c->remaining);
+        cairo_surface_t *sim = cairo_surface_create_similar_image(img, fmt,
+                                    iw > 16 ? iw/2 : iw,
+                                    ih > 16 ? ih/2 : ih);
+        if (sim && cairo_surface_status(sim) == CAIRO_STATUS_SUCCESS) {
+            fill_image_with_fuzz(sim, &c->in, &c->remaining);
+            cairo_surface_destroy(sim);
         }
-        case 21: {
-            int reps = (abs(pick_int(&in,&remaining)) % 100) + 50;
-            DEBUG_OP(op, "rel_line_to reps=%d", reps);
-            for (int i = 0; i < reps && remaining > 0; i++) {
-                cairo_rel_line_to(cr,
-                    pick_double_extreme(&in,&remaining),
-                    pick_double_extreme(&in,&remaining));
-            }
-            break;
+        cairo_pattern_t *ps = cairo_pattern_create_for_surface(img);
+        if (ps) {
+            cairo_matrix_t mm = rand_matrix(&c->in,&c->remaining);
+            cairo_pattern_set_matrix(ps, &mm);
+            cairo_pattern_set_extend(ps, (cairo_extend_t)(abs(pick_int(&c->in,&c->remaining)) % 4));
+            cairo_pattern_set_filter(ps, (cairo_filter_t)(abs(pick_int(&c->in,&c->remaining)) % 5));
+            safe_set_source(c->cr, cairo_pattern_reference(ps));
+            cairo_paint_with_alpha(c->cr, fabs(pick_double_unit(&c->in,&c->remaining)));
+            cairo_set_source_surface(c->cr, img,
+                pick_double_extreme(&c->in,&c->remaining),
+                pick_double_extreme(&c->in,&c->remaining));
+            cairo_paint_with_alpha(c->cr, fabs(pick_double_unit(&c->in,&c->remaining)));
+            cairo_pattern_destroy(ps);
         }
-        case 22: {
-            int reps = (abs(pick_int(&in,&remaining)) % 50) + 10;
-            DEBUG_OP(op, "rel_curve_to reps=%d", reps);
-            for (int i = 0; i < reps && remaining > 0; i++) {
-                cairo_rel_curve_to(cr,
-                    pick_double_extreme(&in,&remaining), pick_double_extreme(&in,&remaining),
-                    pick_double_extreme(&in,&remaining), pick_double_extreme(&in,&remaining),
-                    pick_double_extreme(&in,&remaining), pick_double_extreme(&in,&remaining));
-            }
-            break;
+        if (pick_int(&c->in,&c->remaining) & 1) {
+            (void)cairo_image_surface_get_data(img);
         }
-        case 23:
-            DEBUG_OP(op, "close_path + (fill_preserve?) + stroke");
-            cairo_close_path(cr);
-            if (pick_int(&in,&remaining) & 1) cairo_fill_preserve(cr);
-            cairo_stroke(cr);
-            break;
-        case 24: {
-            cairo_push_group(cr);
-            int n = (abs(pick_int(&in,&remaining)) % 20) + 5;
-            for (int i = 0; i < n; i++) {
-                cairo_line_to(cr,
-                    pick_double_extreme(&in,&remaining),
-                    pick_double_extreme(&in,&remaining));
-            }
-            cairo_pop_group_to_source(cr);
-            cairo_paint_with_alpha(cr, fabs(pick_double_unit(&in,&remaining)));
-            break;
+        cairo_surface_destroy(img);
+    } else if (img) {
+        cairo_surface_destroy(img);
+    }
+}
+
+/* --- newly added cairo text & tag APIs and clip queries --- */
+/* cairo_set_font_matrix */
+static void op_set_font_matrix(op_ctx_t *c) {
+    cairo_matrix_t M;
+    read_matrix_from_bytes(&M, c->data, c->size, c->size - c->remaining);
+    DEBUG_OP(c->op, "set_font_matrix([%.2f %.2f; %.2f %.2f | %.2f %.2f])",
+             M.xx, M.xy, M.yx, M.yy, M.x0, M.y0);
+    cairo_set_font_matrix(c->cr, &M);
+}
+
+/* cairo_set_font_face */
+static void op_set_font_face(op_ctx_t *c) {
+    cairo_font_face_t *face = make_font_face(c->data, c->size, c->size - c->remaining);
+    DEBUG_OP(c->op, "set_font_face()");
+    cairo_set_font_face(c->cr, face);
+    cairo_font_face_destroy(face);
+}
+
+/* cairo_glyph_path */
+static void op_glyph_path(op_ctx_t *c) {
+    int n = 0;
+    cairo_glyph_t *glyphs = make_glyphs(c->data, c->size, c->size - c->remaining, &n);
+    DEBUG_OP(c->op, "glyph_path n=%d", n);
+    FONT_HOOK(font_glyphs(n));
+    cairo_glyph_path(c->cr, glyphs, n);
+    free(glyphs);
+}
+
+/* cairo_glyph_extents */
+static void op_glyph_extents(op_ctx_t *c) {
+    cairo_text_extents_t extents;
+    int n = 0;
+    cairo_glyph_t *glyphs = make_glyphs(c->data, c->size, c->size - c->remaining, &n);
+    DEBUG_OP(c->op, "glyph_extents n=%d", n);
+    FONT_HOOK(font_glyphs(n));
+    cairo_glyph_extents(c->cr, glyphs, n, &extents);
+    free(glyphs);
+}
+
+/* cairo_show_text_glyphs */
+static void op_show_text_glyphs(op_ctx_t *c) {
+    int num_glyphs = 0, num_clusters = 0;
+    cairo_glyph_t *glyphs = make_glyphs(c->data, c->size, c->size - c->remaining, &num_glyphs);
+    cairo_text_cluster_t *clusters = make_clusters(c->data, c->size, c->size - c->remaining, &num_clusters);
+    size_t tmp = c->size - c->remaining;
+    char *utf8 = read_string_at(c->data, c->size, &tmp, 32);
+    cairo_text_cluster_flags_t flags = (c->data[(c->size - c->remaining) % c->size] & 1)
+                                        ? CAIRO_TEXT_CLUSTER_FLAG_BACKWARD
+                                        : 0;
+    DEBUG_OP(c->op, "show_text_glyphs ng=%d nc=%d str='%s' flags=%d",
+             num_glyphs, num_clusters, utf8, (int)flags);
+    FONT_HOOK(font_glyphs(num_glyphs));
+    cairo_show_text_glyphs(c->cr,
+                           utf8, (int)strlen(utf8),
+                           glyphs, num_glyphs,
+                           clusters, num_clusters,
+                           flags);
+    free(utf8);
+    free(glyphs);
+    free(clusters);
+}
+
+/* cairo_tag_begin */
+static void op_tag_begin(op_ctx_t *c) {
+    size_t p = c->size - c->remaining;
+    char *tag   = read_string_at(c->data, c->size, &p, 16);
+    char *attrs = read_string_at(c->data, c->size, &p, 64);
+    DEBUG_OP(c->op, "tag_begin '%s' attrs='%s'", tag, attrs);
+    cairo_tag_begin(c->cr, tag, attrs);
+    free(tag);
+    free(attrs);
+}
+
+/* cairo_tag_end */
+static void op_tag_end(op_ctx_t *c) {
+    size_t p = c->size - c->remaining;
+    char *tag = read_string_at(c->data, c->size, &p, 16);
+    DEBUG_OP(c->op, "tag_end '%s'", tag);
+    cairo_tag_end(c->cr, tag);
+    free(tag);
+}
+
+/* cairo_clip_extents */
+static void op_clip_extents(op_ctx_t *c) {
+    double x1=0,y1=0,x2=0,y2=0;
+    cairo_clip_extents(c->cr, &x1,&y1,&x2,&y2);
+    DEBUG_OP(c->op, "clip_extents => [%.1f %.1f %.1f %.1f]", x1,y1,x2,y2);
+}
+
+/* cairo_in_clip */
+static void op_in_clip(op_ctx_t *c) {
+    double x = pick_double_extreme(&c->in,&c->remaining);
+    double y = pick_double_extreme(&c->in,&c->remaining);
+    cairo_bool_t inside = cairo_in_clip(c->cr, x, y);
+    DEBUG_OP(c->op, "in_clip(%.1f,%.1f) => %d", x, y, (int)inside);
+}
+
+/* cairo_copy_clip_rectangle_list */
+static void op_clip_rect_list(op_ctx_t *c) {
+    cairo_rectangle_list_t *list = cairo_copy_clip_rectangle_list(c->cr);
+    DEBUG_OP(c->op, "copy_clip_rectangle_list n=%d status=%d",
+             list ? list->num_rectangles : -1,
+             list ? list->status : -1);
+    cairo_rectangle_list_destroy(list);
+}
+
+/* user font face, then cairo_show_glyphs through it */
+static void op_user_font_glyphs(op_ctx_t *c) {
+    cairo_font_face_t *face = make_user_font_face(&c->in, &c->remaining);
+    if (face) {
+        DEBUG_OP(c->op, "set_font_face(user)");
+        cairo_set_font_face(c->cr, face);
+        cairo_font_face_destroy(face);
+    }
+    cairo_set_font_size(c->cr, fabs(pick_double_unit(&c->in,&c->remaining)) * 80.0 + 1.0);
+    int n = 0;
+    cairo_glyph_t *glyphs = make_glyphs(c->data, c->size, c->size - c->remaining, &n);
+    DEBUG_OP(c->op, "show_glyphs n=%d", n);
+    FONT_HOOK(font_glyphs(n));
+    cairo_show_glyphs(c->cr, glyphs, n);
+    free(glyphs);
+}
+
+/* ---------- clip stack ---------- */
+#define MAX_CLIP_DEPTH 64
+
+/* canvas coordinate from 16 input bits, overshooting the edges a bit */
+static double clip_coord(op_ctx_t *c, double extent) {
+    return (pick_int(&c->in,&c->remaining) & 0xffff) / 65536.0 * 1.5 * extent - 0.25 * extent;
+}
+
+/* One clip of the stack; returns how many vertices it added. */
+static int push_clip_shape(op_ctx_t *c, int k) {
+    int n;
+    cairo_new_path(c->cr);
+    switch ((k >> 5) & 3) {
+    case 0: {
+        double x = clip_coord(c, WIDTH), y = clip_coord(c, HEIGHT);
+        double w = clip_coord(c, WIDTH), h = clip_coord(c, HEIGHT);
+        if (k & 0x100) {
+            /* pixel aligned, stays on the boxes path of cairo-clip-boxes.c */
+            x = round(x); y = round(y); w = round(w); h = round(h);
         }
-        case 25: {
-            cairo_surface_t *img = make_small_image_surface();
-            if (img) {
-                double x = pick_double_extreme(&in,&remaining);
-                double y = pick_double_extreme(&in,&remaining);
-                DEBUG_OP(op, "mask_surface at (%.1f,%.1f)", x,y);
-                cairo_mask_surface(cr, img, x, y);
-                cairo_surface_destroy(img);
-            }
-            break;
+        cairo_rectangle(c->cr, x, y, w, h);
+        n = 4;
+        break;
+    }
+    case 1:
+        n = 3 + ((k >> 9) & 15);
+        cairo_move_to(c->cr, clip_coord(c, WIDTH), clip_coord(c, HEIGHT));
+        for (int i = 1; i < n; i++)
+            cairo_line_to(c->cr, clip_coord(c, WIDTH), clip_coord(c, HEIGHT));
+        cairo_close_path(c->cr);
+        break;
+    case 2: {
+        double cx = clip_coord(c, WIDTH), cy = clip_coord(c, HEIGHT), r = clip_coord(c, WIDTH);
+        cairo_arc(c->cr, cx, cy, fabs(r), 0, 2 * M_PI);
+        n = 8;
+        break;
+    }
+    default: {
+        /* self-intersecting star, so the fill rule matters */
+        double cx = clip_coord(c, WIDTH), cy = clip_coord(c, HEIGHT), r = fabs(clip_coord(c, WIDTH));
+        int points = 5 + ((k >> 9) & 7), step = points / 2;
+        n = points;
+        for (int i = 0; i < points; i++) {
+            double a = 2 * M_PI * ((i * step) % points) / points;
+            if (i == 0) cairo_move_to(c->cr, cx + r * cos(a), cy + r * sin(a));
+            else cairo_line_to(c->cr, cx + r * cos(a), cy + r * sin(a));
         }
-        case 26:
-            cairo_set_fill_rule(cr, (cairo_fill_rule_t)(abs(pick_int(&in,&remaining)) % 2));
-            cairo_fill_preserve(cr);
-            break;
-        case 27: {
-            double cx = pick_double_extreme(&in,&remaining);
-            double cy = pick_double_extreme(&in,&remaining);
-            double r  = fabs(pick_double_unit(&in,&remaining)) * 30.0 + 3.0;
-            cairo_arc(cr, cx, cy, r, 0, 2*M_PI);
-            cairo_clip_preserve(cr);
-            cairo_stroke(cr);
-            break;
+        cairo_close_path(c->cr);
+        break;
+    }
+    }
+    cairo_clip(c->cr);
+    return n;
+}
+
+/* Builds an N-deep clip stack mixing shapes, antialias modes and fill rules,
+ * some levels inside cairo_save, draws through it and unwinds (or keeps it
+ * for the following ops). */
+static void op_clip_stack(op_ctx_t *c) {
+    int head = pick_int(&c->in,&c->remaining);
+    int depth = 1 + abs(head % MAX_CLIP_DEPTH);
+    int saves = 0, built = 0, complexity = 0;
+
+    cairo_save(c->cr);
+    for (; built < depth && c->remaining > 0; built++) {
+        int k = pick_int(&c->in,&c->remaining);
+        if (k & 1) { cairo_save(c->cr); saves++; }
+        cairo_set_antialias(c->cr, (cairo_antialias_t)(((unsigned)k >> 1) % 7));
+        cairo_set_fill_rule(c->cr, (k & 0x10) ? CAIRO_FILL_RULE_EVEN_ODD : CAIRO_FILL_RULE_WINDING);
+        complexity += push_clip_shape(c, k);
+    }
+
+    int draw = pick_int(&c->in,&c->remaining);
+    BENCH_HOOK(bench_on_clip_draw(BENCH_CLIP_BEGIN, built, complexity));
+    switch (abs(draw % 3)) {
+    case 0:
+        cairo_paint(c->cr);
+        break;
+    case 1:
+        cairo_rectangle(c->cr, WIDTH * 0.1, HEIGHT * 0.1, WIDTH * 0.8, HEIGHT * 0.8);
+        cairo_fill(c->cr);
+        break;
+    default:
+        cairo_set_line_width(c->cr, 3.0);
+        cairo_move_to(c->cr, 0, 0);
+        for (int i = 1; i <= 16; i++)
+            cairo_line_to(c->cr, WIDTH * i / 16.0, (i & 1) ? HEIGHT : 0);
+        cairo_stroke(c->cr);
+        break;
+    }
+    BENCH_HOOK(bench_on_clip_draw(BENCH_CLIP_END, built, complexity));
+
+    double x1, y1, x2, y2;
+    cairo_clip_extents(c->cr, &x1, &y1, &x2, &y2);
+    cairo_rectangle_list_destroy(cairo_copy_clip_rectangle_list(c->cr));
+    DEBUG_OP(c->op, "clip_stack depth=%d saves=%d complexity=%d", built, saves, complexity);
+
+    if (draw & 0x100) {
+        c->clip_depth += built;   /* keep the whole stack for later ops */
+        return;
+    }
+    while (saves-- > 0) cairo_restore(c->cr);
+    cairo_restore(c->cr);
+}
+
+/* ---------- dense gradients ---------- */
+#define MAX_GRADIENT_STOPS 4096
+#define MAX_INPUT_STOPS    16
+
+/* A linear or radial gradient with up to MAX_GRADIENT_STOPS stops, painted
+ * over a square of the chosen size. The first MAX_INPUT_STOPS stops are one
+ * int each (16 bits offset, 4 bits per channel) from the input, the rest come
+ * from a generator seeded by the header, so thousands of stops cost a bounded
+ * operand block and the ops after this one still get their bytes. The
+ * offset mode gives them in input order, clustered onto a few duplicate
+ * offsets, spread outside [0,1] (cairo clamps) or sorted. Radial
+ * geometry includes the degenerate cases pixman special-cases: concentric,
+ * equal radii, zero radii, focus on the edge and identical circles. */
+static void op_gradient_stops(op_ctx_t *c) {
+    int head = pick_int(&c->in,&c->remaining);
+    int geom = pick_int(&c->in,&c->remaining);
+    int nstops = 1 + (int)(((unsigned)head >> 8) % MAX_GRADIENT_STOPS);
+    int radial = head & 1, mode = (head >> 1) & 3;
+    static const int sizes[4] = { 1, 16, 128, 500 };
+    int size = sizes[(head >> 3) & 3];
+    uint32_t seed = (uint32_t)head ^ (uint32_t)geom;
+
+    double x0 = clip_coord(c, WIDTH), y0 = clip_coord(c, HEIGHT);
+    double x1 = clip_coord(c, WIDTH), y1 = clip_coord(c, HEIGHT);
+    double r0 = clip_coord(c, WIDTH * 0.5), r1 = clip_coord(c, WIDTH * 0.5);
+    cairo_pattern_t *p;
+    if (!radial) {
+        if ((geom & 7) == 0) { x1 = x0; y1 = y0; }    /* zero-length axis */
+        p = cairo_pattern_create_linear(x0, y0, x1, y1);
+    } else {
+        r0 = fabs(r0); r1 = fabs(r1);
+        switch (geom & 7) {
+        case 0: x1 = x0; y1 = y0; break;                       /* concentric */
+        case 1: r1 = r0; break;                                /* cone becomes a cylinder */
+        case 2: r0 = 0; r1 = 0; break;
+        case 3: r0 = 0; x1 = x0 + r1; y1 = y0; break;          /* focus on the outer circle */
+        case 4: x1 = x0; y1 = y0; r1 = r0; break;              /* identical circles */
+        default: break;
         }
-        case 28: {
-            cairo_path_t *p = cairo_copy_path(cr);
-            if (p) {
-                cairo_new_path(cr);
-                cairo_append_path(cr, p);
-                cairo_path_destroy(p);
-            }
-            break;
+        p = cairo_pattern_create_radial(x0, y0, r0, x1, y1, r1);
+    }
+
+    double acc = 0;
+    for (int i = 0; i < nstops; i++) {
+        uint32_t v = i < MAX_INPUT_STOPS && c->remaining >= 4 ? (uint32_t)pick_int(&c->in,&c->remaining)
+                                                              : fill_rng_next(&seed);
+        double t = (v & 0xffff) / 65535.0;
+        switch (mode) {
+        case 0: break;
+        case 1: t = floor(t * 8) / 8; break;
+        case 2: t = t * 2 - 0.5; break;
+        default: acc += t / nstops; t = acc; break;
         }
-        case 29:
-            cairo_set_operator(cr, (cairo_operator_t)(abs(pick_int(&in,&remaining)) % (MAX_CAIRO_OPERATOR+1)));
-            break;
-        case 30: {
-            cairo_region_t *r1 = cairo_region_create();
-            cairo_region_t *r2 = cairo_region_create();
-            for (int i = 0; i < 8 && remaining > 0; i++) {
-                cairo_rectangle_int_t rect = {
-                    abs(pick_int(&in,&remaining)) % 500,
-                    abs(pick_int(&in,&remaining)) % 500,
-                    (abs(pick_int(&in,&remaining)) % 200) + 1,
-                    (abs(pick_int(&in,&remaining)) % 200) + 1
-                };
-                cairo_region_union_rectangle(r1, &rect);
-                cairo_region_union_rectangle(r2, &rect);
-            }
-            switch (abs(pick_int(&in,&remaining)) % 4) {
-                case 0: cairo_region_intersect(r1, r2); break;
-                case 1: cairo_region_xor(r1, r2); break;
-                case 2: cairo_region_subtract(r1, r2); break;
-                default: cairo_region_union(r1, r2); break;
+        cairo_pattern_add_color_stop_rgba(p, t, ((v >> 16) & 15) / 15.0, ((v >> 20) & 15) / 15.0,
+                                          ((v >> 24) & 15) / 15.0, ((v >> 28) & 15) / 15.0);
+    }
+    cairo_pattern_set_extend(p, (cairo_extend_t)(((unsigned)geom >> 3) % 4));
+    if (geom & 0x40) {
+        cairo_matrix_t m = rand_matrix(&c->in,&c->remaining);
+        cairo_pattern_set_matrix(p, &m);
+    }
+
+    cairo_save(c->cr);
+    cairo_set_source(c->cr, p);
+    cairo_new_path(c->cr);
+    cairo_rectangle(c->cr, x0 - size / 2.0, y0 - size / 2.0, size, size);
+    if (geom & 0x80) {
+        cairo_clip(c->cr);
+        cairo_paint_with_alpha(c->cr, 0.5);
+    } else {
+        cairo_fill(c->cr);
+    }
+    cairo_restore(c->cr);
+
+    int count = 0;
+    cairo_pattern_get_color_stop_count(p, &count);
+    DEBUG_OP(c->op, "gradient_stops radial=%d stops=%d mode=%d size=%d", radial, count, mode, size);
+    cairo_pattern_destroy(p);
+}
+
+/* ---------- large procedural source images ---------- */
+#define BIG_IMAGE_MAX_SIDE   4096
+#define BIG_IMAGE_MAX_PIXELS (1024 * 1024)
+
+/* Last generated image, reused by later big_image ops with the same key in the
+ * same run and released at the end of it (release_big_image), so generating it
+ * is always charged to the op of this run that asked for it. */
+static cairo_surface_t *big_image;
+static uint64_t big_image_key;
+
+static void release_big_image(void) {
+    if (big_image) cairo_surface_destroy(big_image);
+    big_image = NULL;
+}
+
+static cairo_surface_t *get_big_image(int w, int h, int fmt_sel, int kind, uint32_t seed) {
+    static const cairo_format_t formats[3] = { CAIRO_FORMAT_ARGB32, CAIRO_FORMAT_RGB24, CAIRO_FORMAT_A8 };
+    uint64_t key = (uint64_t)w << 44 | (uint64_t)h << 31 | (uint64_t)fmt_sel << 29 |
+                   (uint64_t)kind << 26 | (seed & 0x3ffffff);
+    if (big_image && key == big_image_key) return big_image;
+    if (big_image) cairo_surface_destroy(big_image);
+    big_image = cairo_image_surface_create(formats[fmt_sel], w, h);
+    big_image_key = key;
+    if (cairo_surface_status(big_image) == CAIRO_STATUS_SUCCESS)
+        igen_fill(big_image, kind, seed);
+    return big_image;
+}
+
+/* Draws an up to 4096-pixel-per-side (1M pixels) procedural image through an extreme
+ * scale (2^-12 .. 2^8 per axis, optionally rotated or skewed) with any filter
+ * and extend mode. The downscaling filters, GOOD/BEST/GAUSSIAN's separable
+ * convolutions and repeat/reflect tiling only show their cost on big sources. */
+static void op_big_image(op_ctx_t *c) {
+    int head = pick_int(&c->in,&c->remaining);
+    int dims = pick_int(&c->in,&c->remaining);
+    int xf = pick_int(&c->in,&c->remaining);
+    int w = 1 + (int)((unsigned)dims % BIG_IMAGE_MAX_SIDE);
+    int h = 1 + (int)(((unsigned)dims >> 12) % BIG_IMAGE_MAX_SIDE);
+    if ((int64_t)w * h > BIG_IMAGE_MAX_PIXELS) h = BIG_IMAGE_MAX_PIXELS / w;
+    int fmt_sel = (int)((unsigned)head % 3);
+    int kind = (int)(((unsigned)head >> 2) % NUM_IGEN);
+    cairo_filter_t filter = (cairo_filter_t)(((unsigned)head >> 5) % 6);   /* FAST .. GAUSSIAN */
+    cairo_extend_t extend = (cairo_extend_t)(((unsigned)head >> 8) % 4);
+    uint32_t seed = (uint32_t)head >> 12;
+    /* read all operands before anything can bail out (see ops.def) */
+    double tx = clip_coord(c, WIDTH), ty = clip_coord(c, HEIGHT);
+
+    cairo_surface_t *img = get_big_image(w, h, fmt_sel, kind, seed);
+    if (cairo_surface_status(img) != CAIRO_STATUS_SUCCESS) return;
+
+    /* destination-from-source scale, 2^-12 .. 2^8, per axis */
+    double sx = ldexp(1.0 + (xf & 0xff) / 256.0, ((xf >> 8) & 31) % 21 - 12);
+    double sy = (xf & 0x2000) ? sx : ldexp(1.0 + ((xf >> 14) & 0xff) / 256.0, ((xf >> 22) & 31) % 21 - 12);
+    cairo_matrix_t m;
+    cairo_matrix_init_scale(&m, sx, sy);
+    if (xf & 0x40000000) cairo_matrix_rotate(&m, ((xf >> 27) & 7) * M_PI / 7);
+    if ((unsigned)xf >> 31) m.xy = 0.25 * sx;   /* skew */
+
+    cairo_save(c->cr);
+    cairo_translate(c->cr, tx, ty);
+    cairo_transform(c->cr, &m);
+    cairo_set_source_surface(c->cr, img, 0, 0);
+    cairo_pattern_set_filter(cairo_get_source(c->cr), filter);
+    cairo_pattern_set_extend(cairo_get_source(c->cr), extend);
+    switch ((unsigned)head >> 10 & 3) {
+    case 0:
+        cairo_paint(c->cr);
+        break;
+    case 1:
+        cairo_paint_with_alpha(c->cr, 0.5);
+        break;
+    default:
+        /* image-sized rectangle in source space, so extend NONE leaves edges */
+        cairo_rectangle(c->cr, 0, 0, w, h);
+        cairo_fill(c->cr);
+        break;
+    }
+    cairo_restore(c->cr);
+    DEBUG_OP(c->op, "big_image %dx%d fmt=%d kind=%d filter=%d extend=%d scale=%g,%g",
+             w, h, fmt_sel, kind, (int)filter, (int)extend, sx, sy);
+}
+
+/* ---------- bulk path append ---------- */
+#define MAX_BULK_SEGMENTS 65536
+#define MAX_BULK_INPUT_SEGMENTS 64
+
+/* canvas point from 14+14 bits of v */
+static void bulk_point(uint32_t v, cairo_path_data_t *pt) {
+    pt->point.x = ((v >> 4) & 0x3fff) / 16384.0 * 1.5 * WIDTH - 0.25 * WIDTH;
+    pt->point.y = ((v >> 18) & 0x3fff) / 16384.0 * 1.5 * HEIGHT - 0.25 * HEIGHT;
+}
+
+/* Decodes up to MAX_BULK_SEGMENTS segments into a cairo_path_data_t array
+ * and installs them with one cairo_append_path, the way a map renderer hands
+ * over a huge polyline. The first MAX_BULK_INPUT_SEGMENTS segments come from
+ * the input (one int each: 3 bits of type plus a packed end point, followed by
+ * the end point as raw doubles in mode 1; curve control points are
+ * generated), the rest from a random-walk polyline generator, so tens of
+ * thousands of segments cost a bounded operand block. Mode 3 also pads header
+ * lengths, uses undefined types and too-short lengths, which cairo must
+ * reject with INVALID_PATH_DATA. */
+static void op_append_path_bulk(op_ctx_t *c) {
+    int head = pick_int(&c->in,&c->remaining);
+    int nseg = 1 + (int)(((unsigned)head >> 8) % MAX_BULK_SEGMENTS);
+    int mode = head & 3;
+    uint32_t seed = (uint32_t)head;
+    double wx = WIDTH / 2, wy = HEIGHT / 2;
+
+    /* at most header + 3 points + 1 pad element per segment */
+    cairo_path_data_t *data = malloc(sizeof(*data) * (size_t)nseg * 5);
+    if (!data) return;
+    int n = 0;
+    for (int s = 0; s < nseg; s++) {
+        uint32_t v;
+        int type, pad = 0;
+        int from_input = mode != 2 && s < MAX_BULK_INPUT_SEGMENTS && c->remaining >= 4;
+        double raw_x = 0, raw_y = 0;
+        if (from_input) {
+            v = (uint32_t)pick_int(&c->in,&c->remaining);
+            type = (int)(v & 7);
+            if (mode == 1) {
+                raw_x = pick_double_extreme(&c->in,&c->remaining);
+                raw_y = pick_double_extreme(&c->in,&c->remaining);
             }
-            cairo_region_destroy(r1);
-            cairo_region_destroy(r2);
-            break;
-        }
-        case 31:
-            cairo_push_group(cr);
-            break;
-        case 32:
-            cairo_pop_group_to_source(cr);
-            cairo_paint_with_alpha(cr, fabs(pick_double_unit(&in,&remaining)));
-            break;
-        case 33:
-            cairo_set_antialias(cr, (cairo_antialias_t)(abs(pick_int(&in,&remaining)) % 5));
-            break;
-        case 34:
-            cairo_set_operator(cr, (cairo_operator_t)(abs(pick_int(&in,&remaining)) % (MAX_CAIRO_OPERATOR+1)));
-            break;
-        case 35: {
-            double x = pick_double_extreme(&in,&remaining);
-            double y = pick_double_extreme(&in,&remaining);
-            double rw = fabs(pick_double_unit(&in,&remaining)) * WIDTH;
-            double rh = fabs(pick_double_unit(&in,&remaining)) * HEIGHT;
-            cairo_rectangle(cr, x,y,rw,rh);
-            cairo_clip(cr);
-            if (pick_int(&in,&remaining) & 1) cairo_reset_clip(cr);
-            break;
+        } else {
+            /* mostly short steps, sometimes a jump to a new subpath */
+            v = fill_rng_next(&seed);
+            type = (v & 0x3f) == 0 ? 0 : (v & 0x3f) == 1 ? 7 : (v & 0x3f) < 6 ? 5 : 1;
+            wx += (int)((v >> 8) & 31) - 15.5;
+            wy += (int)((v >> 16) & 31) - 15.5;
         }
-        case 36: {
-            cairo_select_font_face(cr, "Sans", CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_BOLD);
-            cairo_set_font_size(cr, (fabs(pick_double_unit(&in,&remaining))+1.0)*12.0);
-            cairo_move_to(cr, pick_double_extreme(&in,&remaining), pick_double_extreme(&in,&remaining));
-            static const char *words[] = {"cairo","SVG","RGBA","mesh","recording"};
-            cairo_show_text(cr, words[abs(pick_int(&in,&remaining)) % 5]);
-            break;
+        int npts = type == 0 ? 1 : type <= 4 ? 1 : type <= 6 ? 3 : 0;
+        cairo_path_data_type_t t = type == 0 ? CAIRO_PATH_MOVE_TO : type <= 4 ? CAIRO_PATH_LINE_TO
+                                 : type <= 6 ? CAIRO_PATH_CURVE_TO : CAIRO_PATH_CLOSE_PATH;
+        cairo_path_data_t *h = &data[n];
+        if (mode == 3) {
+            pad = (int)((v >> 4) & 1);
+            if ((v & 0xf8) == 0xf8) t = (cairo_path_data_type_t)(4 + (v >> 8) % 4);   /* no such type */
+            if ((v & 0x1f8) == 0x1f0 && npts) npts--;                                 /* too short */
         }
-        case 37:
-            cairo_stroke_preserve(cr);
-            cairo_fill(cr);
-            break;
-        case 38: {
-            cairo_surface_t *img = make_small_image_surface();
-            if (img) {
-                cairo_pattern_t *p = cairo_pattern_create_for_surface(img);
-                cairo_mask(cr, p);
-                cairo_pattern_destroy(p);
-                cairo_surface_destroy(img);
+        h->header.type = t;
+        h->header.length = 1 + npts + pad;
+        for (int p = 1; p <= npts + pad; p++) {
+            cairo_path_data_t *pt = &data[n + p];
+            if (!from_input) {
+                pt->point.x = wx + p * 3;
+                pt->point.y = wy - p * 2;
+            } else if (p > 1) {
+                bulk_point(fill_rng_next(&seed), pt);
+            } else if (mode == 1) {
+                pt->point.x = raw_x;
+                pt->point.y = raw_y;
+            } else {
+                bulk_point(v, pt);
             }
-            break;
-        }
-        case 39: {
-            cairo_matrix_t m = rand_matrix(&in,&remaining);
-            cairo_set_matrix(cr, &m);
-            break;
         }
-        case 40: {
-            cairo_matrix_t m;
-            cairo_get_matrix(cr, &m);
-            cairo_matrix_invert(&m);
-            cairo_set_matrix(cr, &m);
-            break;
-        }
-        case 41:
-            cairo_new_path(cr);
-            break;
-        case 42:
-            cairo_new_sub_path(cr);
-            break;
-        case 43: {
-            double x1,y1,x2,y2;
-            cairo_fill_extents(cr, &x1,&y1,&x2,&y2);
-            (void)x1;(void)y1;(void)x2;(void)y2;
-            break;
-        }
-        case 44: {
-            double x1,y1,x2,y2;
-            cairo_stroke_extents(cr, &x1,&y1,&x2,&y2);
-            (void)x1;(void)y1;(void)x2;(void)y2;
+        n += h->header.length;
+    }
+
+    cairo_path_t path = { CAIRO_STATUS_SUCCESS, data, n };
+    if (head & 0x10) cairo_new_path(c->cr);
+    cairo_append_path(c->cr, &path);
+    if (head & 0x20) cairo_append_path(c->cr, &path);   /* grow an already large path */
+    free(data);
+    DEBUG_OP(c->op, "append_path_bulk segments=%d data=%d mode=%d", nseg, n, mode);
+    BENCH_HOOK(bench_on_path(c->cr, c->op));
+
+    switch ((head >> 6) & 3) {
+    case 0:
+        break;   /* leave it for the following ops */
+    case 1:
+        cairo_fill(c->cr);
+        break;
+    case 2:
+        cairo_set_line_width(c->cr, 1.0 + ((head >> 8) & 7));
+        cairo_stroke(c->cr);
+        break;
+    default: {
+        double x1, y1, x2, y2;
+        cairo_path_extents(c->cr, &x1, &y1, &x2, &y2);
+        cairo_new_path(c->cr);
+        break;
+    }
+    }
+}
+
+/* ---------- nested recording surfaces ---------- */
+#define MAX_RECORDING_DEPTH 6
+
+/* n shapes packed in one int each: kind, position, size, color */
+static void record_shapes(cairo_t *rc, op_ctx_t *c, int n) {
+    for (int i = 0; i < n && c->remaining >= 4; i++) {
+        uint32_t v = (uint32_t)pick_int(&c->in,&c->remaining);
+        double x = (v >> 3 & 0xff) / 255.0 * WIDTH, y = (v >> 11 & 0xff) / 255.0 * HEIGHT;
+        double r = 2 + (v >> 19 & 0x3f);
+        cairo_set_source_rgba(rc, (v >> 25 & 1) ? 0.9 : 0.1, (v >> 26 & 1) ? 0.8 : 0.2,
+                              (v >> 27 & 1) ? 0.7 : 0.3, (v >> 28 & 7) / 7.0);
+        switch (v & 7) {
+        case 0: case 1: case 2:
+            cairo_rectangle(rc, x, y, r * 2, r);
+            cairo_fill(rc);
             break;
-        }
-        case 45:
-            cairo_set_tolerance(cr, fabs(pick_double_unit(&in,&remaining)) * 10.0 + 1e-6);
+        case 3: case 4:
+            cairo_arc(rc, x, y, r, 0, 2 * M_PI);
+            cairo_fill(rc);
             break;
-        case 46:
-            cairo_paint(cr);
+        case 5:
+            cairo_move_to(rc, x, y);
+            cairo_line_to(rc, x + r * 3, y + r);
+            cairo_set_line_width(rc, 1 + (v >> 28 & 3));
+            cairo_stroke(rc);
             break;
-        case 47: {
-            cairo_set_antialias(cr, CAIRO_ANTIALIAS_NONE);
-            cairo_move_to(cr, pick_double_extreme(&in,&remaining), pick_double_extreme(&in,&remaining));
-            cairo_line_to(cr, pick_double_extreme(&in,&remaining), pick_double_extreme(&in,&remaining));
-            cairo_clip(cr);
-            cairo_set_antialias(cr, CAIRO_ANTIALIAS_DEFAULT);
-            cairo_move_to(cr, pick_double_extreme(&in,&remaining), pick_double_extreme(&in,&remaining));
-            cairo_line_to(cr, pick_double_extreme(&in,&remaining), pick_double_extreme(&in,&remaining));
-            cairo_clip(cr);
+        case 6:
+            cairo_paint_with_alpha(rc, 0.1);
             break;
-        }
-        case 48: {
-            cairo_font_extents_t fe;
-            cairo_font_extents(cr, &fe);
+        default:
+            cairo_move_to(rc, x, y);
+            cairo_set_font_size(rc, r);
+            cairo_show_text(rc, "rec");
             break;
         }
-        case 49: {
-            cairo_text_extents_t te;
-            cairo_text_extents(cr, "cairo", &te);
-            break;
+    }
+}
+
+/* Records a few shapes, then uses that recording as the source of the next
+ * level (scaled/rotated, sometimes through a cairo_surface_create_for_rectangle
+ * view, with any extend and filter) up to MAX_RECORDING_DEPTH levels, and
+ * replays the top level into the context. Drawing into a recording after it
+ * was used as a source makes cairo snapshot it first. Bounded and unbounded
+ * recordings are mixed since they replay through different paths. */
+static void op_nested_recording(op_ctx_t *c) {
+    int head = pick_int(&c->in,&c->remaining);
+    int depth = 1 + (int)((unsigned)head % MAX_RECORDING_DEPTH);
+    cairo_surface_t *prev = NULL;
+
+    for (int level = 0; level < depth; level++) {
+        int k = pick_int(&c->in,&c->remaining);
+        cairo_rectangle_t ext = { 0, 0, WIDTH, HEIGHT };
+        cairo_surface_t *rec = cairo_recording_surface_create(
+            (k & 1) ? CAIRO_CONTENT_COLOR : CAIRO_CONTENT_COLOR_ALPHA, (k & 2) ? NULL : &ext);
+        cairo_t *rc = cairo_create(rec);
+
+        if (prev) {
+            cairo_surface_t *src = prev;
+            if (k & 4) {
+                /* a quarter-ish window into the previous level */
+                src = cairo_surface_create_for_rectangle(prev, (k >> 8 & 15) * WIDTH / 32,
+                                                         (k >> 12 & 15) * HEIGHT / 32,
+                                                         WIDTH / 4 + (k >> 16 & 15) * 8,
+                                                         HEIGHT / 4 + (k >> 20 & 15) * 8);
+            }
+            cairo_save(rc);
+            cairo_translate(rc, WIDTH / 2, HEIGHT / 2);
+            cairo_rotate(rc, (k >> 24 & 7) * M_PI / 8);
+            cairo_scale(rc, 0.25 + (k >> 27 & 7) * 0.25, 0.25 + (k >> 27 & 7) * 0.25);
+            cairo_translate(rc, -WIDTH / 2, -HEIGHT / 2);
+            cairo_set_source_surface(rc, src, 0, 0);
+            cairo_pattern_set_extend(cairo_get_source(rc), (cairo_extend_t)((k >> 3 & 1) ? (k >> 5 & 3) : 0));
+            cairo_pattern_set_filter(cairo_get_source(rc), (cairo_filter_t)((unsigned)k % 6));
+            cairo_paint_with_alpha(rc, 0.8);
+            cairo_restore(rc);
+            if (src != prev) cairo_surface_destroy(src);
         }
-        case 50: {
-            int iw = (abs(pick_int(&in,&remaining)) % 256) + 1;
-            int ih = (abs(pick_int(&in,&remaining)) % 256) + 1;
-            int fmt_sel = abs(pick_int(&in,&remaining)) % 3;
-            cairo_format_t fmt = (fmt_sel==1) ? CAIRO_FORMAT_RGB24
-                               : (fmt_sel==2) ? CAIRO_FORMAT_A8
-                                              : CAIRO_FORMAT_ARGB32;
-            cairo_surface_t *img = cairo_image_surface_create(fmt, iw, ih);
-            if (img && cairo_surface_status(img) == CAIRO_STATUS_SUCCESS) {
-                fill_image_with_fuzz(img, &in, &remaining);
-                cairo_surface_t *sim = cairo_surface_create_similar_image(img, fmt,
-                                            iw > 16 ? iw/2 : iw,
-                                            ih > 16 ? ih/2 : ih);
-                if (sim && cairo_surface_status(sim) == CAIRO_STATUS_SUCCESS) {
-                    fill_image_with_fuzz(sim, &in, &remaining);
-                    cairo_surface_destroy(sim);
-                }
-                cairo_pattern_t *ps = cairo_pattern_create_for_surface(img);
-                if (ps) {
-                    cairo_matrix_t mm = rand_matrix(&in,&remaining);
-                    cairo_pattern_set_matrix(ps, &mm);
-                    cairo_pattern_set_extend(ps, (cairo_extend_t)(abs(pick_int(&in,&remaining)) % 4));
-                    cairo_pattern_set_filter(ps, (cairo_filter_t)(abs(pick_int(&in,&remaining)) % 5));
-                    safe_set_source(cr, cairo_pattern_reference(ps));
-                    cairo_paint_with_alpha(cr, fabs(pick_double_unit(&in,&remaining)));
-                    cairo_set_source_surface(cr, img,
-                        pick_double_extreme(&in,&remaining),
-                        pick_double_extreme(&in,&remaining));
-                    cairo_paint_with_alpha(cr, fabs(pick_double_unit(&in,&remaining)));
-                    cairo_pattern_destroy(ps);
-                }
-                if (pick_int(&in,&remaining) & 1) {
-                    (void)cairo_image_surface_get_data(img);
-                }
-                cairo_surface_destroy(img);
-            } else if (img) {
-                cairo_surface_destroy(img);
+        record_shapes(rc, c, 1 + (int)((unsigned)k >> 28 & 3) * 4);
+        cairo_destroy(rc);
+        if (prev) {
+            if (k & 0x40000000) {
+                /* keep drawing into the level we just used as a source */
+                cairo_t *pc = cairo_create(prev);
+                record_shapes(pc, c, 2);
+                cairo_destroy(pc);
             }
-            break;
+            cairo_surface_destroy(prev);
         }
 
-        /* --- newly added cairo text & tag APIs and clip queries --- */
-        case 51: { /* cairo_set_font_matrix */
-            cairo_matrix_t M;
-            read_matrix_from_bytes(&M, data, size, size - remaining);
-            DEBUG_OP(op, "set_font_matrix([%.2f %.2f; %.2f %.2f | %.2f %.2f])",
-                     M.xx, M.xy, M.yx, M.yy, M.x0, M.y0);
-            cairo_set_font_matrix(cr, &M);
-            break;
-        }
-        case 52: { /* cairo_set_font_face */
-            cairo_font_face_t *face = make_font_face(data, size, size - remaining);
-            DEBUG_OP(op, "set_font_face()");
-            cairo_set_font_face(cr, face);
-            cairo_font_face_destroy(face);
-            break;
-        }
-        case 53: { /* cairo_glyph_path */
-            int n = 0;
-            cairo_glyph_t *glyphs = make_glyphs(data, size, size - remaining, &n);
-            DEBUG_OP(op, "glyph_path n=%d", n);
-            cairo_glyph_path(cr, glyphs, n);
-            free(glyphs);
-            break;
-        }
-        case 54: { /* cairo_glyph_extents */
-            cairo_text_extents_t extents;
-            int n = 0;
-            cairo_glyph_t *glyphs = make_glyphs(data, size, size - remaining, &n);
-            DEBUG_OP(op, "glyph_extents n=%d", n);
-            cairo_glyph_extents(cr, glyphs, n, &extents);
-            free(glyphs);
-            break;
-        }
-        case 55: { /* cairo_show_text_glyphs */
-            int num_glyphs = 0, num_clusters = 0;
-            cairo_glyph_t *glyphs = make_glyphs(data, size, size - remaining, &num_glyphs);
-            cairo_text_cluster_t *clusters = make_clusters(data, size, size - remaining, &num_clusters);
-            size_t tmp = size - remaining;
-            char *utf8 = read_string_at(data, size, &tmp, 32);
-            cairo_text_cluster_flags_t flags = (data[(size - remaining) % size] & 1)
-                                                ? CAIRO_TEXT_CLUSTER_FLAG_BACKWARD
-                                                : 0;
-            DEBUG_OP(op, "show_text_glyphs ng=%d nc=%d str='%s' flags=%d",
-                     num_glyphs, num_clusters, utf8, (int)flags);
-            cairo_show_text_glyphs(cr,
-                                   utf8, (int)strlen(utf8),
-                                   glyphs, num_glyphs,
-                                   clusters, num_clusters,
-                                   flags);
-            free(utf8);
-            free(glyphs);
-            free(clusters);
-            break;
-        }
-        case 56: { /* cairo_tag_begin */
-            size_t p = size - remaining;
-            char *tag   = read_string_at(data, size, &p, 16);
-            char *attrs = read_string_at(data, size, &p, 64);
-            DEBUG_OP(op, "tag_begin '%s' attrs='%s'", tag, attrs);
-            cairo_tag_begin(cr, tag, attrs);
-            free(tag);
-            free(attrs);
-            break;
-        }
-        case 57: { /* cairo_tag_end */
-            size_t p = size - remaining;
-            char *tag = read_string_at(data, size, &p, 16);
-            DEBUG_OP(op, "tag_end '%s'", tag);
-            cairo_tag_end(cr, tag);
-            free(tag);
-            break;
-        }
-        case 58: { /* cairo_clip_extents */
-            double x1=0,y1=0,x2=0,y2=0;
-            cairo_clip_extents(cr, &x1,&y1,&x2,&y2);
-            DEBUG_OP(op, "clip_extents => [%.1f %.1f %.1f %.1f]", x1,y1,x2,y2);
-            break;
-        }
-        case 59: { /* cairo_in_clip */
-            double x = pick_double_extreme(&in,&remaining);
-            double y = pick_double_extreme(&in,&remaining);
-            cairo_bool_t inside = cairo_in_clip(cr, x, y);
-            DEBUG_OP(op, "in_clip(%.1f,%.1f) => %d", x, y, (int)inside);
-            break;
-        }
-        case 60: { /* cairo_copy_clip_rectangle_list */
-            cairo_rectangle_list_t *list = cairo_copy_clip_rectangle_list(cr);
-            DEBUG_OP(op, "copy_clip_rectangle_list n=%d status=%d",
-                     list ? list->num_rectangles : -1,
-                     list ? list->status : -1);
-            cairo_rectangle_list_destroy(list);
-            break;
-        }
+        double x0, y0, w, h;
+        cairo_recording_surface_ink_extents(rec, &x0, &y0, &w, &h);
+        prev = rec;
+    }
+
+    cairo_save(c->cr);
+    cairo_matrix_t m = rand_matrix(&c->in,&c->remaining);
+    cairo_transform(c->cr, &m);
+    cairo_set_source_surface(c->cr, prev, 0, 0);
+    if (head & 0x100) {
+        cairo_rectangle(c->cr, 0, 0, WIDTH / 2, HEIGHT / 2);
+        cairo_fill(c->cr);
+    } else {
+        cairo_paint(c->cr);
+    }
+    cairo_restore(c->cr);
+    DEBUG_OP(c->op, "nested_recording depth=%d", depth);
+    cairo_surface_destroy(prev);
+}
 
+/* ====================== LLVMFuzzerTestOneInput ====================== */
+
+/* Once a cairo_t is in an error state every later call on it is a no-op, so
+ * the rest of the input would run for nothing. The error is reported as an
+ * extra counter (status x op family), then by default the ops go on with a
+ * fresh context on the same surface; -DERROR_STOP ends the run instead.
+ * Returns 0 when the run should stop. */
+static int handle_context_error(op_ctx_t *c, cairo_surface_t *target) {
+    cairo_status_t status = cairo_status(c->cr);
+    xc_set(XC_ERROR_BASE, XC_ERROR_SIZE, (size_t)(status & 63) * XC_NUM_FAMILIES + op_family(c->op));
+    DEBUG_OP(c->op, "context error %d (%s)", (int)status, cairo_status_to_string(status));
+#ifdef ERROR_STOP
+    (void)target;
+    return 0;
+#else
+    if (cairo_surface_status(target) != CAIRO_STATUS_SUCCESS) return 0;
+    cairo_t *cr = cairo_create(target);
+    if (cairo_status(cr) != CAIRO_STATUS_SUCCESS) {
+        cairo_destroy(cr);
+        return 0;
+    }
+    cairo_destroy(c->cr);
+    c->cr = cr;
+    c->group_depth = 0;
+    c->clip_depth = 0;
+    return 1;
+#endif
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    if (size == 0 || !data) return 0;
+
+    const uint8_t *in = data;
+    size_t remaining  = size;
+
+    double w = WIDTH, h = HEIGHT;
+    backend_e be = BE_RECORDING;
+    cairo_surface_t *surface = choose_backend_surface_B(&in, &remaining, w, h, &be);
+    if (!surface) return 0;
+
+    if (cairo_surface_status(surface) != CAIRO_STATUS_SUCCESS) {
+        cairo_surface_destroy(surface);
+        return 0;
+    }
+
+    /* what the context draws on; the observer wrapper under OBSERVER_STATS */
+    cairo_surface_t *draw_target = surface;
+    OBS_HOOK(draw_target = obs_wrap(surface, be));
+
+    cairo_t *cr = cairo_create(draw_target);
+    if (!cr || cairo_status(cr) != CAIRO_STATUS_SUCCESS) {
+        if (cr) cairo_destroy(cr);
+        OBS_HOOK(cairo_surface_destroy(draw_target));
+        cairo_surface_destroy(surface);
+        return 0;
+    }
+
+    int vector = be == BE_PDF || be == BE_SVG || be == BE_PS;
+    if (vector) BENCH_HOOK(bench_on_vector(BENCH_VECTOR_CREATED, surface, &vector_sink));
+
+    /* neutral background */
+    cairo_save(cr);
+    cairo_set_source_rgb(cr, 1.0, 1.0, 1.0);
+    cairo_paint(cr);
+    cairo_restore(cr);
+
+    size_t max_ops = 2000;
+    size_t pos_seed = 0;
+    op_ctx_t ctx = { cr, in, remaining, data, size, 0, 0, 0, 0 };
+
+    COST_HOOK(cost_exec_begin());
+    MEM_HOOK(mem_exec_begin());
+    ADAPT_HOOK(adapt_exec_begin());
+    STATE_HOOK(state_exec_begin());
+
+    while (ctx.remaining > 0 && ctx.ops++ < max_ops) {
+        int op = *ctx.in++ % OP_SLOTS;
+        ctx.remaining--;
+        ctx.op = op;
+#ifdef COVERAGE_BUILD
+        fprintf(stderr, "Current operation: %d (%s)\n", op, op_names[op] ? op_names[op] : "-");
+#endif
+        COST_HOOK(cost_op_begin());
+        MEM_HOOK(mem_op_begin());
+        ADAPT_HOOK(adapt_op_begin(op, (size_t)(ctx.in - data) - 1));
+        OBS_HOOK(obs_op_begin(op));
+        FONT_HOOK(font_op_begin(op));
+        STATE_HOOK(state_op_begin(ctx.cr, op));
+
+        switch (op) {
+#define OP(slot, name, fam, cost, sig) \
+        case slot: \
+            if (OP_FAMILY_ENABLED(FAM_##fam)) op_##name(&ctx); \
+            else op_skip_operands(slot, &ctx.in, &ctx.remaining); \
+            break;
+#include "ops.def"
+#undef OP
         default:
-            /* no-op */
+            /* empty slot */
             break;
         } /* switch */
+        COST_HOOK(cost_op_end(op));
+        MEM_HOOK(mem_op_end(op));
+        ADAPT_HOOK(adapt_op_end(op));
+        FONT_HOOK(font_op_end(ctx.cr, op));
+        STATE_HOOK(state_op_end(ctx.cr, op, ctx.group_depth, ctx.clip_depth, be));
         pos_seed++;
+        if (cairo_status(ctx.cr) != CAIRO_STATUS_SUCCESS && !handle_context_error(&ctx, draw_target))
+            break;
     } /* while ops */
 
+    COST_HOOK(cost_exec_end(data, size));
+    MEM_HOOK(mem_exec_end(data, size));
+    ADAPT_HOOK(adapt_exec_end(data, size));
+
 #ifdef COVERAGE_BUILD
     /* For recording surface, rasterize to PNG to visualize. */
     if (be == BE_RECORDING) {
@@ -1131,14 +1966,22 @@ int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
 #endif
 
     /* finish vector surfaces to flush objects */
-    if (be == BE_PDF || be == BE_SVG) {
-        cairo_show_page(cr);
+    if (vector) {
+        cairo_show_page(ctx.cr);
         cairo_surface_flush(surface);
+        BENCH_HOOK(bench_on_vector(BENCH_VECTOR_DRAWN, surface, &vector_sink));
         cairo_surface_finish(surface);
+        BENCH_HOOK(bench_on_vector(BENCH_VECTOR_FINISHED, surface, &vector_sink));
     }
 
-    cairo_destroy(cr);
+    if (be == BE_RECORDING) BENCH_HOOK(bench_on_recording(surface));
+
+    OBS_HOOK(obs_exec_end());
+    FONT_HOOK(font_exec_end());
+    cairo_destroy(ctx.cr);
+    OBS_HOOK(cairo_surface_destroy(draw_target));
     cairo_surface_destroy(surface);
+    release_big_image();
     return 0;
 }
 
@@ -1152,6 +1995,7 @@ int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
 #include <errno.h>
 #include <fcntl.h>
 #include <limits.h>
+#include "corpus_pack.h"
 
 void save_input(char* buffer, int len) {
     // Do the stuff...
@@ -1162,20 +2006,26 @@ void save_input(char* buffer, int len) {
     return;
 }
 
-static int process_file(const char *path) {
-
+/* Runs one input under the coverage-scan timeout. */
+static void run_input(const char *name, const uint8_t *data, size_t size) {
     // Install a timeout (2 seconds for coverage scans)
     signal(SIGALRM, alarm_handler);
     alarm(2);           // <-- adjust time if needed
 
     if (sigsetjmp(escape, 1)) {
-        fprintf(stderr, "[!] Timeout on file %s — skipping\n", path);
+        fprintf(stderr, "[!] Timeout on file %s — skipping\n", name);
         alarm(0);
-        return 0;
+        release_big_image();   /* don't hand it to the next file */
+        return;
     }
 
+    current_file = name; // Set the pointer thing...
+    save_input((char*)data, (int)size); // Do the stuff...
+    LLVMFuzzerTestOneInput(data, size);
+    alarm(0);
+}
 
-    current_file = path; // Set the pointer thing...
+static int process_file(const char *path) {
     int fd = open(path, O_RDONLY);
     if (fd < 0) { perror("open"); return -1; }
     struct stat st;
@@ -1198,10 +2048,24 @@ static int process_file(const char *path) {
         if (r == 0) break;
         off += r;
     }
-    save_input(buf, off); // Do the stuff...
-    LLVMFuzzerTestOneInput(buf, (size_t)off);
+    run_input(path, buf, (size_t)off);
     free(buf); close(fd);
-    alarm(0);
+    return 0;
+}
+
+/* Replays every input of a corpus pack straight out of the mapping. */
+static int process_pack(const char *path) {
+    cpack_t pack;
+    if (cpack_open(&pack, path) < 0) return -1;
+    static char name[PATH_MAX + 32];
+    for (size_t i = 0; i < pack.count; i++) {
+        size_t size;
+        const uint8_t *data = cpack_get(&pack, i, &size);
+        if (!data) { fprintf(stderr, "[!] %s: bad index entry %zu\n", path, i); continue; }
+        snprintf(name, sizeof(name), "%s#%zu", path, i);
+        run_input(name, data, size);
+    }
+    cpack_close(&pack);
     return 0;
 }
 
@@ -1225,15 +2089,27 @@ static int process_directory(const char *dirpath) {
 int main(int argc, char **argv) {
     srand(time(NULL));
     if (argc < 2) {
-        uint8_t buf[60000];
-        ssize_t len = read(STDIN_FILENO, buf, sizeof(buf));
-        if (len > 0) LLVMFuzzerTestOneInput(buf, (size_t)len);
+        size_t cap = 1 << 16, len = 0;
+        uint8_t *buf = malloc(cap);
+        ssize_t r;
+        while (buf && (r = read(STDIN_FILENO, buf + len, cap - len)) != 0) {
+            if (r < 0) { if (errno == EINTR) continue; break; }
+            len += (size_t)r;
+            if (len == cap) {
+                uint8_t *grown = realloc(buf, cap *= 2);
+                if (!grown) break;
+                buf = grown;
+            }
+        }
+        if (buf && len > 0) LLVMFuzzerTestOneInput(buf, len);
+        free(buf);
         return 0;
     }
     struct stat st;
     if (stat(argv[1], &st) < 0) return 1;
     if (S_ISDIR(st.st_mode)) return process_directory(argv[1]);
-    if (S_ISREG(st.st_mode)) return process_file(argv[1]);
+    if (S_ISREG(st.st_mode))
+        return cpack_is_pack(argv[1]) ? process_pack(argv[1]) : process_file(argv[1]);
     return 1;
 }
 #endif
\ No newline at end of file
@@ -0,0 +1,481 @@
+// fuzz/cairo_threaded_fuzzer.c
+// Concurrent-context stress harness.
+//
+// One input is split into N op streams that run on N threads. Every thread has
+// its own surface and cairo_t, but they all draw from the same patterns, source
+// surface, font faces and scaled font built by the decoder, which is where
+// cairo's global caches (and therefore contention and races) live.
+//
+// TSan build:       -fsanitize=thread,fuzzer           (see scripts/fuzz/threaded_fuzzer.sh)
+// Throughput build: -DTHREAD_BENCH -O2 -pthread        (adds a main() that replays a corpus
+//                                                        directory on 1..N threads and prints
+//                                                        the scaling efficiency)
+#define _GNU_SOURCE
+#include <cairo.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_THREADS 8
+#define MAX_STREAM_OPS 500
+#define N_SHARED_PATTERNS 4
+#define N_SHARED_FACES 3
+#define TILE_W 128
+#define TILE_H 128
+#define MAX_CAIRO_OPERATOR 28
+
+typedef struct {
+    cairo_pattern_t     *patterns[N_SHARED_PATTERNS];
+    cairo_surface_t     *source;
+    cairo_font_face_t   *faces[N_SHARED_FACES];
+    cairo_scaled_font_t *scaled;
+} shared_objs_t;
+
+typedef struct {
+    const shared_objs_t *shared;
+    const uint8_t       *data;
+    size_t               size;
+    pthread_barrier_t   *start;
+} stream_t;
+
+// -------- basic extraction (same layout as the stateful harness) --------
+static int pick_int(const uint8_t **data, size_t *len) {
+    if (*len < 4) return 0;
+    int v;
+    memcpy(&v, *data, 4);
+    *data += 4;
+    *len -= 4;
+    return v;
+}
+
+static double pick_double(const uint8_t **data, size_t *len) {
+    if (*len < sizeof(double)) return 0.0;
+    double v;
+    memcpy(&v, *data, sizeof(double));
+    *data += sizeof(double);
+    *len -= sizeof(double);
+    return v;
+}
+
+/* Bounded coordinate: the threads should spend their time inside cairo,
+ * not bailing out on NaN, so this is a tamer distribution than
+ * pick_double_extreme in the stateful harness. */
+static double pick_coord(const uint8_t **data, size_t *len) {
+    double v = pick_double(data, len);
+    if (!isfinite(v)) return 0.0;
+    return fmod(v, TILE_W * 2.0);
+}
+
+static double pick_unit(const uint8_t **data, size_t *len) {
+    double v = fabs(pick_double(data, len));
+    if (!isfinite(v)) return 0.5;
+    return fmod(v, 1.0);
+}
+
+/* ---------- shared object decoder ---------- */
+static void shared_objs_init(shared_objs_t *s, const uint8_t **in, size_t *remaining) {
+    memset(s, 0, sizeof(*s));
+
+    s->source = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, 32, 32);
+    if (cairo_surface_status(s->source) == CAIRO_STATUS_SUCCESS) {
+        unsigned char *px = cairo_image_surface_get_data(s->source);
+        size_t cap = (size_t)cairo_image_surface_get_stride(s->source) * 32;
+        size_t n = *remaining < cap ? *remaining : cap;
+        if (n > 256) n = 256;
+        for (size_t i = 0; i < cap; i++)
+            px[i] = n ? (*in)[i % n] : (unsigned char)i;
+        *in += n;
+        *remaining -= n;
+        cairo_surface_mark_dirty(s->source);
+    }
+
+    for (int i = 0; i < N_SHARED_PATTERNS; i++) {
+        cairo_pattern_t *p;
+        switch (i) {
+        case 0:
+            p = cairo_pattern_create_linear(pick_coord(in, remaining), pick_coord(in, remaining),
+                                            pick_coord(in, remaining), pick_coord(in, remaining));
+            break;
+        case 1:
+            p = cairo_pattern_create_radial(pick_coord(in, remaining), pick_coord(in, remaining),
+                                            pick_unit(in, remaining) * 16.0,
+                                            pick_coord(in, remaining), pick_coord(in, remaining),
+                                            pick_unit(in, remaining) * 64.0 + 1.0);
+            break;
+        case 2:
+            p = cairo_pattern_create_for_surface(s->source);
+            cairo_pattern_set_extend(p, (cairo_extend_t)(abs(pick_int(in, remaining)) % 4));
+            cairo_pattern_set_filter(p, (cairo_filter_t)(abs(pick_int(in, remaining)) % 6));
+            break;
+        default:
+            p = cairo_pattern_create_mesh();
+            cairo_mesh_pattern_begin_patch(p);
+            cairo_mesh_pattern_move_to(p, 0, 0);
+            cairo_mesh_pattern_line_to(p, pick_coord(in, remaining), 0);
+            cairo_mesh_pattern_line_to(p, TILE_W, pick_coord(in, remaining));
+            cairo_mesh_pattern_line_to(p, 0, TILE_H);
+            for (int c = 0; c < 4; c++)
+                cairo_mesh_pattern_set_corner_color_rgb(p, c, pick_unit(in, remaining),
+                                                        pick_unit(in, remaining),
+                                                        pick_unit(in, remaining));
+            cairo_mesh_pattern_end_patch(p);
+            break;
+        }
+        if (i < 2) {
+            int stops = (abs(pick_int(in, remaining)) % 6) + 2;
+            for (int k = 0; k < stops; k++)
+                cairo_pattern_add_color_stop_rgba(p, pick_unit(in, remaining),
+                                                  pick_unit(in, remaining), pick_unit(in, remaining),
+                                                  pick_unit(in, remaining), pick_unit(in, remaining));
+            cairo_pattern_set_extend(p, (cairo_extend_t)(abs(pick_int(in, remaining)) % 4));
+        }
+        s->patterns[i] = p;
+    }
+
+    static const char *families[N_SHARED_FACES] = {"Sans", "Serif", "Monospace"};
+    for (int i = 0; i < N_SHARED_FACES; i++)
+        s->faces[i] = cairo_toy_font_face_create(families[i],
+                                                 (cairo_font_slant_t)(abs(pick_int(in, remaining)) % 3),
+                                                 (cairo_font_weight_t)(abs(pick_int(in, remaining)) % 2));
+
+    cairo_matrix_t font_matrix, ctm;
+    double sz = pick_unit(in, remaining) * 40.0 + 4.0;
+    cairo_matrix_init_scale(&font_matrix, sz, sz);
+    cairo_matrix_init_identity(&ctm);
+    cairo_font_options_t *opts = cairo_font_options_create();
+    s->scaled = cairo_scaled_font_create(s->faces[0], &font_matrix, &ctm, opts);
+    cairo_font_options_destroy(opts);
+}
+
+static void shared_objs_fini(shared_objs_t *s) {
+    for (int i = 0; i < N_SHARED_PATTERNS; i++)
+        cairo_pattern_destroy(s->patterns[i]);
+    for (int i = 0; i < N_SHARED_FACES; i++)
+        cairo_font_face_destroy(s->faces[i]);
+    cairo_scaled_font_destroy(s->scaled);
+    cairo_surface_destroy(s->source);
+}
+
+/* ---------- per-thread op loop ---------- */
+static void run_stream(const shared_objs_t *sh, const uint8_t *in, size_t remaining) {
+    cairo_surface_t *surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, TILE_W, TILE_H);
+    cairo_t *cr = cairo_create(surface);
+    int groups = 0;
+
+    size_t ops = 0;
+    while (remaining > 0 && ops++ < MAX_STREAM_OPS) {
+        uint8_t op = *in++ % 20;
+        remaining--;
+
+        switch (op) {
+        case 0:
+            cairo_move_to(cr, pick_coord(&in, &remaining), pick_coord(&in, &remaining));
+            break;
+        case 1:
+            cairo_line_to(cr, pick_coord(&in, &remaining), pick_coord(&in, &remaining));
+            break;
+        case 2: {
+            double x1 = pick_coord(&in, &remaining), y1 = pick_coord(&in, &remaining);
+            double x2 = pick_coord(&in, &remaining), y2 = pick_coord(&in, &remaining);
+            double x3 = pick_coord(&in, &remaining), y3 = pick_coord(&in, &remaining);
+            cairo_curve_to(cr, x1, y1, x2, y2, x3, y3);
+            break;
+        }
+        case 3:
+            cairo_rectangle(cr, pick_coord(&in, &remaining), pick_coord(&in, &remaining),
+                            pick_unit(&in, &remaining) * TILE_W, pick_unit(&in, &remaining) * TILE_H);
+            break;
+        case 4:
+            cairo_fill(cr);
+            break;
+        case 5:
+            cairo_set_line_width(cr, pick_unit(&in, &remaining) * 10.0 + 0.1);
+            cairo_stroke(cr);
+            break;
+        case 6:
+            cairo_set_source(cr, sh->patterns[abs(pick_int(&in, &remaining)) % N_SHARED_PATTERNS]);
+            break;
+        case 7:
+            cairo_set_source_surface(cr, sh->source, pick_coord(&in, &remaining),
+                                     pick_coord(&in, &remaining));
+            break;
+        case 8:
+            cairo_paint_with_alpha(cr, pick_unit(&in, &remaining));
+            break;
+        case 9:
+            cairo_mask(cr, sh->patterns[abs(pick_int(&in, &remaining)) % N_SHARED_PATTERNS]);
+            break;
+        case 10:
+            cairo_set_font_face(cr, sh->faces[abs(pick_int(&in, &remaining)) % N_SHARED_FACES]);
+            cairo_set_font_size(cr, pick_unit(&in, &remaining) * 40.0 + 4.0);
+            break;
+        case 11:
+            cairo_set_scaled_font(cr, sh->scaled);
+            break;
+        case 12: {
+            static const char *words[] = {"cairo", "thread", "glyph", "cache", "race"};
+            cairo_move_to(cr, pick_coord(&in, &remaining), pick_coord(&in, &remaining));
+            cairo_show_text(cr, words[abs(pick_int(&in, &remaining)) % 5]);
+            break;
+        }
+        case 13: {
+            cairo_glyph_t glyphs[8];
+            int n = (abs(pick_int(&in, &remaining)) % 8) + 1;
+            for (int i = 0; i < n; i++) {
+                glyphs[i].index = (unsigned long)(abs(pick_int(&in, &remaining)) % 128);
+                glyphs[i].x = pick_coord(&in, &remaining);
+                glyphs[i].y = pick_coord(&in, &remaining);
+            }
+            if (pick_int(&in, &remaining) & 1) cairo_show_glyphs(cr, glyphs, n);
+            else { cairo_glyph_path(cr, glyphs, n); cairo_fill(cr); }
+            break;
+        }
+        case 14:
+            cairo_push_group(cr);
+            groups++;
+            break;
+        case 15:
+            if (groups > 0) {
+                cairo_pop_group_to_source(cr);
+                groups--;
+                cairo_paint(cr);
+            }
+            break;
+        case 16:
+            cairo_rectangle(cr, pick_coord(&in, &remaining), pick_coord(&in, &remaining),
+                            pick_unit(&in, &remaining) * TILE_W, pick_unit(&in, &remaining) * TILE_H);
+            cairo_clip(cr);
+            break;
+        case 17:
+            cairo_reset_clip(cr);
+            break;
+        case 18:
+            cairo_set_operator(cr, (cairo_operator_t)(abs(pick_int(&in, &remaining)) % (MAX_CAIRO_OPERATOR + 1)));
+            break;
+        default:
+            cairo_set_antialias(cr, (cairo_antialias_t)(abs(pick_int(&in, &remaining)) % 7));
+            break;
+        }
+    }
+
+    while (groups-- > 0)
+        cairo_pattern_destroy(cairo_pop_group(cr));
+    cairo_destroy(cr);
+    cairo_surface_flush(surface);
+    cairo_surface_destroy(surface);
+}
+
+static void *stream_thread(void *arg) {
+    stream_t *st = (stream_t*)arg;
+    pthread_barrier_wait(st->start);
+    run_stream(st->shared, st->data, st->size);
+    return NULL;
+}
+
+/* Runs the n streams concurrently; all threads are released together so
+ * their first cache lookups actually collide. */
+static void run_streams_parallel(const shared_objs_t *sh, stream_t *streams, int n) {
+    pthread_t tids[MAX_THREADS];
+    pthread_barrier_t start;
+    pthread_barrier_init(&start, NULL, (unsigned)n);
+    for (int i = 0; i < n; i++) {
+        streams[i].shared = sh;
+        streams[i].start = &start;
+        pthread_create(&tids[i], NULL, stream_thread, &streams[i]);
+    }
+    for (int i = 0; i < n; i++)
+        pthread_join(tids[i], NULL);
+    pthread_barrier_destroy(&start);
+}
+
+/* Thread count from the first byte, shared objects from the next bytes, and
+ * the rest cut into that many contiguous op streams. */
+static int pick_thread_count(const uint8_t **in, size_t *remaining) {
+    int n = (**in % MAX_THREADS) + 1;
+    *in += 1;
+    *remaining -= 1;
+    return n;
+}
+
+static void cut_streams(const uint8_t *in, size_t remaining, stream_t *streams, int n) {
+    size_t chunk = remaining / (size_t)n;
+    for (int i = 0; i < n; i++) {
+        streams[i].data = in + (size_t)i * chunk;
+        streams[i].size = (i == n - 1) ? remaining - (size_t)i * chunk : chunk;
+    }
+}
+
+/* ====================== LLVMFuzzerTestOneInput ====================== */
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+    if (size == 0 || !data) return 0;
+
+    const uint8_t *in = data;
+    size_t remaining = size;
+    stream_t streams[MAX_THREADS];
+
+    int n = pick_thread_count(&in, &remaining);
+    shared_objs_t shared;
+    shared_objs_init(&shared, &in, &remaining);
+    cut_streams(in, remaining, streams, n);
+
+    run_streams_parallel(&shared, streams, n);
+
+    shared_objs_fini(&shared);
+    return 0;
+}
+
+/* Throughput runner: weak scaling over a corpus directory. Every thread
+ * replays the whole corpus, so ideal scaling keeps wall time flat. */
+
+#ifdef THREAD_BENCH
+#include <dirent.h>
+#include <sys/stat.h>
+#include <time.h>
+#include "corpus_pack.h"
+
+typedef struct {
+    shared_objs_t shared;
+    stream_t      streams[MAX_THREADS];
+    int           n;
+    uint8_t      *buf;
+} prepared_input_t;
+
+typedef struct {
+    prepared_input_t  *inputs;
+    size_t             count;
+    int                reps;
+    pthread_barrier_t *start;
+} bench_worker_t;
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void *bench_worker(void *arg) {
+    bench_worker_t *w = (bench_worker_t*)arg;
+    pthread_barrier_wait(w->start);
+    for (int r = 0; r < w->reps; r++)
+        for (size_t i = 0; i < w->count; i++)
+            for (int s = 0; s < w->inputs[i].n; s++)
+                run_stream(&w->inputs[i].shared, w->inputs[i].streams[s].data,
+                           w->inputs[i].streams[s].size);
+    return NULL;
+}
+
+/* Takes ownership of buf. */
+static void add_input(prepared_input_t **inputs, size_t *n, size_t *cap,
+                      uint8_t *buf, size_t len) {
+    if (*n == *cap) {
+        *cap *= 2;
+        *inputs = realloc(*inputs, *cap * sizeof(**inputs));
+    }
+    prepared_input_t *p = &(*inputs)[(*n)++];
+    const uint8_t *in = buf;
+    size_t remaining = len;
+    p->buf = buf;
+    p->n = pick_thread_count(&in, &remaining);
+    shared_objs_init(&p->shared, &in, &remaining);
+    cut_streams(in, remaining, p->streams, p->n);
+}
+
+static int load_corpus(const char *path, prepared_input_t **out, size_t *count) {
+    size_t cap = 64, n = 0;
+    prepared_input_t *inputs = calloc(cap, sizeof(*inputs));
+
+    if (cpack_is_pack(path)) {
+        cpack_t pack;
+        if (cpack_open(&pack, path) < 0) { free(inputs); return -1; }
+        for (size_t i = 0; i < pack.count; i++) {
+            size_t len;
+            const uint8_t *data = cpack_get(&pack, i, &len);
+            if (!data || !len) continue;
+            uint8_t *buf = malloc(len);
+            memcpy(buf, data, len);
+            add_input(&inputs, &n, &cap, buf, len);
+        }
+        cpack_close(&pack);
+        *out = inputs;
+        *count = n;
+        return 0;
+    }
+
+    DIR *d = opendir(path);
+    if (!d) { perror("opendir"); free(inputs); return -1; }
+    struct dirent *ent;
+    char full[4096];
+    while ((ent = readdir(d)) != NULL) {
+        if (ent->d_name[0] == '.') continue;
+        snprintf(full, sizeof(full), "%s/%s", path, ent->d_name);
+        FILE *fp = fopen(full, "rb");
+        if (!fp) continue;
+        struct stat st;
+        if (fstat(fileno(fp), &st) < 0 || st.st_size <= 0) { fclose(fp); continue; }
+        uint8_t *buf = malloc((size_t)st.st_size);
+        size_t len = fread(buf, 1, (size_t)st.st_size, fp);
+        fclose(fp);
+        if (len == 0) { free(buf); continue; }
+        add_input(&inputs, &n, &cap, buf, len);
+    }
+    closedir(d);
+    *out = inputs;
+    *count = n;
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <corpus_dir|corpus.pack> [max_threads] [reps]\n", argv[0]);
+        return 1;
+    }
+    int max_threads = argc > 2 ? atoi(argv[2]) : 8;
+    int reps = argc > 3 ? atoi(argv[3]) : 3;
+    if (max_threads < 1) max_threads = 1;
+    if (reps < 1) reps = 1;
+
+    prepared_input_t *inputs = NULL;
+    size_t count = 0;
+    if (load_corpus(argv[1], &inputs, &count) < 0 || count == 0) {
+        fprintf(stderr, "no inputs in %s\n", argv[1]);
+        return 1;
+    }
+
+    printf("%-8s %12s %14s %10s\n", "threads", "wall_s", "inputs/s", "efficiency");
+    double base_rate = 0.0;
+    for (int t = 1; t <= max_threads; t++) {
+        pthread_t *tids = calloc((size_t)t, sizeof(*tids));
+        bench_worker_t *workers = calloc((size_t)t, sizeof(*workers));
+        pthread_barrier_t start;
+        pthread_barrier_init(&start, NULL, (unsigned)t + 1);
+        for (int i = 0; i < t; i++) {
+            workers[i] = (bench_worker_t){ inputs, count, reps, &start };
+            pthread_create(&tids[i], NULL, bench_worker, &workers[i]);
+        }
+        double t0 = now_sec();
+        pthread_barrier_wait(&start);
+        for (int i = 0; i < t; i++)
+            pthread_join(tids[i], NULL);
+        double wall = now_sec() - t0;
+        pthread_barrier_destroy(&start);
+
+        double rate = (double)count * reps * t / wall;
+        if (t == 1) base_rate = rate;
+        printf("%-8d %12.3f %14.1f %9.1f%%\n", t, wall, rate, 100.0 * rate / (base_rate * t));
+        fflush(stdout);
+        free(tids);
+        free(workers);
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        shared_objs_fini(&inputs[i].shared);
+        free(inputs[i].buf);
+    }
+    free(inputs);
+    return 0;
+}
+#endif
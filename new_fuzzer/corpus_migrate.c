@@ -0,0 +1,102 @@
+// new_fuzzer/corpus_migrate.c
+// One-time rewrite of a corpus recorded under another opcode modulus into the
+// fixed byte % OP_SLOTS of op_registry.h. Every input is walked the way the
+// harness walks it: the backend byte is copied, then each opcode byte is
+// decoded with the old modulus and rewritten as the slot number itself, and
+// the op's operands are copied through unchanged using its ops.def signature,
+// so every later byte keeps its offset. An old opcode past the last slot (only
+// possible with --from-slots above OP_SLOTS) becomes an empty slot, which runs
+// nothing, as it did before.
+//
+//   cc -O2 -Inew_fuzzer -o corpus_migrate new_fuzzer/corpus_migrate.c
+//   corpus_migrate --from-slots 61 old_corpus/ new_corpus/   (the original
+//       byte % 61 harness: all_crashes/, crash_min/, interesting/ ...)
+//
+// The text ops ("@") read operands at their offset without consuming them, so
+// an opcode byte they happen to cover can read differently after the rewrite.
+// Inputs found by a focused build (other families compiled out, which used to
+// consume no operands) are decoded as the full build would decode them.
+#include <dirent.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include "op_registry.h"
+
+#define MAX_OPS      2000   /* as LLVMFuzzerTestOneInput */
+
+static int empty_slot(void) {
+    for (int op = OP_SLOTS - 1; op >= 0; op--)
+        if (!op_signatures[op]) return op;
+    return -1;
+}
+
+static int migrate(uint8_t *buf, size_t size, int from_slots, int nop) {
+    const uint8_t *in = buf;
+    size_t remaining = size, ops = 0;
+    int changed = 0;
+    if (remaining == 0) return 0;
+    in++; remaining--;      /* backend selector */
+    while (remaining > 0 && ops++ < MAX_OPS) {
+        uint8_t *opcode = (uint8_t*)in;
+        int op = *opcode % from_slots;
+        in++; remaining--;
+        if (op >= OP_SLOTS) op = nop;
+        if (*opcode != op) { *opcode = (uint8_t)op; changed = 1; }
+        op_skip_operands(op, &in, &remaining);
+    }
+    return changed;
+}
+
+static uint8_t *read_file(const char *path, size_t *size) {
+    FILE *f = fopen(path, "rb");
+    if (!f) return NULL;
+    fseek(f, 0, SEEK_END);
+    long n = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    uint8_t *buf = n > 0 ? malloc((size_t)n) : malloc(1);
+    if (buf && n > 0 && fread(buf, 1, (size_t)n, f) != (size_t)n) { free(buf); buf = NULL; }
+    fclose(f);
+    *size = n > 0 ? (size_t)n : 0;
+    return buf;
+}
+
+int main(int argc, char **argv) {
+    if (argc != 5 || strcmp(argv[1], "--from-slots")) {
+        fprintf(stderr, "usage: %s --from-slots N in_dir out_dir\n", argv[0]);
+        return 1;
+    }
+    int from_slots = atoi(argv[2]);
+    if (from_slots < 1 || from_slots > 256) {
+        fprintf(stderr, "bad --from-slots %s\n", argv[2]);
+        return 1;
+    }
+    DIR *d = opendir(argv[3]);
+    if (!d) { perror(argv[3]); return 1; }
+    mkdir(argv[4], 0755);
+
+    size_t files = 0, rewritten = 0;
+    struct dirent *e;
+    while ((e = readdir(d))) {
+        char src[4096], dst[4096];
+        struct stat st;
+        snprintf(src, sizeof(src), "%s/%s", argv[3], e->d_name);
+        if (stat(src, &st) || !S_ISREG(st.st_mode)) continue;
+        size_t size;
+        uint8_t *buf = read_file(src, &size);
+        if (!buf) { perror(src); continue; }
+        rewritten += migrate(buf, size, from_slots, empty_slot());
+        snprintf(dst, sizeof(dst), "%s/%s", argv[4], e->d_name);
+        FILE *f = fopen(dst, "wb");
+        if (!f || fwrite(buf, 1, size, f) != size) perror(dst);
+        if (f) fclose(f);
+        free(buf);
+        files++;
+    }
+    closedir(d);
+    fprintf(stderr, "%zu inputs, %zu rewritten (from byte %% %d to byte %% %d)\n",
+            files, rewritten, from_slots, OP_SLOTS);
+    return 0;
+}
@@ -0,0 +1,112 @@
+// fuzz/corpus_pack.h
+// Corpus packs: a whole corpus in two files so replay is one sequential read
+// instead of an open/stat/read per input.
+//
+//   NAME.pack      "CPACKDAT" + u32 version + u32 0, then the inputs back to back
+//   NAME.pack.idx  "CPACKIDX" + u32 version + u32 0, then one record per input:
+//                  u64 offset, u64 length, u64 fnv1a64(input)   (little endian)
+//
+// Both files are append-only; scripts/corpus_pack/pack.py appends the data
+// before the index record, so an interrupted append just leaves unindexed
+// bytes at the end of the data file. Records pointing outside the data file
+// are skipped.
+//
+// Inputs are handed out as zero-copy slices of the mapping. Note that ASan
+// can't see overreads past the end of a slice, since the next input follows
+// it; replay a single extracted file to check one.
+#ifndef CORPUS_PACK_H
+#define CORPUS_PACK_H
+
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define CPACK_DATA_MAGIC "CPACKDAT"
+#define CPACK_IDX_MAGIC  "CPACKIDX"
+#define CPACK_VERSION    1
+#define CPACK_HEADER     16
+
+typedef struct {
+    uint64_t offset;
+    uint64_t length;
+    uint64_t hash;
+} cpack_entry_t;
+
+typedef struct {
+    const uint8_t       *data;
+    size_t               data_len;
+    const cpack_entry_t *entries;
+    size_t               count;
+    void                *idx_map;
+    size_t               idx_len;
+} cpack_t;
+
+/* True if path starts with the pack data magic. */
+static int cpack_is_pack(const char *path) {
+    char magic[8];
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return 0;
+    ssize_t r = read(fd, magic, sizeof(magic));
+    close(fd);
+    return r == (ssize_t)sizeof(magic) && !memcmp(magic, CPACK_DATA_MAGIC, 8);
+}
+
+static void *cpack_map(const char *path, size_t *len, const char *magic) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) { perror(path); return NULL; }
+    struct stat st;
+    if (fstat(fd, &st) < 0 || st.st_size < CPACK_HEADER) { close(fd); return NULL; }
+    void *p = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) { perror("mmap"); return NULL; }
+    uint32_t version;
+    memcpy(&version, (const char*)p + 8, sizeof(version));
+    if (memcmp(p, magic, 8) || version != CPACK_VERSION) {
+        fprintf(stderr, "%s: not a version %d corpus pack\n", path, CPACK_VERSION);
+        munmap(p, (size_t)st.st_size);
+        return NULL;
+    }
+    *len = (size_t)st.st_size;
+    return p;
+}
+
+static int cpack_open(cpack_t *pack, const char *path) {
+    char idx_path[4096];
+    memset(pack, 0, sizeof(*pack));
+    if (snprintf(idx_path, sizeof(idx_path), "%s.idx", path) >= (int)sizeof(idx_path))
+        return -1;
+    pack->data = cpack_map(path, &pack->data_len, CPACK_DATA_MAGIC);
+    if (!pack->data) return -1;
+    pack->idx_map = cpack_map(idx_path, &pack->idx_len, CPACK_IDX_MAGIC);
+    if (!pack->idx_map) {
+        munmap((void*)pack->data, pack->data_len);
+        pack->data = NULL;
+        return -1;
+    }
+    pack->entries = (const cpack_entry_t*)((const uint8_t*)pack->idx_map + CPACK_HEADER);
+    pack->count = (pack->idx_len - CPACK_HEADER) / sizeof(cpack_entry_t);
+    madvise((void*)pack->data, pack->data_len, MADV_SEQUENTIAL);
+    return 0;
+}
+
+static void cpack_close(cpack_t *pack) {
+    if (pack->data) munmap((void*)pack->data, pack->data_len);
+    if (pack->idx_map) munmap(pack->idx_map, pack->idx_len);
+    memset(pack, 0, sizeof(*pack));
+}
+
+/* Slice for entry i, NULL if the record is out of bounds. */
+static inline const uint8_t *cpack_get(const cpack_t *pack, size_t i, size_t *size) {
+    const cpack_entry_t *e = &pack->entries[i];
+    if (e->offset < CPACK_HEADER || e->offset > pack->data_len ||
+        e->length > pack->data_len - e->offset)
+        return NULL;
+    *size = (size_t)e->length;
+    return pack->data + e->offset;
+}
+
+#endif
@@ -0,0 +1,128 @@
+// fuzz/cost_feedback.h
+// Performance-bug mode for the stateful harness (-DCOST_FEEDBACK).
+//
+// Every op is charged its cost: user-space instructions from perf_event when
+// the kernel lets us open a counter, wall-clock ns from CLOCK_MONOTONIC
+// otherwise. Costs are summed per op family (from ops.def) and, once the input
+// has run, the log2 of (family cost / input length) lights one extra counter
+// per family.
+// libFuzzer therefore keeps any input that pushes some family into a more
+// expensive bucket than before, and the search climbs towards super-linear
+// behaviour instead of discarding it as a timeout.
+//
+// The K most expensive inputs per family (by cost per input byte) are kept in
+// $COST_TOP_DIR (default ./cost_top) as <family>/cost_<cost>_<hash>.
+#ifndef COST_FEEDBACK_H
+#define COST_FEEDBACK_H
+
+#include "extra_counters.h"
+#include "op_registry.h"
+#include <errno.h>
+#include <linux/perf_event.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#define COST_TOP_K 8
+
+typedef struct {
+    uint64_t score;
+    char     path[512];
+} cost_top_entry_t;
+
+static int cost_perf_fd = -2;              /* -2: not tried yet, -1: unavailable */
+static uint64_t cost_family[NUM_OP_FAMILIES];
+static uint64_t cost_op_start;
+static cost_top_entry_t cost_top[NUM_OP_FAMILIES][COST_TOP_K];
+static const char *cost_top_dir;
+
+static void cost_init(void) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    cost_perf_fd = (int)syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+    if (cost_perf_fd < 0) {
+        cost_perf_fd = -1;
+        fprintf(stderr, "[cost] perf_event_open failed (%s), falling back to ns\n", strerror(errno));
+    }
+
+    cost_top_dir = getenv("COST_TOP_DIR");
+    if (!cost_top_dir) cost_top_dir = "cost_top";
+    mkdir(cost_top_dir, 0755);
+    char dir[512];
+    for (int f = 0; f < NUM_OP_FAMILIES; f++) {
+        snprintf(dir, sizeof(dir), "%s/%s", cost_top_dir, op_family_names[f]);
+        mkdir(dir, 0755);
+    }
+}
+
+static inline uint64_t cost_now(void) {
+    if (cost_perf_fd >= 0) {
+        uint64_t v = 0;
+        if (read(cost_perf_fd, &v, sizeof(v)) == (ssize_t)sizeof(v)) return v;
+    }
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static inline void cost_exec_begin(void) {
+    if (cost_perf_fd == -2) cost_init();
+    memset(cost_family, 0, sizeof(cost_family));
+}
+
+static inline void cost_op_begin(void) {
+    cost_op_start = cost_now();
+}
+
+static inline void cost_op_end(int op) {
+    cost_family[op_family(op)] += cost_now() - cost_op_start;
+}
+
+static void cost_save_top(int fam, uint64_t score, uint64_t raw,
+                          const uint8_t *data, size_t size) {
+    cost_top_entry_t *slots = cost_top[fam];
+    int victim = 0;
+    for (int i = 1; i < COST_TOP_K; i++)
+        if (slots[i].score < slots[victim].score) victim = i;
+    if (slots[victim].score >= score) return;
+
+    uint64_t h = 1469598103934665603ull;
+    for (size_t i = 0; i < size; i++) { h ^= data[i]; h *= 1099511628211ull; }
+
+    char path[512];
+    snprintf(path, sizeof(path), "%s/%s/cost_%012llu_%016llx", cost_top_dir,
+             op_family_names[fam], (unsigned long long)raw, (unsigned long long)h);
+    for (int i = 0; i < COST_TOP_K; i++)
+        if (!strcmp(slots[i].path, path)) return;   /* same input already kept */
+
+    FILE *fp = fopen(path, "wb");
+    if (!fp) return;
+    fwrite(data, 1, size, fp);
+    fclose(fp);
+
+    if (slots[victim].path[0]) unlink(slots[victim].path);
+    slots[victim].score = score;
+    snprintf(slots[victim].path, sizeof(slots[victim].path), "%s", path);
+}
+
+static void cost_exec_end(const uint8_t *data, size_t size) {
+    for (int f = 0; f < NUM_OP_FAMILIES; f++) {
+        if (!cost_family[f]) continue;
+        uint64_t per_byte = cost_family[f] / (size ? size : 1);
+        unsigned bucket = xc_log2(per_byte);
+        if (bucket >= XC_NUM_BUCKETS) bucket = XC_NUM_BUCKETS - 1;
+        xc_set(XC_COST_BASE + f * XC_NUM_BUCKETS, XC_NUM_BUCKETS, bucket);
+        cost_save_top(f, per_byte, cost_family[f], data, size);
+    }
+}
+
+#endif
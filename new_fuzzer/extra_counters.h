@@ -0,0 +1,51 @@
+// fuzz/extra_counters.h
+// libFuzzer treats every byte in the __libfuzzer_extra_counters section like
+// an edge counter: a counter going from 0 to non-zero (or into a new count
+// bucket) is a new feature and keeps the input. The section is cleared before
+// every run. The harness uses it to feed back signals that edge coverage
+// cannot see. Each signal owns a fixed slice so the modes can be combined.
+#ifndef EXTRA_COUNTERS_H
+#define EXTRA_COUNTERS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define XC_NUM_FAMILIES    16
+#define XC_NUM_BUCKETS     32
+
+/* op family x log2(cost per input byte), see cost_feedback.h */
+#define XC_COST_BASE       0
+#define XC_COST_SIZE       (XC_NUM_FAMILIES * XC_NUM_BUCKETS)
+
+/* log2(peak heap / input length), then op x log4(heap growth in that op),
+ * see mem_amplification.h */
+#define XC_MEM_OPS         128
+#define XC_MEM_OP_BUCKETS  16
+#define XC_MEM_BASE        (XC_COST_BASE + XC_COST_SIZE)
+#define XC_MEM_SIZE        (XC_NUM_BUCKETS + XC_MEM_OPS * XC_MEM_OP_BUCKETS)
+
+/* single cairo-state values, pairs of them and a hash of the whole state
+ * tuple after each op, see state_features.h */
+#define XC_STATE_BASE      (XC_MEM_BASE + XC_MEM_SIZE)
+#define XC_STATE_SIZE      (704 + 8192)
+
+/* cairo_status x op family of the op that put the context into an error
+ * state, set by the harness itself in every build */
+#define XC_ERROR_BASE      (XC_STATE_BASE + XC_STATE_SIZE)
+#define XC_ERROR_SIZE      (64 * XC_NUM_FAMILIES)
+
+#define XC_TOTAL_SIZE      (XC_ERROR_BASE + XC_ERROR_SIZE)
+
+__attribute__((section("__libfuzzer_extra_counters"), used))
+static uint8_t extra_counters[XC_TOTAL_SIZE];
+
+static inline void xc_set(size_t base, size_t size, size_t idx) {
+    extra_counters[base + (idx % size)] = 1;
+}
+
+/* floor(log2(v)), 0 for v == 0 */
+static inline unsigned xc_log2(uint64_t v) {
+    return v ? 63u - (unsigned)__builtin_clzll(v) : 0u;
+}
+
+#endif
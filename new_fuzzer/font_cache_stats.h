@@ -0,0 +1,230 @@
+// fuzz/font_cache_stats.h
+// Scaled-font and glyph-cache behaviour of the text ops (-DFONT_CACHE_STATS).
+//
+// cairo keeps its scaled fonts in a global map (plus a holdover list of
+// recently released ones) and rasterized glyphs in per-font caches capped by a
+// global page budget. None of that is visible through the API, so this mode
+// infers it:
+//   - after a TEXT-family op that drew or measured glyphs, or that otherwise
+//     asked for the scaled font (font_extents marks itself with
+//     font_resolved()), cairo has resolved the context's scaled font, so
+//     reading it back touches no cache. If it is
+//     the font the previous such op used, the context reused it without a
+//     lookup and nothing is counted. Otherwise a font that already carries our
+//     user data is a cache hit, an untagged one is a miss (cairo had to create
+//     it) and gets tagged. Other text ops are never followed by a font getter,
+//     since resolving a font there would itself fill the caches;
+//   - the tag's destroy callback fires when cairo finally drops the font, which
+//     counts scaled-font evictions and their age in ops;
+//   - user-font glyphs (op user_font_glyphs) report every render_glyph call. The
+//     first render of a (font, glyph) pair is a glyph-cache miss, a repeated one
+//     means the glyph was evicted in between;
+//   - text ops report how many glyphs they drew, for time per glyph.
+// The process keeps running across inputs like a fuzzer or a server would, so
+// the numbers are cumulative. They are written to $FONT_CACHE_STATS (default
+// ./font_cache_stats.txt) every FONT_DUMP_EVERY runs and at exit.
+#ifndef FONT_CACHE_STATS_H
+#define FONT_CACHE_STATS_H
+
+#include "op_registry.h"
+#include <cairo.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define FONT_DUMP_EVERY   10000
+#define FONT_GLYPH_SLOTS  1024     /* glyph ids remembered per scaled font */
+
+typedef struct {
+    uint64_t      id;
+    uint64_t      born_op;
+    unsigned      nglyphs;
+    unsigned long glyphs[FONT_GLYPH_SLOTS];   /* open addressing, id + 1 */
+} font_tag_t;
+
+typedef struct {
+    uint64_t calls, hits, misses, glyphs;
+    double   ns;
+} font_op_stat_t;
+
+static cairo_user_data_key_t font_tag_key, font_face_tag_key;
+static font_op_stat_t font_ops[OP_SLOTS];
+static const char *font_stats_path;
+static uint64_t font_runs, font_total_ops;
+static uint64_t font_sf_alive, font_sf_peak, font_sf_evicted, font_sf_age_sum;
+static uint64_t font_faces_seen, font_faces_alive;
+static uint64_t font_glyph_misses, font_glyph_rerenders, font_glyph_untracked;
+static uint64_t font_op_start;
+static uint64_t font_op_glyphs;
+static int font_op_resolved;                  /* op resolved the scaled font */
+static uint64_t font_next_id, font_last_id;   /* tag of the last font read back */
+static int font_cur_op;
+
+static void font_dump(void);
+
+static inline uint64_t font_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static void font_tag_destroy(void *p) {
+    font_tag_t *t = p;
+    font_sf_alive--;
+    font_sf_evicted++;
+    font_sf_age_sum += font_total_ops - t->born_op;
+    free(t);
+}
+
+static void font_face_tag_destroy(void *p) {
+    (void)p;
+    font_faces_alive--;
+}
+
+static void font_init(void) {
+    font_stats_path = getenv("FONT_CACHE_STATS");
+    if (!font_stats_path) font_stats_path = "font_cache_stats.txt";
+    atexit(font_dump);
+}
+
+static inline void font_op_begin(int op) {
+    if (op_family(op) != FAM_TEXT) return;
+    if (!font_stats_path) font_init();
+    font_cur_op = op;
+    font_total_ops++;
+    font_op_glyphs = 0;
+    font_op_resolved = 0;
+    font_op_start = font_now();
+}
+
+/* glyphs the current text op asked cairo to draw or measure */
+static inline void font_glyphs(int n) {
+    if (n > 0) {
+        font_op_glyphs += (uint64_t)n;
+        font_op_resolved = 1;
+    }
+}
+
+/* the current text op resolved the scaled font without drawing glyphs */
+static inline void font_resolved(void) {
+    font_op_resolved = 1;
+}
+
+static void font_op_end(cairo_t *cr, int op) {
+    if (op_family(op) != FAM_TEXT) return;
+    font_op_stat_t *s = &font_ops[op];
+    s->ns += (double)(font_now() - font_op_start);
+    s->calls++;
+    s->glyphs += font_op_glyphs;
+
+    /* only after ops that resolved the scaled font (see above) */
+    if (!font_op_resolved || cairo_status(cr) != CAIRO_STATUS_SUCCESS) return;
+    cairo_font_face_t *face = cairo_get_font_face(cr);
+    if (cairo_font_face_status(face) == CAIRO_STATUS_SUCCESS &&
+        !cairo_font_face_get_user_data(face, &font_face_tag_key) &&
+        cairo_font_face_set_user_data(face, &font_face_tag_key, (void*)1,
+                                      font_face_tag_destroy) == CAIRO_STATUS_SUCCESS) {
+        font_faces_seen++;
+        font_faces_alive++;
+    }
+
+    cairo_scaled_font_t *sf = cairo_get_scaled_font(cr);
+    if (cairo_scaled_font_status(sf) != CAIRO_STATUS_SUCCESS) return;
+    const font_tag_t *seen = cairo_scaled_font_get_user_data(sf, &font_tag_key);
+    if (seen) {
+        /* tagged by a glyph render during this very op: already a miss */
+        if (seen->id != font_last_id && seen->born_op != font_total_ops) s->hits++;
+        font_last_id = seen->id;
+        return;
+    }
+    font_tag_t *t = calloc(1, sizeof(*t));
+    if (!t) return;
+    t->id = ++font_next_id;
+    t->born_op = font_total_ops;
+    if (cairo_scaled_font_set_user_data(sf, &font_tag_key, t, font_tag_destroy) != CAIRO_STATUS_SUCCESS) {
+        free(t);
+        return;
+    }
+    s->misses++;
+    font_last_id = t->id;
+    if (++font_sf_alive > font_sf_peak) font_sf_peak = font_sf_alive;
+}
+
+/* from the user font's render_glyph callback */
+static void font_glyph_rendered(cairo_scaled_font_t *sf, unsigned long glyph) {
+    font_tag_t *t = cairo_scaled_font_get_user_data(sf, &font_tag_key);
+    if (!t) {
+        /* first use of this font is inside the current op */
+        t = calloc(1, sizeof(*t));
+        if (!t) return;
+        t->id = ++font_next_id;
+        t->born_op = font_total_ops;
+        if (cairo_scaled_font_set_user_data(sf, &font_tag_key, t, font_tag_destroy) != CAIRO_STATUS_SUCCESS) {
+            free(t);
+            return;
+        }
+        font_ops[font_cur_op].misses++;
+        if (++font_sf_alive > font_sf_peak) font_sf_peak = font_sf_alive;
+    }
+    unsigned long key = glyph + 1;
+    unsigned h = (unsigned)(glyph * 2654435761u) % FONT_GLYPH_SLOTS;
+    for (unsigned i = 0; i < FONT_GLYPH_SLOTS; i++) {
+        unsigned long *slot = &t->glyphs[(h + i) % FONT_GLYPH_SLOTS];
+        if (*slot == key) { font_glyph_rerenders++; return; }
+        if (*slot == 0) {
+            if (t->nglyphs >= FONT_GLYPH_SLOTS / 2) break;
+            *slot = key;
+            t->nglyphs++;
+            font_glyph_misses++;
+            return;
+        }
+    }
+    font_glyph_untracked++;
+}
+
+static void font_exec_end(void) {
+    font_last_id = 0;   /* the next run starts on a fresh context */
+    if (++font_runs % FONT_DUMP_EVERY == 0) font_dump();
+}
+
+static void font_dump(void) {
+    char tmp[512];
+    snprintf(tmp, sizeof(tmp), "%s.tmp", font_stats_path);
+    FILE *fp = fopen(tmp, "w");
+    if (!fp) return;
+
+    uint64_t hits = 0, misses = 0;
+    for (int op = 0; op < OP_SLOTS; op++) {
+        hits += font_ops[op].hits;
+        misses += font_ops[op].misses;
+    }
+    fprintf(fp, "# runs %llu, text ops %llu\n", (unsigned long long)font_runs,
+            (unsigned long long)font_total_ops);
+    fprintf(fp, "scaled fonts: hits %llu misses %llu (hit rate %.1f%%)\n", (unsigned long long)hits,
+            (unsigned long long)misses, hits + misses ? 100.0 * hits / (hits + misses) : 0.0);
+    fprintf(fp, "scaled fonts: alive %llu peak %llu evicted %llu mean age %.1f text ops\n",
+            (unsigned long long)font_sf_alive, (unsigned long long)font_sf_peak,
+            (unsigned long long)font_sf_evicted,
+            font_sf_evicted ? (double)font_sf_age_sum / font_sf_evicted : 0.0);
+    fprintf(fp, "font faces: seen %llu alive %llu\n", (unsigned long long)font_faces_seen,
+            (unsigned long long)font_faces_alive);
+    fprintf(fp, "user-font glyphs: cache misses %llu re-rendered after eviction %llu untracked %llu\n",
+            (unsigned long long)font_glyph_misses, (unsigned long long)font_glyph_rerenders,
+            (unsigned long long)font_glyph_untracked);
+
+    fprintf(fp, "\n%-4s %-20s %10s %10s %10s %12s %12s\n", "slot", "op", "calls", "sf_hits",
+            "sf_misses", "glyphs", "ns/glyph");
+    for (int op = 0; op < OP_SLOTS; op++) {
+        const font_op_stat_t *s = &font_ops[op];
+        if (!s->calls) continue;
+        fprintf(fp, "%-4d %-20s %10llu %10llu %10llu %12llu %12.1f\n", op, op_names[op],
+                (unsigned long long)s->calls, (unsigned long long)s->hits,
+                (unsigned long long)s->misses, (unsigned long long)s->glyphs,
+                s->glyphs ? s->ns / s->glyphs : 0.0);
+    }
+    fclose(fp);
+    rename(tmp, font_stats_path);
+}
+
+#endif
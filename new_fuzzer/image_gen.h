@@ -0,0 +1,89 @@
+// fuzz/image_gen.h
+// Procedural source images shared by the harness's big_image op and
+// bench/image_filter_bench.c: a few bytes of seed describe an image of
+// thousands of pixels per side, so inputs stay small. The kinds differ in what
+// resampling has to do with them: noise has energy at every frequency, fine
+// stripes and checkers alias badly when downscaled without a proper filter,
+// smooth is photo-like and mostly low frequency.
+#ifndef IMAGE_GEN_H
+#define IMAGE_GEN_H
+
+#include <cairo.h>
+#include <stddef.h>
+#include <stdint.h>
+
+enum { IGEN_NOISE, IGEN_STRIPES, IGEN_CHECKER, IGEN_SMOOTH, IGEN_ALPHA_EDGES, NUM_IGEN };
+
+static const char *const igen_names[NUM_IGEN] = {
+    "noise", "stripes", "checker", "smooth", "alpha-edges",
+};
+
+static inline uint32_t igen_hash(uint32_t x) {
+    x ^= x >> 16; x *= 0x7feb352du;
+    x ^= x >> 15; x *= 0x846ca68bu;
+    x ^= x >> 16;
+    return x;
+}
+
+/* premultiplied ARGB32 pixel of kind at (x, y) */
+static inline uint32_t igen_pixel(int kind, uint32_t seed, int x, int y) {
+    uint32_t h = igen_hash(seed ^ igen_hash((uint32_t)x * 0x9e3779b9u ^ (uint32_t)y));
+    uint32_t a = 255, r, g, b;
+    switch (kind) {
+    case IGEN_NOISE:
+        r = h & 255; g = (h >> 8) & 255; b = (h >> 16) & 255; a = (h >> 24) | 1;
+        break;
+    case IGEN_STRIPES: {
+        /* 1..4 pixel wide stripes, vertical or diagonal */
+        int half = 1 + (int)(seed % 4);
+        r = g = b = ((x + ((seed & 16) ? y : 0)) / half) & 1 ? 255 : 0;
+        break;
+    }
+    case IGEN_CHECKER: {
+        int cell = 1 << (seed % 4);
+        uint32_t on = ((x / cell) ^ (y / cell)) & 1;
+        r = on ? 240 : 20; g = on ? 30 : 200; b = on ? 90 : 10;
+        break;
+    }
+    case IGEN_SMOOTH: {
+        /* two octaves of blocky lattice noise, mostly low frequency */
+        uint32_t c0 = igen_hash(seed ^ igen_hash((uint32_t)(x >> 6) * 0x85ebca6bu ^ (uint32_t)(y >> 6)));
+        uint32_t c1 = igen_hash((seed + 1) ^ igen_hash((uint32_t)(x >> 3) * 0xc2b2ae35u ^ (uint32_t)(y >> 3)));
+        r = ((c0 & 255) * 3 + (c1 & 255)) / 4;
+        g = (((c0 >> 8) & 255) * 3 + ((c1 >> 8) & 255)) / 4;
+        b = (((c0 >> 16) & 255) * 3 + ((c1 >> 16) & 255)) / 4;
+        break;
+    }
+    default: { /* IGEN_ALPHA_EDGES: opaque discs on transparent, hard edges */
+        int cx = ((x >> 5) << 5) + 16, cy = ((y >> 5) << 5) + 16;
+        int dx = x - cx, dy = y - cy;
+        a = dx * dx + dy * dy < 144 ? 255 : 0;
+        r = a ? (h & 255) : 0; g = a ? ((h >> 8) & 255) : 0; b = a ? 200 : 0;
+        break;
+    }
+    }
+    r = r * a / 255; g = g * a / 255; b = b * a / 255;
+    return a << 24 | r << 16 | g << 8 | b;
+}
+
+/* Fills an image surface (ARGB32, RGB24 or A8) with kind. */
+static void igen_fill(cairo_surface_t *img, int kind, uint32_t seed) {
+    cairo_surface_flush(img);
+    unsigned char *data = cairo_image_surface_get_data(img);
+    if (!data) return;
+    int w = cairo_image_surface_get_width(img), h = cairo_image_surface_get_height(img);
+    int stride = cairo_image_surface_get_stride(img);
+    cairo_format_t fmt = cairo_image_surface_get_format(img);
+    for (int y = 0; y < h; y++) {
+        unsigned char *row = data + (size_t)y * stride;
+        for (int x = 0; x < w; x++) {
+            uint32_t p = igen_pixel(kind, seed, x, y);
+            if (fmt == CAIRO_FORMAT_A8) row[x] = (unsigned char)(p >> 24);
+            else if (fmt == CAIRO_FORMAT_RGB24) ((uint32_t*)row)[x] = p | 0xff000000u;
+            else ((uint32_t*)row)[x] = p;
+        }
+    }
+    cairo_surface_mark_dirty(img);
+}
+
+#endif
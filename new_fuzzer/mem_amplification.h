@@ -0,0 +1,151 @@
+// fuzz/mem_amplification.h
+// Memory-amplification mode for the stateful harness (-DMEM_AMPLIFICATION).
+//
+// Live heap bytes are tracked through the sanitizer allocator hooks (so this
+// mode needs an ASan/MSan/... build, which every fuzz script already is). The
+// feedback signal is the peak allocation of a run divided by its input length:
+// its log2 lights one extra counter, together with a counter for (op that grew
+// the heap the most, log2 of that growth), so libFuzzer keeps inputs that
+// allocate more per byte or that find a new op that allocates a lot.
+//
+// The worst amplifiers are saved to $MEM_TOP_DIR (default ./mem_top) and
+// listed, ranked, in $MEM_TOP_DIR/report.txt together with the responsible op.
+#ifndef MEM_AMPLIFICATION_H
+#define MEM_AMPLIFICATION_H
+
+#include "extra_counters.h"
+#include <sanitizer/allocator_interface.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define MEM_TOP_N 32
+
+typedef struct {
+    double   ratio;
+    size_t   peak;
+    size_t   input_size;
+    int      op;
+    size_t   op_bytes;
+    char     path[512];
+} mem_top_entry_t;
+
+static volatile size_t mem_cur, mem_peak;
+static size_t mem_exec_base, mem_exec_peak, mem_op_base;
+static size_t mem_worst_op_bytes;
+static int mem_worst_op = -1;
+static int mem_hooks_installed;
+static mem_top_entry_t mem_top[MEM_TOP_N];
+static const char *mem_top_dir;
+
+static void mem_malloc_hook(const volatile void *ptr, size_t size) {
+    (void)ptr;
+    size_t cur = mem_cur + size;
+    mem_cur = cur;
+    if (cur > mem_peak) mem_peak = cur;
+}
+
+static void mem_free_hook(const volatile void *ptr) {
+    if (!ptr) return;
+    size_t size = __sanitizer_get_allocated_size((const void*)ptr);
+    /* blocks allocated before the hooks went in were never counted */
+    mem_cur = size > mem_cur ? 0 : mem_cur - size;
+}
+
+static void mem_init(void) {
+    __sanitizer_install_malloc_and_free_hooks(mem_malloc_hook, mem_free_hook);
+    mem_hooks_installed = 1;
+    mem_top_dir = getenv("MEM_TOP_DIR");
+    if (!mem_top_dir) mem_top_dir = "mem_top";
+    mkdir(mem_top_dir, 0755);
+}
+
+static inline void mem_exec_begin(void) {
+    if (!mem_hooks_installed) mem_init();
+    mem_exec_base = mem_cur;
+    mem_exec_peak = mem_cur;
+    mem_worst_op = -1;
+    mem_worst_op_bytes = 0;
+}
+
+static inline void mem_op_begin(void) {
+    mem_op_base = mem_cur;
+    mem_peak = mem_cur;
+}
+
+static inline void mem_op_end(int op) {
+    size_t peak = mem_peak;
+    if (peak > mem_exec_peak) mem_exec_peak = peak;
+    size_t grew = peak > mem_op_base ? peak - mem_op_base : 0;
+    if (grew > mem_worst_op_bytes) {
+        mem_worst_op_bytes = grew;
+        mem_worst_op = op;
+    }
+}
+
+static int mem_cmp_desc(const void *a, const void *b) {
+    double x = ((const mem_top_entry_t*)a)->ratio, y = ((const mem_top_entry_t*)b)->ratio;
+    return (x < y) - (x > y);
+}
+
+static void mem_write_report(void) {
+    char path[512];
+    snprintf(path, sizeof(path), "%s/report.txt", mem_top_dir);
+    FILE *fp = fopen(path, "w");
+    if (!fp) return;
+    mem_top_entry_t sorted[MEM_TOP_N];
+    memcpy(sorted, mem_top, sizeof(sorted));
+    qsort(sorted, MEM_TOP_N, sizeof(sorted[0]), mem_cmp_desc);
+    fprintf(fp, "%-4s %14s %14s %10s %4s %14s  %s\n",
+            "rank", "bytes/in_byte", "peak_bytes", "in_bytes", "op", "op_bytes", "input");
+    for (int i = 0; i < MEM_TOP_N && sorted[i].path[0]; i++)
+        fprintf(fp, "%-4d %14.1f %14zu %10zu %4d %14zu  %s\n", i + 1, sorted[i].ratio,
+                sorted[i].peak, sorted[i].input_size, sorted[i].op, sorted[i].op_bytes,
+                sorted[i].path);
+    fclose(fp);
+}
+
+static void mem_save_top(double ratio, size_t peak, const uint8_t *data, size_t size) {
+    int victim = 0;
+    for (int i = 1; i < MEM_TOP_N; i++)
+        if (mem_top[i].ratio < mem_top[victim].ratio) victim = i;
+    if (mem_top[victim].ratio >= ratio) return;
+
+    uint64_t h = 1469598103934665603ull;
+    for (size_t i = 0; i < size; i++) { h ^= data[i]; h *= 1099511628211ull; }
+    char path[512];
+    snprintf(path, sizeof(path), "%s/amp_%016llx", mem_top_dir, (unsigned long long)h);
+    for (int i = 0; i < MEM_TOP_N; i++)
+        if (!strcmp(mem_top[i].path, path)) return;
+
+    FILE *fp = fopen(path, "wb");
+    if (!fp) return;
+    fwrite(data, 1, size, fp);
+    fclose(fp);
+
+    if (mem_top[victim].path[0]) unlink(mem_top[victim].path);
+    mem_top[victim] = (mem_top_entry_t){ ratio, peak, size, mem_worst_op, mem_worst_op_bytes, "" };
+    snprintf(mem_top[victim].path, sizeof(mem_top[victim].path), "%s", path);
+    mem_write_report();
+}
+
+static void mem_exec_end(const uint8_t *data, size_t size) {
+    size_t peak = mem_exec_peak - mem_exec_base;
+    double ratio = (double)peak / (double)(size ? size : 1);
+
+    unsigned bucket = xc_log2((uint64_t)ratio);
+    if (bucket >= XC_NUM_BUCKETS) bucket = XC_NUM_BUCKETS - 1;
+    xc_set(XC_MEM_BASE, XC_NUM_BUCKETS, bucket);
+    if (mem_worst_op >= 0) {
+        unsigned op_bucket = xc_log2(mem_worst_op_bytes) / 2;   /* 4x steps */
+        if (op_bucket >= XC_MEM_OP_BUCKETS) op_bucket = XC_MEM_OP_BUCKETS - 1;
+        xc_set(XC_MEM_BASE + XC_NUM_BUCKETS, XC_MEM_SIZE - XC_NUM_BUCKETS,
+               (size_t)mem_worst_op * XC_MEM_OP_BUCKETS + op_bucket);
+    }
+
+    if (peak) mem_save_top(ratio, peak, data, size);
+}
+
+#endif
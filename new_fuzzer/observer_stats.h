@@ -0,0 +1,145 @@
+// fuzz/observer_stats.h
+// Drawing-cost breakdown from inside cairo (-DOBSERVER_STATS).
+//
+// The surface choose_backend_surface_B() returns is wrapped in a
+// cairo_surface_create_observer() and the context draws through it. The
+// observer times every paint/mask/fill/stroke/glyphs call it forwards to the
+// real backend; its callbacks read cairo_surface_observer_elapsed() after each
+// one, and the difference is charged to (backend, current op, primitive).
+// No sampling profiler is involved and the numbers only cover time spent in
+// the backend's own dispatch, not argument parsing in the harness.
+//
+// Counts and times are written to $OBSERVER_STATS (default
+// ./observer_stats.txt) every OBS_DUMP_EVERY runs and at exit, next to the
+// normal fuzzing or coverage run.
+#ifndef OBSERVER_STATS_H
+#define OBSERVER_STATS_H
+
+#include "op_registry.h"
+#include <cairo.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define OBS_DUMP_EVERY  10000
+#define OBS_NUM_BACKENDS 5          /* backend_e, PS included */
+#define OBS_SETUP       OP_SLOTS    /* background paint before the first op */
+
+enum { OBS_PAINT, OBS_MASK, OBS_FILL, OBS_STROKE, OBS_GLYPHS, OBS_NUM_PRIMS };
+
+static const char *const obs_prim_names[OBS_NUM_PRIMS] = {
+    "paint", "mask", "fill", "stroke", "glyphs",
+};
+
+static const char *const obs_backend_names[OBS_NUM_BACKENDS] = {
+    "recording", "image", "pdf", "svg", "ps",
+};
+
+typedef struct {
+    uint64_t count;
+    double   ns;
+} obs_stat_t;
+
+static obs_stat_t obs_stats[OBS_NUM_BACKENDS][OP_SLOTS + 1][OBS_NUM_PRIMS];
+static const char *obs_stats_path;
+static uint64_t obs_runs;
+static int obs_backend, obs_op = OBS_SETUP;
+static double obs_last_elapsed;
+
+static void obs_dump(void);
+
+static void obs_record(cairo_surface_t *observer, int prim) {
+    double now = cairo_surface_observer_elapsed(observer);
+    obs_stat_t *s = &obs_stats[obs_backend][obs_op][prim];
+    s->count++;
+    s->ns += now - obs_last_elapsed;
+    obs_last_elapsed = now;
+}
+
+#define OBS_CALLBACK(prim, name) \
+    static void obs_on_##name(cairo_surface_t *observer, cairo_surface_t *target, void *data) { \
+        (void)target; (void)data; obs_record(observer, prim); \
+    }
+OBS_CALLBACK(OBS_PAINT, paint)
+OBS_CALLBACK(OBS_MASK, mask)
+OBS_CALLBACK(OBS_FILL, fill)
+OBS_CALLBACK(OBS_STROKE, stroke)
+OBS_CALLBACK(OBS_GLYPHS, glyphs)
+#undef OBS_CALLBACK
+
+/* Returns the observer to draw on; the caller keeps its own reference to
+ * target and destroys both. Falls back to target itself on failure. */
+static cairo_surface_t *obs_wrap(cairo_surface_t *target, int backend) {
+    if (!obs_stats_path) {
+        obs_stats_path = getenv("OBSERVER_STATS");
+        if (!obs_stats_path) obs_stats_path = "observer_stats.txt";
+        atexit(obs_dump);
+    }
+    obs_backend = backend >= 0 && backend < OBS_NUM_BACKENDS ? backend : 0;
+    obs_op = OBS_SETUP;
+    obs_last_elapsed = 0.0;
+
+    cairo_surface_t *observer = cairo_surface_create_observer(target, CAIRO_SURFACE_OBSERVER_NORMAL);
+    if (cairo_surface_status(observer) != CAIRO_STATUS_SUCCESS) {
+        cairo_surface_destroy(observer);
+        return cairo_surface_reference(target);
+    }
+    cairo_surface_observer_add_paint_callback(observer, obs_on_paint, NULL);
+    cairo_surface_observer_add_mask_callback(observer, obs_on_mask, NULL);
+    cairo_surface_observer_add_fill_callback(observer, obs_on_fill, NULL);
+    cairo_surface_observer_add_stroke_callback(observer, obs_on_stroke, NULL);
+    cairo_surface_observer_add_glyphs_callback(observer, obs_on_glyphs, NULL);
+    return observer;
+}
+
+static inline void obs_op_begin(int op) {
+    obs_op = op;
+}
+
+static void obs_exec_end(void) {
+    obs_op = OBS_SETUP;
+    if (++obs_runs % OBS_DUMP_EVERY == 0) obs_dump();
+}
+
+static void obs_dump(void) {
+    char tmp[512];
+    snprintf(tmp, sizeof(tmp), "%s.tmp", obs_stats_path);
+    FILE *fp = fopen(tmp, "w");
+    if (!fp) return;
+
+    fprintf(fp, "# runs %llu; time is what cairo's observer measured inside the backend\n",
+            (unsigned long long)obs_runs);
+    fprintf(fp, "\n%-10s %-7s %12s %12s %10s\n", "backend", "prim", "calls", "total_ms", "us/call");
+    for (int b = 0; b < OBS_NUM_BACKENDS; b++) {
+        for (int p = 0; p < OBS_NUM_PRIMS; p++) {
+            uint64_t n = 0;
+            double ns = 0.0;
+            for (int op = 0; op <= OP_SLOTS; op++) {
+                n += obs_stats[b][op][p].count;
+                ns += obs_stats[b][op][p].ns;
+            }
+            if (n)
+                fprintf(fp, "%-10s %-7s %12llu %12.3f %10.3f\n", obs_backend_names[b], obs_prim_names[p],
+                        (unsigned long long)n, ns / 1e6, ns / n / 1e3);
+        }
+    }
+
+    fprintf(fp, "\n%-10s %-4s %-20s %-7s %12s %12s %10s\n", "backend", "slot", "op", "prim",
+            "calls", "total_ms", "us/call");
+    for (int b = 0; b < OBS_NUM_BACKENDS; b++) {
+        for (int op = 0; op <= OP_SLOTS; op++) {
+            const char *name = op == OBS_SETUP ? "(setup)" : op_names[op] ? op_names[op] : "-";
+            for (int p = 0; p < OBS_NUM_PRIMS; p++) {
+                const obs_stat_t *s = &obs_stats[b][op][p];
+                if (!s->count) continue;
+                fprintf(fp, "%-10s %-4d %-20s %-7s %12llu %12.3f %10.3f\n", obs_backend_names[b], op,
+                        name, obs_prim_names[p], (unsigned long long)s->count, s->ns / 1e6,
+                        s->ns / s->count / 1e3);
+            }
+        }
+    }
+    fclose(fp);
+    rename(tmp, obs_stats_path);
+}
+
+#endif
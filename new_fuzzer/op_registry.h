@@ -0,0 +1,249 @@
+// fuzz/op_registry.h
+// Tables generated from ops.def: op ids, names, families, cost classes and
+// operand signatures, indexed by opcode slot.
+//
+// Focused targets: build with one of -DFUZZ_FOCUS_PATH, -DFUZZ_FOCUS_TEXT,
+// -DFUZZ_FOCUS_PATTERN or -DFUZZ_FOCUS_CLIP (or a hand-written
+// -DFUZZ_OP_FAMILIES=<mask>) to keep only some families. Ops outside the mask
+// are compiled out of the dispatch switch; their operands are skipped with
+// op_skip_operands() from the ops.def signature, so focused and full targets
+// decode the same bytes the same way and can share corpora
+// (see scripts/fuzz/focused_fuzzers.sh).
+#ifndef OP_REGISTRY_H
+#define OP_REGISTRY_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* input byte % OP_SLOTS is the opcode. The modulus is fixed, so adding or
+ * compiling out an op never renumbers corpus inputs; slots with no op are
+ * no-ops. Legacy `byte % 61` corpora are moved over with corpus_migrate.c. */
+#define OP_SLOTS 128
+
+union op_slot_probe {
+#define OP(slot, name, fam, cost, sig) char name[(slot) + 1];
+#include "ops.def"
+#undef OP
+};
+_Static_assert(sizeof(union op_slot_probe) <= OP_SLOTS, "ops.def slot out of range");
+
+enum {
+    FAM_PATH, FAM_DRAW, FAM_DASH, FAM_CLIP, FAM_TEXT, FAM_PATTERN,
+    FAM_MESH, FAM_GROUP, FAM_REGION, FAM_MASK, FAM_STATE,
+    NUM_OP_FAMILIES
+};
+
+static const char *const op_family_names[NUM_OP_FAMILIES] = {
+    "path", "draw", "dash", "clip", "text", "pattern",
+    "mesh", "group", "region", "mask", "state",
+};
+
+/* rough cost of one op: state change, linear in its operands, rasterizes,
+ * or allocates / loops a lot */
+enum { OPC_CHEAP, OPC_LINEAR, OPC_RENDER, OPC_HEAVY, NUM_OP_COST_CLASSES };
+
+static const char *const op_cost_class_names[NUM_OP_COST_CLASSES] = {
+    "cheap", "linear", "render", "heavy",
+};
+
+#define FAM_BIT(f)  (1u << (f))
+#define FAM_ALL     ((1u << NUM_OP_FAMILIES) - 1)
+
+/* Drawing and state ops stay in every focused target, otherwise the
+ * subsystem under test never gets rendered. */
+#define FAM_BASE    (FAM_BIT(FAM_DRAW) | FAM_BIT(FAM_STATE))
+
+#ifndef FUZZ_OP_FAMILIES
+#  if defined(FUZZ_FOCUS_PATH)
+#    define FUZZ_OP_FAMILIES (FAM_BASE | FAM_BIT(FAM_PATH) | FAM_BIT(FAM_DASH))
+#  elif defined(FUZZ_FOCUS_TEXT)
+#    define FUZZ_OP_FAMILIES (FAM_BASE | FAM_BIT(FAM_TEXT))
+#  elif defined(FUZZ_FOCUS_PATTERN)
+#    define FUZZ_OP_FAMILIES (FAM_BASE | FAM_BIT(FAM_PATTERN) | FAM_BIT(FAM_MESH) | FAM_BIT(FAM_MASK))
+#  elif defined(FUZZ_FOCUS_CLIP)
+#    define FUZZ_OP_FAMILIES (FAM_BASE | FAM_BIT(FAM_CLIP) | FAM_BIT(FAM_REGION) | \
+                              FAM_BIT(FAM_GROUP) | FAM_BIT(FAM_PATH))
+#  else
+#    define FUZZ_OP_FAMILIES FAM_ALL
+#  endif
+#endif
+
+#define OP_FAMILY_ENABLED(f) ((FUZZ_OP_FAMILIES & FAM_BIT(f)) != 0)
+
+enum {
+#define OP(slot, name, fam, cost, sig) OP_##name = slot,
+#include "ops.def"
+#undef OP
+};
+
+/* empty slots have a NULL name */
+static const char *const op_names[OP_SLOTS] = {
+#define OP(slot, name, fam, cost, sig) [slot] = #name,
+#include "ops.def"
+#undef OP
+};
+
+static const char *const op_signatures[OP_SLOTS] = {
+#define OP(slot, name, fam, cost, sig) [slot] = sig,
+#include "ops.def"
+#undef OP
+};
+
+/* empty slots count as FAM_STATE */
+static const uint8_t op_families[OP_SLOTS] = {
+#define OP(slot, name, fam, cost, sig) [slot] = FAM_##fam,
+#include "ops.def"
+#undef OP
+};
+
+static const uint8_t op_cost_classes[OP_SLOTS] = {
+#define OP(slot, name, fam, cost, sig) [slot] = OPC_##cost,
+#include "ops.def"
+#undef OP
+};
+
+static inline uint8_t op_family(int op) {
+    return op_names[op] ? op_families[op] : FAM_STATE;
+}
+
+static inline int op_enabled(int op) {
+    return op_names[op] && OP_FAMILY_ENABLED(op_families[op]);
+}
+
+/* ---------- operand skipping from the signatures ----------
+ * Consumes exactly the bytes op_<name>() would, without running it: every
+ * operand takes its size only if that much input is left, like the pick_*
+ * helpers. See the grammar at the top of ops.def. */
+typedef struct {
+    const uint8_t **in;
+    size_t         *remaining;
+    int64_t         ints[10];   /* the op's ints so far, for $N */
+    int             nints, nimages;
+    int64_t         last;       /* most recent int */
+} op_skip_t;
+
+static inline void op_skip_take(op_skip_t *k, size_t n) {
+    if (*k->remaining < n) return;
+    *k->in += n;
+    *k->remaining -= n;
+}
+
+/* matching ] or ) of the bracket at s, skipping {..} */
+static inline const char *op_sig_close(const char *s) {
+    int depth = 0;
+    for (; *s; s++) {
+        if (*s == '{') { while (*s && *s != '}') s++; continue; }
+        if (*s == '[' || *s == '(') depth++;
+        else if ((*s == ']' || *s == ')') && --depth == 0) return s;
+    }
+    return s;
+}
+
+/* {..} at *s, if any: the count or choice for the bracket that owns it */
+static inline int op_sig_expr(op_skip_t *k, const char **s, int64_t *out) {
+    const char *p = *s;
+    if (*p != '{') return 0;
+    p++;
+    int64_t v = k->last;
+    if (*p == '$') { v = k->ints[p[1] - '0']; p += 2; }
+    else if (*p >= '0' && *p <= '9') { v = strtol(p, (char **)&p, 10); }
+    while (*p && *p != '}') {
+        char o = *p++;
+        int64_t n = strtol(p, (char **)&p, 10);
+        switch (o) {
+        case '%': v = (v < 0 ? -v : v) % (n ? n : 1); break;
+        case '+': v += n; break;
+        case '*': v *= n; break;
+        case '>': v = (int64_t)((uint32_t)v >> n); break;
+        case '&': v &= n; break;
+        case '^': if (v > n) v = n; break;
+        default: break;
+        }
+    }
+    *s = *p ? p + 1 : p;
+    *out = v;
+    return 1;
+}
+
+static inline void op_skip_run(op_skip_t *k, const char *s, const char *end) {
+    while (s < end) {
+        char ch = *s++;
+        switch (ch) {
+        case 'i': {
+            int v = 0;
+            if (*k->remaining >= 4) memcpy(&v, *k->in, 4);
+            op_skip_take(k, 4);
+            k->last = v;
+            if (k->nints < 10) k->ints[k->nints++] = v;
+            break;
+        }
+        case 'd': case 'u': case 'a': case 'k': op_skip_take(k, 8); break;
+        case 'm': for (int j = 0; j < 6; j++) op_skip_take(k, 8); break;
+        case 'b': op_skip_take(k, 1); break;
+        case 's':
+            if (*k->remaining) {
+                size_t len = *k->remaining % 64 + 1;
+                op_skip_take(k, len < *k->remaining ? len : *k->remaining);
+            }
+            break;
+        case 'x': {
+            /* w%256+1, h%256+1, format%3 from the first three ints; the
+             * second image is the half-size similar one */
+            int64_t w = (k->ints[0] < 0 ? -k->ints[0] : k->ints[0]) % 256 + 1;
+            int64_t h = (k->ints[1] < 0 ? -k->ints[1] : k->ints[1]) % 256 + 1;
+            int64_t fmt = (k->ints[2] < 0 ? -k->ints[2] : k->ints[2]) % 3;
+            if (k->nimages++) { w = w > 16 ? w / 2 : w; h = h > 16 ? h / 2 : h; }
+            size_t bytes = (size_t)(fmt == 2 ? (w + 3) & ~3 : w * 4) * (size_t)h;
+            op_skip_take(k, bytes < *k->remaining ? bytes : *k->remaining);
+            break;
+        }
+        case '[': {
+            const char *close = op_sig_close(s - 1);
+            int64_t count = 0;
+            op_sig_expr(k, &s, &count);
+            for (int64_t j = 0; j < count && *k->remaining > 0; j++) op_skip_run(k, s, close);
+            s = close + 1;
+            break;
+        }
+        case '(': {
+            const char *close = op_sig_close(s - 1);
+            int64_t choice = k->last < 0 ? -k->last : k->last;
+            op_sig_expr(k, &s, &choice);
+            int nalts = 1, depth = 0;
+            for (const char *p = s; p < close; p++) {
+                if (*p == '[' || *p == '(') depth++;
+                else if (*p == ']' || *p == ')') depth--;
+                else if (*p == '|' && depth == 0) nalts++;
+            }
+            choice %= nalts;
+            const char *alt = s;
+            depth = 0;
+            for (const char *p = s; p <= close; p++) {
+                if (*p == '[' || *p == '(') depth++;
+                else if ((*p == ']' || *p == ')') && p != close) depth--;
+                else if ((*p == '|' && depth == 0) || p == close) {
+                    if (choice-- == 0) { op_skip_run(k, alt, p); break; }
+                    alt = p + 1;
+                }
+            }
+            s = close + 1;
+            break;
+        }
+        default:
+            break;   /* '@' peeks, never consumes */
+        }
+    }
+}
+
+static inline void op_skip_operands(int op, const uint8_t **in, size_t *remaining) {
+    const char *sig = op_signatures[op];
+    if (!sig) return;
+    op_skip_t k;
+    memset(&k, 0, sizeof(k));
+    k.in = in;
+    k.remaining = remaining;
+    op_skip_run(&k, sig, sig + strlen(sig));
+}
+
+#endif
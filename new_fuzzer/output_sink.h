@@ -0,0 +1,36 @@
+// fuzz/output_sink.h
+// Write callback for the PDF/SVG/PS stream surfaces. Instead of throwing the
+// bytes away it counts them, counts the write calls and keeps a running
+// FNV-1a hash, so benchmarks can see how much a vector backend emits and check
+// that the same input always produces the same document.
+#ifndef OUTPUT_SINK_H
+#define OUTPUT_SINK_H
+
+#include <cairo.h>
+#include <stdint.h>
+
+#define OUTPUT_SINK_HASH_INIT 1469598103934665603ull
+
+typedef struct {
+    uint64_t bytes;
+    uint64_t writes;
+    uint64_t hash;      /* FNV-1a of everything written, independent of chunking */
+} output_sink_t;
+
+static inline void output_sink_reset(output_sink_t *s) {
+    s->bytes = 0;
+    s->writes = 0;
+    s->hash = OUTPUT_SINK_HASH_INIT;
+}
+
+static cairo_status_t output_sink_write(void *closure, const unsigned char *data, unsigned int length) {
+    output_sink_t *s = closure;
+    uint64_t h = s->hash;
+    for (unsigned int i = 0; i < length; i++) { h ^= data[i]; h *= 1099511628211ull; }
+    s->hash = h;
+    s->bytes += length;
+    s->writes++;
+    return CAIRO_STATUS_SUCCESS;
+}
+
+#endif
@@ -0,0 +1,78 @@
+// fuzz/region_gen.h
+// Rectangle-set generators shared by cairo_region_fuzzer.c and
+// bench/region_bench.c. Each one stresses a different part of pixman's banded
+// region code: many rects per band (grid, vertical stripes), one band per rect
+// (staircase), lots of overlap (random) or pieces that coalesce (checker).
+#ifndef REGION_GEN_H
+#define REGION_GEN_H
+
+#include <cairo.h>
+#include <math.h>
+#include <stdint.h>
+
+enum { RGEN_RANDOM, RGEN_GRID, RGEN_STAIRCASE, RGEN_VSTRIPES, RGEN_HSTRIPES, RGEN_CHECKER, NUM_RGEN };
+
+static const char *const rgen_names[NUM_RGEN] = {
+    "random", "grid", "staircase", "vstripes", "hstripes", "checker",
+};
+
+static inline uint32_t rgen_next(uint32_t *s) {
+    uint32_t x = *s ? *s : 0x9e3779b9u;
+    x ^= x << 13; x ^= x >> 17; x ^= x << 5;
+    return *s = x;
+}
+
+/* Fills out[0..n) with kind's rectangles on a cell-sized lattice starting at
+ * (ox, oy); seed only matters for RGEN_RANDOM. */
+static void rgen_fill(cairo_rectangle_int_t *out, int n, int kind, uint32_t seed,
+                      int cell, int ox, int oy) {
+    if (cell < 1) cell = 1;
+    int side = (int)ceil(sqrt((double)n));
+    if (side < 1) side = 1;
+    int span = side * cell;
+    for (int i = 0; i < n; i++) {
+        cairo_rectangle_int_t *r = &out[i];
+        switch (kind) {
+        case RGEN_RANDOM:
+            r->x = (int)(rgen_next(&seed) % (uint32_t)(2 * span));
+            r->y = (int)(rgen_next(&seed) % (uint32_t)(2 * span));
+            r->width = 1 + (int)(rgen_next(&seed) % (uint32_t)(4 * cell));
+            r->height = 1 + (int)(rgen_next(&seed) % (uint32_t)(4 * cell));
+            break;
+        case RGEN_GRID:
+            r->x = (i % side) * cell;
+            r->y = (i / side) * cell;
+            r->width = cell > 1 ? cell - 1 : 1;
+            r->height = cell > 1 ? cell - 1 : 1;
+            break;
+        case RGEN_STAIRCASE:
+            r->x = i * ((cell + 1) / 2);
+            r->y = i * ((cell + 1) / 2);
+            r->width = cell;
+            r->height = cell;
+            break;
+        case RGEN_VSTRIPES:
+            r->x = 2 * i;
+            r->y = 0;
+            r->width = 1;
+            r->height = 2 * n;
+            break;
+        case RGEN_HSTRIPES:
+            r->x = 0;
+            r->y = 2 * i;
+            r->width = 2 * n;
+            r->height = 1;
+            break;
+        default: /* RGEN_CHECKER */
+            r->x = (i % side) * cell;
+            r->y = (i / side) * 2 * cell + ((i % side) & 1) * cell;
+            r->width = cell;
+            r->height = cell;
+            break;
+        }
+        r->x += ox;
+        r->y += oy;
+    }
+}
+
+#endif
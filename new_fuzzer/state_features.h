@@ -0,0 +1,98 @@
+// fuzz/state_features.h
+// Abstract cairo-state feedback for the stateful harness (-DSTATE_FEATURES).
+//
+// Edge coverage can't tell a paint three groups deep inside a clip with a mesh
+// source under HSL_LUMINOSITY from a paint on a fresh context: both run the
+// same code. After every op this mode reads a handful of cheap state values:
+//   group depth, clip depth   (counted by the ops, see op_ctx_t)
+//   operator, source pattern type, antialias, backend
+//   path segments             (log2 bucket of the path a draw op consumes,
+//                              counted once as the op starts; 0 for other ops.
+//                              Counting after every path op would copy the
+//                              growing path each time)
+//   cairo_status(cr)
+// and lights extra counters (extra_counters.h) for each value, a few pairs of
+// them, and a hash of the whole tuple. An input that reaches a new state
+// combination is then a new feature, like a new edge.
+#ifndef STATE_FEATURES_H
+#define STATE_FEATURES_H
+
+#include "extra_counters.h"
+#include "op_registry.h"
+#include <cairo.h>
+
+/* slice layout inside [XC_STATE_BASE, XC_STATE_BASE + XC_STATE_SIZE) */
+#define SF_STATUS      0                         /* cairo_status_t */
+#define SF_OP_SRC      (SF_STATUS + 64)          /* operator x source type */
+#define SF_DEPTHS      (SF_OP_SRC + 32 * 8)      /* group depth x clip depth */
+#define SF_AA_BACKEND  (SF_DEPTHS + 8 * 8)       /* antialias x backend */
+#define SF_PATH_OP     (SF_AA_BACKEND + 8 * 8)   /* path bucket x op family */
+#define SF_COMBO       (SF_PATH_OP + 16 * 16)    /* hash of the whole tuple */
+#define SF_COMBO_SIZE  (XC_STATE_SIZE - SF_COMBO)
+
+static int state_path_bucket;
+
+static inline int state_bucket8(int v) {
+    return v <= 0 ? 0 : v >= 64 ? 7 : 1 + (int)xc_log2((uint64_t)v);
+}
+
+static inline void state_exec_begin(void) {
+    state_path_bucket = 0;
+}
+
+static int state_path_segments(cairo_t *cr) {
+    if (!cairo_has_current_point(cr)) return 0;
+    cairo_path_t *path = cairo_copy_path(cr);
+    int n = 0;
+    if (path->status == CAIRO_STATUS_SUCCESS)
+        for (int i = 0; i < path->num_data; i += path->data[i].header.length) n++;
+    cairo_path_destroy(path);
+    return n;
+}
+
+static inline void state_op_begin(cairo_t *cr, int op) {
+    if (op_family(op) == FAM_DRAW)
+        state_path_bucket = (int)xc_log2((uint64_t)state_path_segments(cr) + 1) & 15;
+}
+
+/* source type, with recording-surface sources split from image ones */
+static int state_source_kind(cairo_t *cr) {
+    cairo_pattern_t *src = cairo_get_source(cr);
+    int kind = (int)cairo_pattern_get_type(src);
+    cairo_surface_t *s;
+    if (kind == CAIRO_PATTERN_TYPE_SURFACE &&
+        cairo_pattern_get_surface(src, &s) == CAIRO_STATUS_SUCCESS &&
+        cairo_surface_get_type(s) == CAIRO_SURFACE_TYPE_RECORDING)
+        kind = 7;
+    return kind & 7;
+}
+
+static void state_op_end(cairo_t *cr, int op, int group_depth, int clip_depth, int backend) {
+    int fam = op_family(op);
+
+    int status = (int)cairo_status(cr);
+    int oper = (int)cairo_get_operator(cr) & 31;
+    int src = state_source_kind(cr);
+    int aa = (int)cairo_get_antialias(cr) & 7;
+    int gd = state_bucket8(group_depth), cd = state_bucket8(clip_depth);
+
+    xc_set(XC_STATE_BASE, XC_STATE_SIZE, SF_STATUS + (status & 63));
+    xc_set(XC_STATE_BASE, XC_STATE_SIZE, SF_OP_SRC + oper * 8 + src);
+    xc_set(XC_STATE_BASE, XC_STATE_SIZE, SF_DEPTHS + gd * 8 + cd);
+    xc_set(XC_STATE_BASE, XC_STATE_SIZE, SF_AA_BACKEND + aa * 8 + (backend & 7));
+    xc_set(XC_STATE_BASE, XC_STATE_SIZE, SF_PATH_OP + state_path_bucket * 16 + (fam & 15));
+
+    uint32_t h = (uint32_t)gd;
+    h = h * 8 + (uint32_t)cd;
+    h = h * 32 + (uint32_t)oper;
+    h = h * 8 + (uint32_t)src;
+    h = h * 8 + (uint32_t)aa;
+    h = h * 8 + (uint32_t)(backend & 7);
+    h = h * 16 + (uint32_t)state_path_bucket;
+    h ^= (uint32_t)status * 0x9e3779b9u;
+    h ^= h >> 15; h *= 0x2c1b3c6du; h ^= h >> 12;
+    xc_set(XC_STATE_BASE, XC_STATE_SIZE, SF_COMBO + h % SF_COMBO_SIZE);
+    state_path_bucket = 0;
+}
+
+#endif
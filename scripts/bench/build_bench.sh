@@ -0,0 +1,58 @@
+#!/bin/sh
+
+# Builds the benchmarks in bench/ against an optimized, non-sanitized cairo.
+# Run from the root of the cairo checkout with the repo's bench/ directory
+# copied (or symlinked) next to fuzz/, same layout as the fuzz scripts.
+#   $OUT/<name>_bench  for every bench/*_bench.c
+# Benchmarks that include bench_hooks.h replay corpus inputs, so they are linked
+# with fuzz/cairo_stateful_fuzzer.c compiled with -DBENCH_BUILD.
+
+export CXX=clang++
+export CC=clang
+export SRC=$PWD
+
+export CFLAGS="-O2 -g -fno-omit-frame-pointer"
+export CXXFLAGS="-O2 -g -fno-omit-frame-pointer"
+
+export WORK=$HOME/cair_bench_work/
+export PREFIX=$HOME/cairo_build_release/ # Same prefix as the threaded bench build
+export OUT=$HOME/cairo_bench/
+mkdir -p $WORK
+mkdir -p $PREFIX
+mkdir -p $OUT
+
+if [ ! -f $PREFIX/lib/pkgconfig/cairo.pc ]; then
+    meson \
+        setup \
+        --prefix=$PREFIX \
+        --libdir=lib \
+        --default-library=static \
+        _builddir_release
+    ninja -C _builddir_release
+    ninja -C _builddir_release install
+fi
+
+export PKG_CONFIG_PATH="$PREFIX/lib/pkgconfig"
+PREDEPS_LDFLAGS="-Wl,-Bdynamic -ldl -lm -lc -pthread -lrt -lpthread"
+DEPS="gmodule-2.0 glib-2.0 gobject-2.0 freetype2 cairo cairo-gobject" # Originally also had gio-2.0
+BUILD_CFLAGS="$CFLAGS `pkg-config --static --cflags $DEPS`"
+BUILD_LDFLAGS="-Wl,-static `pkg-config --static --libs $DEPS`"
+
+$CC $CFLAGS $BUILD_CFLAGS -DBENCH_BUILD -I$SRC/fuzz \
+  -c $SRC/fuzz/cairo_stateful_fuzzer.c -o $WORK/cairo_stateful_fuzzer_bench.o
+
+benches=$(find $SRC/bench/ -name "*_bench.c")
+for f in $benches ; do
+  bench_name=$(basename $f .c)
+  HARNESS_OBJ=""
+  if grep -q '"bench_hooks.h"' $f; then
+    HARNESS_OBJ=$WORK/cairo_stateful_fuzzer_bench.o
+  fi
+  $CC $CFLAGS $BUILD_CFLAGS -I$SRC/bench -I$SRC/fuzz \
+    -c $f -o $WORK/${bench_name}.o
+  $CXX $CXXFLAGS \
+    $WORK/${bench_name}.o $HARNESS_OBJ -o $OUT/${bench_name} \
+    $PREDEPS_LDFLAGS \
+    $BUILD_LDFLAGS \
+    -Wl,-Bdynamic
+done
@@ -0,0 +1,148 @@
+#!/usr/bin/env python3
+"""
+Builds and inspects corpus packs (format described in new_fuzzer/corpus_pack.h).
+
+    pack.py add     NAME.pack DIR_OR_FILE...   append inputs, skipping duplicates
+    pack.py list    NAME.pack                  index, offset, length, hash
+    pack.py extract NAME.pack OUTDIR           write every input back out as a file
+    pack.py verify  NAME.pack                  check bounds and hashes
+
+e.g. pack.py add all_crashes.pack all_crashes/ allcrashes/
+The coverage build and the benchmarks accept NAME.pack wherever they accept a
+corpus directory.
+"""
+import os
+import struct
+import sys
+
+DATA_MAGIC = b"CPACKDAT"
+IDX_MAGIC = b"CPACKIDX"
+VERSION = 1
+HEADER = struct.Struct("<8sII")
+RECORD = struct.Struct("<QQQ")
+
+
+def fnv1a64(data):
+    h = 0xcbf29ce484222325
+    for b in data:
+        h ^= b
+        h = (h * 0x100000001b3) & 0xffffffffffffffff
+    return h
+
+
+def open_or_create(path, magic):
+    if not os.path.exists(path):
+        with open(path, "wb") as f:
+            f.write(HEADER.pack(magic, VERSION, 0))
+    f = open(path, "r+b")
+    m, v, _ = HEADER.unpack(f.read(HEADER.size))
+    if m != magic or v != VERSION:
+        sys.exit(f"[-] {path}: not a version {VERSION} corpus pack")
+    return f
+
+
+def read_index(pack):
+    with open(pack + ".idx", "rb") as f:
+        m, v, _ = HEADER.unpack(f.read(HEADER.size))
+        if m != IDX_MAGIC or v != VERSION:
+            sys.exit(f"[-] {pack}.idx: not a version {VERSION} corpus pack index")
+        raw = f.read()
+    n = len(raw) // RECORD.size
+    return [RECORD.unpack_from(raw, i * RECORD.size) for i in range(n)]
+
+
+def iter_inputs(paths):
+    for p in paths:
+        if os.path.isdir(p):
+            for name in sorted(os.listdir(p)):
+                full = os.path.join(p, name)
+                if not name.startswith(".") and os.path.isfile(full):
+                    yield full
+        elif os.path.isfile(p):
+            yield p
+
+
+def cmd_add(pack, sources):
+    data = open_or_create(pack, DATA_MAGIC)
+    idx = open_or_create(pack + ".idx", IDX_MAGIC)
+    idx.seek(HEADER.size)
+    raw = idx.read()
+    # drop a torn trailing record left by an interrupted append
+    raw = raw[:len(raw) - len(raw) % RECORD.size]
+    known = {RECORD.unpack_from(raw, i)[2] for i in range(0, len(raw), RECORD.size)}
+    idx.seek(HEADER.size + len(raw))
+    idx.truncate()
+
+    data.seek(0, os.SEEK_END)
+    added = dups = 0
+    for path in iter_inputs(sources):
+        with open(path, "rb") as f:
+            buf = f.read()
+        h = fnv1a64(buf)
+        if h in known:
+            dups += 1
+            continue
+        off = data.tell()
+        data.write(buf)
+        data.flush()
+        idx.write(RECORD.pack(off, len(buf), h))
+        known.add(h)
+        added += 1
+    data.close()
+    idx.close()
+    print(f"[+] {pack}: added {added}, skipped {dups} duplicates, {len(known)} inputs total")
+
+
+def cmd_list(pack):
+    for i, (off, length, h) in enumerate(read_index(pack)):
+        print(f"{i:8d} {off:12d} {length:10d} {h:016x}")
+
+
+def cmd_extract(pack, outdir):
+    os.makedirs(outdir, exist_ok=True)
+    with open(pack, "rb") as f:
+        for i, (off, length, h) in enumerate(read_index(pack)):
+            f.seek(off)
+            with open(os.path.join(outdir, f"{i:08d}_{h:016x}"), "wb") as out:
+                out.write(f.read(length))
+
+
+def cmd_verify(pack):
+    size = os.path.getsize(pack)
+    bad = 0
+    entries = read_index(pack)
+    with open(pack, "rb") as f:
+        for i, (off, length, h) in enumerate(entries):
+            if off < HEADER.size or off + length > size:
+                print(f"[-] entry {i}: out of bounds ({off}+{length} > {size})")
+                bad += 1
+                continue
+            f.seek(off)
+            if fnv1a64(f.read(length)) != h:
+                print(f"[-] entry {i}: hash mismatch")
+                bad += 1
+    print(f"[+] {len(entries)} entries, {bad} bad")
+    return 1 if bad else 0
+
+
+def main():
+    if len(sys.argv) < 3 or sys.argv[1] not in ("add", "list", "extract", "verify"):
+        print(__doc__)
+        return 1
+    cmd, pack, rest = sys.argv[1], sys.argv[2], sys.argv[3:]
+    if cmd == "add":
+        cmd_add(pack, rest)
+    elif cmd == "list":
+        cmd_list(pack)
+    elif cmd == "extract":
+        if not rest:
+            print(__doc__)
+            return 1
+        cmd_extract(pack, rest[0])
+    else:
+        return cmd_verify(pack)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,310 @@
+#!/usr/bin/env python3
+"""
+Opcode -> cairo source attribution.
+
+Runs probe inputs and (optionally) a corpus through the coverage build of the
+stateful fuzzer (-fprofile-instr-generate -DCOVERAGE_BUILD, see
+scripts/coverage/build_stuff.sh), one profile per input, in parallel, and
+works out which ops reach which cairo files and functions.
+
+Probes:
+  baseline  backend byte + filler only; whatever these reach (surface setup,
+            cairo_create, ...) is not attributed to any op.
+  single    backend byte, one op, then filler. Filler bytes are opcodes of
+            empty slots (computed from ops.def), so whatever the op doesn't
+            consume as operands runs as no-ops. Every backend x a few fillers:
+            the empty-slot bytes closest to FILLER_TARGETS, which spread what
+            the operands decode to over small, huge, negative and all-ones
+            values.
+  pair      backend byte, op A, filler, op B, filler (image backend, one
+            filler). Ops that eat more operand bytes than the gap swallow B,
+            so pairs are best effort. Pairs don't feed the per-op results;
+            they are reported as the interaction A and B reach together,
+            pair - (single(A) | single(B)).
+  corpus    every input of the given directories / packs. Which ops ran comes
+            from the "Current operation" lines on stderr, and functions no
+            probe explains are credited 1/k to each of the k ops of that input.
+
+Outputs in OUTDIR:
+  op_file_matrix.csv      ops x source files, functions reached (probes)
+  op_file_corpus.csv      same, corpus credit
+  op_function.csv         op, function, file, source, weight
+  op_pair.csv             op A, op B, function, file: pair interaction terms
+  unreached_functions.txt functions in cairo's src/ no probe or input reached
+  file_summary.txt        per file: functions, reached, top ops
+
+  op_attribution.py --bin ~/cairo_fuzzers_coverage/cairo_stateful_fuzzer \\
+                    --ops new_fuzzer/ops.def -o attribution/ [-j 16] [corpus...]
+"""
+import argparse
+import collections
+import concurrent.futures
+import csv
+import json
+import os
+import re
+import shutil
+import subprocess
+import sys
+import tempfile
+
+TIMEOUT = 20.0
+OP_SLOTS = 128   # op_registry.h
+FILLER_TARGETS = [0x40, 0x7f, 0xc0, 0xff]
+FILLER_LEN = 512
+PAIR_GAP = 192
+BACKENDS = ["recording", "image", "pdf", "svg"]
+OP_RE = re.compile(r"^Current operation: (\d+)", re.M)
+
+
+def parse_ops(path):
+    ops = {}
+    for line in open(path):
+        m = re.match(r'\s*OP\(\s*(\d+),\s*(\w+),\s*(\w+),', line)
+        if m:
+            ops[int(m.group(1))] = (m.group(2), m.group(3).lower())
+    return ops
+
+
+def make_probes(ops, pairs, outdir):
+    """Writes probe files, returns [(path, kind, [slots])]."""
+    slots = sorted(ops)
+    empty = [b for b in range(256) if b % OP_SLOTS not in ops]
+    fillers = sorted({min(empty, key=lambda b: abs(b - t)) for t in FILLER_TARGETS})
+    probes = []
+    os.makedirs(outdir, exist_ok=True)
+
+    def write(name, data, kind, used):
+        p = os.path.join(outdir, name)
+        with open(p, "wb") as f:
+            f.write(bytes(data))
+        probes.append((p, kind, used))
+
+    for be in range(len(BACKENDS)):
+        for fill in fillers:
+            write(f"baseline_{BACKENDS[be]}_{fill:02x}", [be] + [fill] * FILLER_LEN, "baseline", [])
+    for op in slots:
+        for be in range(len(BACKENDS)):
+            for fill in fillers:
+                write(f"single_{op:03d}_{BACKENDS[be]}_{fill:02x}",
+                      [be, op] + [fill] * FILLER_LEN, "single", [op])
+    if pairs:
+        fill = fillers[0]
+        for a in slots:
+            for b in slots:
+                write(f"pair_{a:03d}_{b:03d}",
+                      [1, a] + [fill] * PAIR_GAP + [b] + [fill] * FILLER_LEN, "pair", [a, b])
+    return probes
+
+
+def corpus_inputs(paths, outdir):
+    """Corpus files; packs are extracted with pack.py first."""
+    pack_tool = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "corpus_pack", "pack.py")
+    files = []
+    for p in paths:
+        if os.path.isfile(p) and open(p, "rb").read(8) == b"CPACKDAT":
+            d = os.path.join(outdir, "unpacked_" + os.path.basename(p))
+            subprocess.run([sys.executable, pack_tool, "extract", p, d], check=True)
+            p = d
+        if os.path.isdir(p):
+            files += [os.path.join(p, n) for n in sorted(os.listdir(p))
+                      if not n.startswith(".") and os.path.isfile(os.path.join(p, n))]
+        elif os.path.isfile(p):
+            files.append(p)
+    return files
+
+
+def reached_functions(profraw, profdata_tool):
+    """Function names with a non-zero entry count in one profile."""
+    out = subprocess.run([profdata_tool, "show", "--all-functions", profraw],
+                         stdout=subprocess.PIPE, stderr=subprocess.DEVNULL, text=True).stdout
+    reached = set()
+    name = None
+    for line in out.split("\n"):
+        m = re.match(r"^  (\S.*):$", line)
+        if m:
+            name = m.group(1)
+            continue
+        m = re.match(r"^\s+Function count: (\d+)", line)
+        if m and name is not None:
+            if int(m.group(1)) > 0:
+                reached.add(name)
+            name = None
+    return reached
+
+
+def run_one(binary, path, profdata_tool, workdir, keep=None):
+    with tempfile.TemporaryDirectory(dir=workdir) as cwd:
+        os.mkdir(os.path.join(cwd, "cairo_out"))
+        env = dict(os.environ, LLVM_PROFILE_FILE=os.path.join(cwd, "run.profraw"))
+        try:
+            r = subprocess.run([binary, path], cwd=cwd, env=env, stdout=subprocess.DEVNULL,
+                               stderr=subprocess.PIPE, timeout=TIMEOUT)
+            err = r.stderr.decode(errors="replace")
+        except subprocess.TimeoutExpired:
+            return set(), []
+        ran = sorted({int(x) for x in OP_RE.findall(err)})
+        prof = os.path.join(cwd, "run.profraw")
+        if not os.path.exists(prof):
+            return set(), ran
+        if keep and not os.path.exists(keep):
+            shutil.copy(prof, keep)
+        return reached_functions(prof, profdata_tool), ran
+
+
+def function_files(binary, profdata_tool, cov_tool, profraw, workdir):
+    """Maps profile function names to source files via llvm-cov export. Any
+    one profile of the binary lists every instrumented function."""
+    merged = os.path.join(workdir, "all.profdata")
+    subprocess.run([profdata_tool, "merge", "-sparse", "-o", merged, profraw], check=True)
+    out = subprocess.run([cov_tool, "export", "-skip-expansions", "-instr-profile=" + merged, binary],
+                         stdout=subprocess.PIPE, check=True).stdout
+    mapping = {}
+    for data in json.loads(out)["data"]:
+        for fn in data.get("functions", []):
+            if fn.get("filenames"):
+                mapping[fn["name"]] = fn["filenames"][0]
+    return mapping
+
+
+def short(path):
+    return path.split("/src/", 1)[1] if "/src/" in path else os.path.basename(path)
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("--bin", required=True, help="coverage build of cairo_stateful_fuzzer")
+    ap.add_argument("--ops", required=True, help="path to new_fuzzer/ops.def")
+    ap.add_argument("-o", "--out", default="attribution")
+    ap.add_argument("-j", "--jobs", type=int, default=os.cpu_count())
+    ap.add_argument("--no-pairs", action="store_true", help="skip the op-pair probes")
+    ap.add_argument("--llvm-profdata", default="llvm-profdata")
+    ap.add_argument("--llvm-cov", default="llvm-cov")
+    ap.add_argument("corpus", nargs="*", help="corpus directories, files or packs")
+    args = ap.parse_args()
+
+    binary = os.path.abspath(args.bin)
+    ops = parse_ops(args.ops)
+    args.out = os.path.abspath(args.out)
+    os.makedirs(args.out, exist_ok=True)
+    work = tempfile.mkdtemp(prefix="attr_", dir=args.out)
+    probes = make_probes(ops, not args.no_pairs, os.path.join(work, "probes"))
+    jobs = [(p, k, used) for p, k, used in probes]
+    jobs += [(os.path.abspath(p), "corpus", None) for p in corpus_inputs(args.corpus, work)]
+    print(f"[+] {len(ops)} ops, {len(probes)} probes, {len(jobs) - len(probes)} corpus inputs, {args.jobs} jobs")
+
+    # one raw profile is kept to map function names to files
+    keep = os.path.join(work, "map.profraw")
+    results = []
+    with concurrent.futures.ThreadPoolExecutor(args.jobs) as ex:
+        futs = {ex.submit(run_one, binary, p, args.llvm_profdata, work, keep): (p, k, used)
+                for p, k, used in jobs}
+        for n, fut in enumerate(concurrent.futures.as_completed(futs), 1):
+            p, kind, used = futs[fut]
+            reached, ran = fut.result()
+            results.append((kind, used if used is not None else ran, reached))
+            if n % 500 == 0:
+                print(f"    {n}/{len(jobs)}", flush=True)
+
+    if not os.path.exists(keep):
+        sys.exit("[-] no run produced a profile; is --bin a -fprofile-instr-generate build?")
+    fmap = function_files(binary, args.llvm_profdata, args.llvm_cov, keep, work)
+
+    def file_of(fn):
+        if fn in fmap:
+            return fmap[fn]
+        # local functions are "file.c;func" (or "file.c:func" on older LLVM)
+        m = re.match(r"(.+?)[;:]([^;:]+)$", fn)
+        return m.group(1) if m else "?"
+
+    all_cairo = {fn for fn, f in fmap.items() if "/src/" in f}
+    by_op = collections.defaultdict(set)           # single-op probes
+    by_pair = {}                                    # (a, b) -> interaction
+    corpus_credit = collections.defaultdict(float)  # (op, fn) -> weight
+    probe_reached = set()
+    corpus_reached = set()
+    baseline = set()
+    for kind, used, reached in results:
+        if kind == "baseline":
+            baseline |= reached
+    for kind, used, reached in results:
+        if kind != "corpus":
+            probe_reached |= reached
+        if kind == "single":
+            by_op[used[0]] |= reached - baseline
+    for kind, used, reached in results:
+        if kind == "pair":
+            a, b = used
+            extra = reached - baseline - by_op[a] - by_op[b]
+            if extra:
+                by_pair[(a, b)] = extra
+    for kind, used, reached in results:
+        if kind != "corpus":
+            continue
+        corpus_reached |= reached
+        extra = reached - probe_reached
+        if not used or not extra:
+            continue
+        for fn in extra:
+            for op in used:
+                corpus_credit[(op, fn)] += 1.0 / len(used)
+
+    files = sorted({short(file_of(fn)) for fn in all_cairo})
+    with open(os.path.join(args.out, "op_file_matrix.csv"), "w", newline="") as f:
+        w = csv.writer(f)
+        w.writerow(["op", "name"] + files)
+        for op in sorted(ops):
+            cnt = collections.Counter(short(file_of(fn)) for fn in by_op[op] if fn in all_cairo)
+            w.writerow([op, ops[op][0]] + [cnt.get(x, 0) for x in files])
+    with open(os.path.join(args.out, "op_file_corpus.csv"), "w", newline="") as f:
+        w = csv.writer(f)
+        w.writerow(["op", "name"] + files)
+        per = collections.defaultdict(collections.Counter)
+        for (op, fn), wt in corpus_credit.items():
+            if fn in all_cairo:
+                per[op][short(file_of(fn))] += wt
+        for op in sorted(ops):
+            w.writerow([op, ops[op][0]] + ["%.2f" % per[op].get(x, 0) for x in files])
+    with open(os.path.join(args.out, "op_function.csv"), "w", newline="") as f:
+        w = csv.writer(f)
+        w.writerow(["op", "name", "function", "file", "source", "weight"])
+        for op in sorted(ops):
+            for fn in sorted(by_op[op] & all_cairo):
+                w.writerow([op, ops[op][0], fn, short(file_of(fn)), "probe", 1])
+        for (op, fn), wt in sorted(corpus_credit.items()):
+            if fn in all_cairo and op in ops:
+                w.writerow([op, ops[op][0], fn, short(file_of(fn)), "corpus", "%.3f" % wt])
+
+    with open(os.path.join(args.out, "op_pair.csv"), "w", newline="") as f:
+        w = csv.writer(f)
+        w.writerow(["op_a", "name_a", "op_b", "name_b", "function", "file"])
+        for (a, b), extra in sorted(by_pair.items()):
+            for fn in sorted(extra & all_cairo):
+                w.writerow([a, ops[a][0], b, ops[b][0], fn, short(file_of(fn))])
+
+    reached_any = probe_reached | corpus_reached
+    unreached = collections.defaultdict(list)
+    for fn in sorted(all_cairo - reached_any):
+        unreached[short(file_of(fn))].append(fn)
+    totals = collections.Counter(short(file_of(fn)) for fn in all_cairo)
+    with open(os.path.join(args.out, "unreached_functions.txt"), "w") as f:
+        for file in sorted(unreached, key=lambda x: -len(unreached[x])):
+            f.write(f"{file}  ({len(unreached[file])}/{totals[file]} unreached)\n")
+            for fn in unreached[file]:
+                f.write(f"    {fn}\n")
+
+    with open(os.path.join(args.out, "file_summary.txt"), "w") as f:
+        f.write(f"{'file':44s} {'funcs':>5s} {'reached':>7s}  top ops (functions reached)\n")
+        for file in files:
+            fns = {fn for fn in all_cairo if short(file_of(fn)) == file}
+            top = sorted(((len(by_op[op] & fns), op) for op in ops), reverse=True)[:3]
+            top_s = ", ".join(f"{ops[op][0]}({n})" for n, op in top if n)
+            f.write(f"{file:44s} {len(fns):5d} {len(fns & reached_any):7d}  {top_s or '-'}\n")
+
+    shutil.rmtree(work, ignore_errors=True)
+    print(f"[+] {len(reached_any & all_cairo)}/{len(all_cairo)} cairo functions reached; results in {args.out}/")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
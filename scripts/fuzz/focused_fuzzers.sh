@@ -0,0 +1,52 @@
+#!/bin/sh
+
+# Builds focused variants of the stateful fuzzer, each compiled with only some
+# op families of fuzz/ops.def (see fuzz/op_registry.h):
+#   $OUT/cairo_path_fuzzer      path + dash ops
+#   $OUT/cairo_text_fuzzer      text / font ops
+#   $OUT/cairo_pattern_fuzzer   pattern, mesh and mask ops
+#   $OUT/cairo_clip_fuzzer      clip, region, group and path ops
+# Draw and state ops are in all of them. They read the same corpus format as
+# cairo_stateful_fuzzer: an op from a compiled-out family does nothing but
+# skip its operands (by its ops.def signature), so every later op decodes the
+# same and the corpora can be shared both ways. Uses the same installed cairo
+# as only_fuzzer.sh.
+
+export CXX=clang++
+export CC=clang
+
+export WORK=$HOME/cair_fuzzers_work/
+export PREFIX=$HOME/cairo_build   # <-- this is where 'make install' put files
+
+# Tell pkg-config to use OUR cairo .pc files
+export PKG_CONFIG_PATH="$PREFIX/lib/pkgconfig"
+
+export CFLAGS="-fsanitize=undefined,address,fuzzer-no-link -O3 -g -I$PREFIX/include"
+export CXXFLAGS="-fsanitize=undefined,address,fuzzer-no-link -O3 -g -I$PREFIX/include"
+export LDFLAGS="-L$PREFIX/lib"
+export LD_LIBRARY_PATH="$PREFIX/lib"
+
+export LIB_FUZZING_ENGINE="-fsanitize=address,undefined,fuzzer"
+
+export SRC=$PWD
+export OUT=$HOME/cairo_fuzzers/
+mkdir -p $WORK
+mkdir -p $OUT
+
+PREDEPS_LDFLAGS="-Wl,-Bdynamic -ldl -lm -lc -pthread -lrt -lpthread"
+DEPS="gmodule-2.0 glib-2.0 gobject-2.0 freetype2 cairo cairo-gobject" # Originally also had gio-2.0
+BUILD_CFLAGS="$CFLAGS `pkg-config --static --cflags $DEPS`"
+BUILD_LDFLAGS="-Wl,-static `pkg-config --static --libs $DEPS`"
+
+f=$SRC/fuzz/cairo_stateful_fuzzer.c
+for focus in PATH TEXT PATTERN CLIP ; do
+  name=cairo_$(echo $focus | tr 'A-Z' 'a-z')_fuzzer
+  $CC $CFLAGS $BUILD_CFLAGS -DFUZZ_FOCUS_$focus \
+    -c $f -o $WORK/${name}.o
+  $CXX $CXXFLAGS \
+    $WORK/${name}.o -o $OUT/${name} \
+    $PREDEPS_LDFLAGS \
+    $BUILD_LDFLAGS \
+    $LIB_FUZZING_ENGINE \
+    -Wl,-Bdynamic
+done
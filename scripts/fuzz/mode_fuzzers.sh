@@ -0,0 +1,66 @@
+#!/bin/sh
+
+# Builds the stateful fuzzer once per instrumentation mode. Each argument is
+# DEFINE:name and gives $OUT/cairo_<name>_fuzzer compiled with -DDEFINE; with no
+# arguments every mode below is built:
+#   COST_FEEDBACK:cost           performance bugs (fuzz/cost_feedback.h)
+#     COST_TOP_DIR=cost_top $OUT/cairo_cost_fuzzer -timeout=60 -rss_limit_mb=4096 corpus/
+#     perf_event_open needs kernel.perf_event_paranoid <= 2 (or CAP_PERFMON);
+#     otherwise the mode falls back to wall-clock ns.
+#   MEM_AMPLIFICATION:mem        memory amplification (fuzz/mem_amplification.h)
+#     MEM_TOP_DIR=mem_top $OUT/cairo_mem_fuzzer -rss_limit_mb=8192 -malloc_limit_mb=4096 corpus/
+#   ADAPTIVE_OPS:adaptive        adaptive op scheduling (fuzz/adaptive_ops.h)
+#     ADAPT_STATS=adaptive_stats.txt $OUT/cairo_adaptive_fuzzer corpus/
+#   OBSERVER_STATS:observer      cairo observer counts/times (fuzz/observer_stats.h)
+#     OBSERVER_STATS=observer_stats.txt $OUT/cairo_observer_fuzzer corpus/
+#   FONT_CACHE_STATS:font_cache  font/glyph cache accounting (fuzz/font_cache_stats.h)
+#     FONT_CACHE_STATS=font_cache_stats.txt $OUT/cairo_font_cache_fuzzer corpus/
+#   STATE_FEATURES:state         cairo-state feedback (fuzz/state_features.h)
+# e.g. "scripts/fuzz/mode_fuzzers.sh MEM_AMPLIFICATION:mem" builds just one.
+# Uses the same installed cairo as only_fuzzer.sh.
+
+MODES="$*"
+if [ -z "$MODES" ]; then
+  MODES="COST_FEEDBACK:cost MEM_AMPLIFICATION:mem ADAPTIVE_OPS:adaptive
+         OBSERVER_STATS:observer FONT_CACHE_STATS:font_cache STATE_FEATURES:state"
+fi
+
+export CXX=clang++
+export CC=clang
+
+export WORK=$HOME/cair_fuzzers_work/
+export PREFIX=$HOME/cairo_build   # <-- this is where 'make install' put files
+
+# Tell pkg-config to use OUR cairo .pc files
+export PKG_CONFIG_PATH="$PREFIX/lib/pkgconfig"
+
+export CFLAGS="-fsanitize=undefined,address,fuzzer-no-link -O3 -g -I$PREFIX/include"
+export CXXFLAGS="-fsanitize=undefined,address,fuzzer-no-link -O3 -g -I$PREFIX/include"
+export LDFLAGS="-L$PREFIX/lib"
+export LD_LIBRARY_PATH="$PREFIX/lib"
+
+export LIB_FUZZING_ENGINE="-fsanitize=address,undefined,fuzzer"
+
+export SRC=$PWD
+export OUT=$HOME/cairo_fuzzers/
+mkdir -p $WORK
+mkdir -p $OUT
+
+PREDEPS_LDFLAGS="-Wl,-Bdynamic -ldl -lm -lc -pthread -lrt -lpthread"
+DEPS="gmodule-2.0 glib-2.0 gobject-2.0 freetype2 cairo cairo-gobject" # Originally also had gio-2.0
+BUILD_CFLAGS="$CFLAGS `pkg-config --static --cflags $DEPS`"
+BUILD_LDFLAGS="-Wl,-static `pkg-config --static --libs $DEPS`"
+
+f=$SRC/fuzz/cairo_stateful_fuzzer.c
+for mode in $MODES ; do
+  define=${mode%%:*}
+  name=cairo_${mode#*:}_fuzzer
+  $CC $CFLAGS $BUILD_CFLAGS -D$define \
+    -c $f -o $WORK/${name}.o
+  $CXX $CXXFLAGS \
+    $WORK/${name}.o -o $OUT/${name} \
+    $PREDEPS_LDFLAGS \
+    $BUILD_LDFLAGS \
+    $LIB_FUZZING_ENGINE \
+    -Wl,-Bdynamic
+done
@@ -0,0 +1,71 @@
+#!/bin/sh
+
+# Builds fuzz/cairo_threaded_fuzzer.c in two flavours:
+#   $OUT/cairo_threaded_fuzzer_tsan  - libFuzzer + ThreadSanitizer (cairo itself is
+#                                      rebuilt with TSan, otherwise races inside
+#                                      cairo's caches go unnoticed)
+#   $OUT/cairo_threaded_bench        - plain -O2 build with -DTHREAD_BENCH, run as
+#                                      ./cairo_threaded_bench <corpus_dir> [max_threads] [reps]
+# Run from the root of the cairo checkout, same as b_fuzz.sh.
+
+export CXX=clang++
+export CC=clang
+export SRC=$PWD
+
+export WORK=$HOME/cair_fuzzers_work/
+export OUT=$HOME/cairo_fuzzers/
+mkdir -p $WORK
+mkdir -p $OUT
+
+PREDEPS_LDFLAGS="-Wl,-Bdynamic -ldl -lm -lc -pthread -lrt -lpthread"
+DEPS="gmodule-2.0 glib-2.0 gobject-2.0 freetype2 cairo cairo-gobject" # Originally also had gio-2.0
+
+build_cairo() {
+    # $1 = install prefix, $2 = build dir, rest of the environment decides the flags
+    mkdir -p $1
+    meson \
+        setup \
+        --prefix=$1 \
+        --libdir=lib \
+        --default-library=static \
+        $2
+    ninja -C $2
+    ninja -C $2 install
+}
+
+f=$SRC/fuzz/cairo_threaded_fuzzer.c
+
+# ---- TSan flavour ----
+export PREFIX=$HOME/cairo_build_tsan/
+export CFLAGS="-fsanitize=thread,fuzzer-no-link -O1 -g"
+export CXXFLAGS="-fsanitize=thread,fuzzer-no-link -O1 -g"
+build_cairo $PREFIX _builddir_tsan
+
+export PKG_CONFIG_PATH="$PREFIX/lib/pkgconfig"
+BUILD_CFLAGS="$CFLAGS `pkg-config --static --cflags $DEPS`"
+BUILD_LDFLAGS="-Wl,-static `pkg-config --static --libs $DEPS`"
+$CC $CFLAGS $BUILD_CFLAGS \
+    -c $f -o $WORK/cairo_threaded_fuzzer_tsan.o
+$CXX $CXXFLAGS \
+    $WORK/cairo_threaded_fuzzer_tsan.o -o $OUT/cairo_threaded_fuzzer_tsan \
+    $PREDEPS_LDFLAGS \
+    $BUILD_LDFLAGS \
+    -fsanitize=thread,fuzzer \
+    -Wl,-Bdynamic
+
+# ---- throughput flavour ----
+export PREFIX=$HOME/cairo_build_release/
+export CFLAGS="-O2 -g"
+export CXXFLAGS="-O2 -g"
+build_cairo $PREFIX _builddir_release
+
+export PKG_CONFIG_PATH="$PREFIX/lib/pkgconfig"
+BUILD_CFLAGS="$CFLAGS `pkg-config --static --cflags $DEPS`"
+BUILD_LDFLAGS="-Wl,-static `pkg-config --static --libs $DEPS`"
+$CC $CFLAGS $BUILD_CFLAGS -DTHREAD_BENCH \
+    -c $f -o $WORK/cairo_threaded_bench.o
+$CXX $CXXFLAGS \
+    $WORK/cairo_threaded_bench.o -o $OUT/cairo_threaded_bench \
+    $PREDEPS_LDFLAGS \
+    $BUILD_LDFLAGS \
+    -Wl,-Bdynamic
@@ -0,0 +1,74 @@
+#!/bin/sh
+
+# Builds every fuzz/*_fuzzer.c twice, for the two-tier pipeline
+# (scripts/pipeline/run_two_tier.sh):
+#   $OUT/<name>_fast  - coverage instrumentation only (-fsanitize=fuzzer-no-link
+#                       -O2, cairo rebuilt the same way). This is the one that
+#                       explores; it runs 2-3x faster than the ASan build.
+#   $OUT/<name>       - the usual ASan+UBSan build, same as only_fuzzer.sh. It
+#                       never fuzzes, scripts/pipeline/confirm_daemon.py replays
+#                       new corpus entries and the fast build's artifacts on it.
+# Run from the root of the cairo checkout, same as b_fuzz.sh.
+
+export CXX=clang++
+export CC=clang
+export SRC=$PWD
+
+export WORK=$HOME/cair_fuzzers_work/
+export OUT=$HOME/cairo_fuzzers/
+mkdir -p $WORK
+mkdir -p $OUT
+
+PREDEPS_LDFLAGS="-Wl,-Bdynamic -ldl -lm -lc -pthread -lrt -lpthread"
+DEPS="gmodule-2.0 glib-2.0 gobject-2.0 freetype2 cairo cairo-gobject" # Originally also had gio-2.0
+
+build_cairo() {
+    # $1 = install prefix, $2 = build dir, rest of the environment decides the flags
+    # each tier keeps its own build dir; a second run reconfigures it instead
+    # of failing on an already configured directory
+    mkdir -p $1
+    RECONFIGURE=""
+    if [ -f $2/build.ninja ]; then RECONFIGURE="--reconfigure"; fi
+    meson \
+        setup $RECONFIGURE \
+        --prefix=$1 \
+        --libdir=lib \
+        --default-library=static \
+        $2
+    ninja -C $2
+    ninja -C $2 install
+}
+
+build_fuzzers() {
+    # $1 = binary suffix, $2 = libFuzzer link flags
+    BUILD_CFLAGS="$CFLAGS `pkg-config --static --cflags $DEPS`"
+    BUILD_LDFLAGS="-Wl,-static `pkg-config --static --libs $DEPS`"
+    fuzzers=$(find $SRC/fuzz/ -name "*_fuzzer.c")
+    for f in $fuzzers ; do
+      fuzzer_name=$(basename $f .c)$1
+      $CC $CFLAGS $BUILD_CFLAGS \
+        -c $f -o $WORK/${fuzzer_name}.o
+      $CXX $CXXFLAGS \
+        $WORK/${fuzzer_name}.o -o $OUT/${fuzzer_name} \
+        $PREDEPS_LDFLAGS \
+        $BUILD_LDFLAGS \
+        $2 \
+        -Wl,-Bdynamic
+    done
+}
+
+# ---- fast tier: coverage only ----
+export PREFIX=$HOME/cairo_build_fast/
+export CFLAGS="-fsanitize=fuzzer-no-link -O2 -g -I$PREFIX/include"
+export CXXFLAGS="-fsanitize=fuzzer-no-link -O2 -g -I$PREFIX/include"
+build_cairo $PREFIX _builddir_fast
+export PKG_CONFIG_PATH="$PREFIX/lib/pkgconfig"
+build_fuzzers _fast "-fsanitize=fuzzer"
+
+# ---- confirmation tier: ASan + UBSan ----
+export PREFIX=$HOME/cairo_build/
+export CFLAGS="-fsanitize=undefined,address,fuzzer-no-link -O3 -g -I$PREFIX/include"
+export CXXFLAGS="-fsanitize=undefined,address,fuzzer-no-link -O3 -g -I$PREFIX/include"
+build_cairo $PREFIX _builddir
+export PKG_CONFIG_PATH="$PREFIX/lib/pkgconfig"
+build_fuzzers "" "-fsanitize=address,undefined,fuzzer"
@@ -0,0 +1,260 @@
+#!/usr/bin/env python3
+"""
+Confirmation tier of the two-tier pipeline. The fast (coverage-only) fuzzers
+explore; this daemon replays on the ASan+UBSan build everything they produce:
+
+  * every new file in the corpus directories (new coverage is exactly where a
+    memory bug the fast build can't see is most likely),
+  * every artifact the fast fuzzers save with -artifact_prefix: crash-*,
+    timeout-*, oom-*, slow-unit-* and leak-*.
+
+Inputs are replayed in batches of --batch on one sanitized process. A clean
+batch costs one process start; a failing one is split and replayed one input
+at a time to find the culprit(s).
+
+Failures are deduplicated by signature (sanitizer error kind plus the top
+--frames frames that are not sanitizer or libFuzzer runtime) into one crash
+store shared by all fast fuzzers:
+
+    STORE/<sig>/report.txt       sanitizer output of the first reproducer
+    STORE/<sig>/meta.json        kind, frames, hit count, where each input came from
+    STORE/<sig>/<sha1>           reproducers, content-named
+    STORE/unconfirmed/<sha1>     fast-tier artifacts the sanitized build ran cleanly
+    STORE/index.json             one line per signature, for humans and scripts
+
+Which inputs were already handled is appended to STORE/.confirm_done (one
+"<sha1> <path>" line per input, written after every batch), so the daemon can
+be restarted at any time.
+"""
+import argparse
+import hashlib
+import json
+import os
+import re
+import shutil
+import subprocess
+import sys
+import time
+
+ARTIFACT_PREFIXES = ("crash-", "timeout-", "oom-", "slow-unit-", "leak-")
+
+ERROR_RE = re.compile(r"ERROR: (AddressSanitizer|LeakSanitizer|libFuzzer|UndefinedBehaviorSanitizer): ([\w-]+)")
+UBSAN_RE = re.compile(r"^(\S+?):\d+:\d+: runtime error: (.*)$", re.M)
+FRAME_RE = re.compile(r"^\s*#\d+ 0x[0-9a-f]+ in (\S+)", re.M)
+RUNTIME_FRAME = re.compile(r"^(__asan|__lsan|__ubsan|__sanitizer|__interceptor|fuzzer::|LLVMFuzzerTestOneInput$|"
+                           r"malloc$|calloc$|realloc$|free$|memcpy$|memmove$|memset$|strlen$|abort$|raise$)")
+
+
+def sha1_file(path):
+    h = hashlib.sha1()
+    with open(path, "rb") as f:
+        for chunk in iter(lambda: f.read(1 << 20), b""):
+            h.update(chunk)
+    return h.hexdigest()
+
+
+def load_done(path):
+    """"<dir>/<name>" -> sha1 of every input already replayed."""
+    done = {}
+    try:
+        with open(path) as f:
+            for line in f:
+                digest, _, done_key = line.rstrip("\n").partition(" ")
+                if done_key:        # a line cut short by a kill is redone
+                    done[done_key] = digest
+    except OSError:
+        pass
+    return done
+
+
+def save_json(path, obj):
+    tmp = path + ".tmp"
+    with open(tmp, "w") as f:
+        json.dump(obj, f, indent=1, sort_keys=True)
+    os.rename(tmp, path)
+
+
+def signature(output, nframes):
+    """(kind, frames) of the first sanitizer/libFuzzer report in output, or None."""
+    m = ERROR_RE.search(output)
+    u = UBSAN_RE.search(output)
+    if m and (not u or m.start() < u.start()):
+        kind = m.group(2)
+        tail = output[m.end():]
+    elif u:
+        # first words of the message, without the values: "signed integer overflow"
+        kind = "ubsan:" + re.sub(r"[^a-z ]", "", u.group(2).split(":")[0]).strip().replace(" ", "-")[:48]
+        tail = output[u.end():]
+    else:
+        return None
+    frames = [f for f in FRAME_RE.findall(tail) if not RUNTIME_FRAME.match(f)]
+    if not frames and u:
+        frames = [u.group(1)]   # no stack trace, fall back to the file
+    return kind, frames[:nframes]
+
+
+def replay(args, paths):
+    """Runs the sanitized fuzzer over paths; returns (exit code, output)."""
+    env = dict(os.environ)
+    env.setdefault("ASAN_OPTIONS", "detect_leaks=1:abort_on_error=0:symbolize=1")
+    env.setdefault("UBSAN_OPTIONS", "halt_on_error=1:print_stacktrace=1")
+    cmd = [args.sanitized, "-timeout=%d" % args.timeout, "-rss_limit_mb=%d" % args.rss_limit_mb] + paths
+    try:
+        p = subprocess.run(cmd, stdout=subprocess.DEVNULL, stderr=subprocess.PIPE, env=env,
+                           timeout=args.timeout * (len(paths) + 2))
+        return p.returncode, p.stderr.decode(errors="replace")
+    except subprocess.TimeoutExpired as e:
+        out = e.stderr.decode(errors="replace") if e.stderr else ""
+        return -1, out + "\nERROR: libFuzzer: timeout (killed by confirm_daemon)\n"
+
+
+def store_failure(args, index, path, digest, origin, output, sig):
+    kind, frames = sig
+    key = hashlib.sha1(("%s|%s" % (kind, "|".join(frames))).encode()).hexdigest()[:16]
+    d = os.path.join(args.store, key)
+    new = not os.path.isdir(d)
+    os.makedirs(d, exist_ok=True)
+    meta_path = os.path.join(d, "meta.json")
+    try:
+        with open(meta_path) as f:
+            meta = json.load(f)
+    except (OSError, ValueError):
+        meta = {"kind": kind, "frames": frames, "first_seen": time.strftime("%Y-%m-%d %H:%M:%S"),
+                "hits": 0, "inputs": {}}
+        with open(os.path.join(d, "report.txt"), "w") as f:
+            f.write(output)
+    meta["hits"] += 1
+    if digest not in meta["inputs"] and len(meta["inputs"]) < args.keep_per_sig:
+        shutil.copyfile(path, os.path.join(d, digest))
+        meta["inputs"][digest] = origin
+    save_json(meta_path, meta)
+    index[key] = {"kind": kind, "top": frames[0] if frames else "?", "hits": meta["hits"]}
+    return key, new
+
+
+def mark_unconfirmed(args, path, digest):
+    """A fast-tier artifact the sanitized build ran cleanly (flaky, or a
+    timeout/oom that only happens at the fast build's speed)."""
+    d = os.path.join(args.store, "unconfirmed")
+    os.makedirs(d, exist_ok=True)
+    dst = os.path.join(d, digest)
+    if not os.path.exists(dst):
+        shutil.copyfile(path, dst)
+
+
+def handle_batch(args, index, batch):
+    """batch: [(path, digest, origin, done_key)]. Returns (# failures, # new signatures)."""
+    code, output = replay(args, [p for p, _, _, _ in batch])
+    if code == 0:
+        results = [(item, 0, "") for item in batch]
+    elif len(batch) == 1:
+        results = [(batch[0], code, output)]
+    else:
+        results = [(item,) + replay(args, [item[0]]) for item in batch]
+
+    failures = new_sigs = 0
+    for (path, digest, origin, _), c, out in results:
+        sig = None
+        if c != 0:
+            sig = signature(out, args.frames) or ("exit-%d" % c, [])
+        if sig:
+            key, new = store_failure(args, index, path, digest, origin, out, sig)
+            failures += 1
+            new_sigs += new
+            print("[confirm] %s %s from %s -> %s%s" % (sig[0], sig[1][0] if sig[1] else "?", origin,
+                                                         key, " (new)" if new else ""), flush=True)
+        elif origin.startswith("artifact:"):
+            mark_unconfirmed(args, path, digest)
+    return failures, new_sigs
+
+
+def scan(args, done):
+    """New (path, digest, origin, done_key) from the corpus and artifact dirs."""
+    found = []
+    sources = [(d, "corpus") for d in args.corpus] + [(d, "artifact") for d in args.artifacts]
+    for d, what in sources:
+        try:
+            entries = list(os.scandir(d))
+        except OSError:
+            continue
+        for ent in entries:
+            if not ent.is_file() or ent.name.startswith("."):
+                continue
+            if what == "artifact" and not ent.name.startswith(ARTIFACT_PREFIXES):
+                continue
+            done_key = os.path.join(os.path.abspath(d), ent.name)
+            if done_key in done:
+                continue
+            try:
+                digest = sha1_file(ent.path)
+            except OSError:
+                continue
+            found.append((ent.path, digest, "%s:%s" % (what, done_key), done_key))
+    # artifacts first, they are the likeliest to be bugs
+    found.sort(key=lambda e: not e[2].startswith("artifact:"))
+    return found
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("--sanitized", required=True, help="ASan+UBSan libFuzzer binary used for replay")
+    ap.add_argument("--corpus", action="append", default=[], help="corpus dir of a fast fuzzer (repeatable)")
+    ap.add_argument("--artifacts", action="append", default=[],
+                    help="-artifact_prefix dir of a fast fuzzer (repeatable)")
+    ap.add_argument("--store", required=True, help="crash store directory")
+    ap.add_argument("--batch", type=int, default=64, help="inputs per sanitized process")
+    ap.add_argument("--frames", type=int, default=3, help="stack frames in a signature")
+    ap.add_argument("--keep-per-sig", type=int, default=10, help="reproducers kept per signature")
+    ap.add_argument("--timeout", type=int, default=25, help="per-input timeout, seconds")
+    ap.add_argument("--rss-limit-mb", type=int, default=4096)
+    ap.add_argument("--interval", type=float, default=30.0, help="seconds between scans when idle")
+    ap.add_argument("--once", action="store_true", help="handle what is there now and exit")
+    args = ap.parse_args()
+    if not args.corpus and not args.artifacts:
+        ap.error("need at least one --corpus or --artifacts directory")
+
+    os.makedirs(args.store, exist_ok=True)
+    done_path = os.path.join(args.store, ".confirm_done")
+    index_path = os.path.join(args.store, "index.json")
+    done = load_done(done_path)
+    try:
+        with open(index_path) as f:
+            index = json.load(f)
+    except (OSError, ValueError):
+        index = {}
+    seen_digests = set(done.values())
+    done_log = open(done_path, "a")
+
+    while True:
+        t0 = time.monotonic()
+        todo = scan(args, done)
+        replayed = failures = new_sigs = 0
+        while todo:
+            batch, todo = todo[:args.batch], todo[args.batch:]
+            # identical content already replayed under another name (e.g. a
+            # corpus entry that is also an artifact): only record it
+            fresh = [e for e in batch if e[1] not in seen_digests or e[2].startswith("artifact:")]
+            if fresh:
+                f, n = handle_batch(args, index, fresh)
+                if f:
+                    save_json(index_path, index)
+                failures += f
+                new_sigs += n
+                replayed += len(fresh)
+            # only the new entries are written: rewriting the whole map per
+            # batch made a long run's I/O quadratic in the corpus size
+            for _, digest, _, done_key in batch:
+                done[done_key] = digest
+                seen_digests.add(digest)
+                done_log.write("%s %s\n" % (digest, done_key))
+            done_log.flush()
+        if replayed:
+            print("[confirm] replayed %d, failures %d, new signatures %d, store %d (%.1fs)" %
+                  (replayed, failures, new_sigs, len(index), time.monotonic() - t0), flush=True)
+        if args.once:
+            break
+        time.sleep(args.interval)
+
+
+if __name__ == "__main__":
+    sys.exit(main())
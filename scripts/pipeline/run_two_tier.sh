@@ -0,0 +1,49 @@
+#!/bin/sh
+
+# Runs the two-tier pipeline for one fuzzer (binaries from
+# scripts/fuzz/two_tier_fuzzer.sh):
+#   - JOBS fast, coverage-only fuzzer processes sharing CORPUS, saving their
+#     crash/timeout/oom/slow-unit artifacts under $PIPE/artifacts/,
+#   - one confirm_daemon.py replaying new corpus entries and artifacts on the
+#     ASan+UBSan build into the crash store $PIPE/crashes/.
+#
+#   scripts/pipeline/run_two_tier.sh [fuzzer_name] [jobs]
+# e.g. scripts/pipeline/run_two_tier.sh cairo_stateful_fuzzer 15
+# Ctrl-C stops everything.
+
+NAME=${1:-cairo_stateful_fuzzer}
+JOBS=${2:-$(($(nproc) - 1))}
+OUT=$HOME/cairo_fuzzers/
+PIPE=${PIPE:-$HOME/cairo_pipeline/$NAME}
+CORPUS=${CORPUS:-$PIPE/corpus}
+SCRIPTS=$(dirname "$0")
+
+mkdir -p $CORPUS $PIPE/artifacts $PIPE/crashes $PIPE/logs
+
+if [ ! -x $OUT/${NAME}_fast ] || [ ! -x $OUT/$NAME ]; then
+  echo "need $OUT/${NAME}_fast and $OUT/$NAME, run scripts/fuzz/two_tier_fuzzer.sh first"
+  exit 1
+fi
+
+trap 'kill 0' INT TERM
+
+python3 $SCRIPTS/confirm_daemon.py \
+  --sanitized $OUT/$NAME \
+  --corpus $CORPUS \
+  --artifacts $PIPE/artifacts \
+  --store $PIPE/crashes \
+  >> $PIPE/logs/confirm.log 2>&1 &
+
+# -fork keeps the fast tier going after a crash, which the confirm tier
+# triages; slow units are worth a sanitized look too.
+$OUT/${NAME}_fast \
+  -fork=$JOBS \
+  -ignore_crashes=1 -ignore_timeouts=1 -ignore_ooms=1 \
+  -report_slow_units=10 \
+  -artifact_prefix=$PIPE/artifacts/ \
+  $CORPUS \
+  > $PIPE/logs/fast.log 2>&1 &
+
+echo "fast tier: $JOBS jobs, log $PIPE/logs/fast.log"
+echo "confirm tier: log $PIPE/logs/confirm.log, crash store $PIPE/crashes/"
+wait
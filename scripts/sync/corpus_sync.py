@@ -0,0 +1,265 @@
+#!/usr/bin/env python3
+"""
+Corpus synchronization between fuzzing nodes through a shared directory
+(NFS or any other shared mount). There is no central service: every node runs
+one copy of this script next to its fuzzer.
+
+Shared layout:
+    SHARED/<node>/<sha1>      corpus entries, named by content hash
+    SHARED/<node>/MANIFEST    append-only list of the names above, one per line
+
+Every cycle a node
+  * exports up to --batch new local corpus files into SHARED/<node>/ (written
+    to a temp name and renamed, then appended to its MANIFEST),
+  * reads only the new tail of every other node's MANIFEST (a byte cursor per
+    peer is kept in the state file, so a cycle costs one small read per peer
+    instead of listing dozens of huge directories),
+  * copies up to --batch unseen peer entries into a staging directory and runs
+    the fuzzer with -merge=1, which moves into the local corpus only the
+    inputs that add coverage to the local feature set.
+
+Manifest lines read but not yet staged are kept in the state file together
+with the cursors, so --once, a restart or a crash never skips past them. An
+entry counts as seen when a file of that name (a content hash) is in the local
+corpus or in SHARED/<node>/, or when it is among the last --seen-limit hashes
+handled here (peer entries the merge rejected are only remembered there).
+
+All copies go through one token bucket (--max-bytes-per-sec), and cycles are
+jittered so many nodes don't hit the share at the same moment.
+"""
+import argparse
+import hashlib
+import json
+import os
+import random
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+
+MANIFEST = "MANIFEST"
+
+
+class RateLimiter:
+    """Token bucket over bytes copied to/from the share."""
+
+    def __init__(self, bytes_per_sec):
+        self.rate = bytes_per_sec
+        self.tokens = bytes_per_sec
+        self.last = time.monotonic()
+
+    def consume(self, n):
+        if self.rate <= 0:
+            return
+        while True:
+            now = time.monotonic()
+            self.tokens = min(self.rate, self.tokens + (now - self.last) * self.rate)
+            self.last = now
+            if self.tokens >= n or self.tokens >= self.rate:
+                self.tokens -= n
+                return
+            time.sleep((min(n, self.rate) - self.tokens) / self.rate)
+
+
+def sha1_file(path):
+    h = hashlib.sha1()
+    with open(path, "rb") as f:
+        for chunk in iter(lambda: f.read(1 << 20), b""):
+            h.update(chunk)
+    return h.hexdigest()
+
+
+def copy_atomic(src, dst_dir, name, limiter):
+    """Copy src to dst_dir/name via a temp file + rename, so readers never see partial files."""
+    dst = os.path.join(dst_dir, name)
+    if os.path.exists(dst):
+        return False
+    size = os.path.getsize(src)
+    limiter.consume(size)
+    fd, tmp = tempfile.mkstemp(prefix=".tmp-", dir=dst_dir)
+    try:
+        with os.fdopen(fd, "wb") as out, open(src, "rb") as inp:
+            shutil.copyfileobj(inp, out)
+        os.rename(tmp, dst)
+    except BaseException:
+        if os.path.exists(tmp):
+            os.unlink(tmp)
+        raise
+    return True
+
+
+def load_state(path):
+    try:
+        with open(path) as f:
+            state = json.load(f)
+    except (OSError, ValueError):
+        state = {}
+    state.setdefault("cursors", {})       # peer -> byte offset into its MANIFEST
+    state.setdefault("local_done", {})    # local file name -> sha1 already handled
+    state.setdefault("pending", [])       # [peer, name] read from manifests, not staged yet
+    state.setdefault("seen", [])          # most recent sha1s handled, oldest first
+    return state
+
+
+def save_state(path, state):
+    tmp = path + ".tmp"
+    with open(tmp, "w") as f:
+        json.dump(state, f)
+    os.rename(tmp, path)
+
+
+class Seen:
+    """Content hashes already handled: the local corpus and our share directory
+    (both named by sha1), plus the last `limit` hashes staged or exported."""
+
+    def __init__(self, args, recent, limit):
+        self.dirs = [args.local, os.path.join(args.shared, args.node)]
+        self.limit = limit
+        self.recent = dict.fromkeys(recent[-limit:])   # insertion ordered
+
+    def __contains__(self, name):
+        return name in self.recent or any(os.path.exists(os.path.join(d, name)) for d in self.dirs)
+
+    def add(self, name):
+        self.recent.pop(name, None)
+        self.recent[name] = None
+        if len(self.recent) > self.limit:
+            del self.recent[next(iter(self.recent))]
+
+    def save(self, state):
+        state["seen"] = list(self.recent)
+
+
+def export_new(args, state, seen, limiter):
+    my_dir = os.path.join(args.shared, args.node)
+    os.makedirs(my_dir, exist_ok=True)
+    done = state["local_done"]
+    exported = []
+    for ent in os.scandir(args.local):
+        if len(exported) >= args.batch:
+            break
+        if not ent.is_file() or ent.name.startswith("."):
+            continue
+        if ent.name in done:
+            continue
+        digest = sha1_file(ent.path)
+        done[ent.name] = digest
+        if digest in seen:
+            continue
+        if copy_atomic(ent.path, my_dir, digest, limiter):
+            exported.append(digest)
+        seen.add(digest)
+    if exported:
+        with open(os.path.join(my_dir, MANIFEST), "a") as m:
+            m.write("".join(d + "\n" for d in exported))
+    return exported
+
+
+def read_peer_manifests(args, state):
+    """Returns [(peer, name)] appended to peer manifests since the last cycle."""
+    new = []
+    for peer in sorted(os.listdir(args.shared)):
+        if peer == args.node or peer.startswith("."):
+            continue
+        mpath = os.path.join(args.shared, peer, MANIFEST)
+        try:
+            with open(mpath, "rb") as m:
+                m.seek(state["cursors"].get(peer, 0))
+                data = m.read()
+        except OSError:
+            continue
+        # only consume complete lines; a peer may be mid-append
+        end = data.rfind(b"\n") + 1
+        for line in data[:end].splitlines():
+            name = line.decode(errors="replace").strip()
+            if name:
+                new.append((peer, name))
+        state["cursors"][peer] = state["cursors"].get(peer, 0) + end
+    return new
+
+
+def import_new(args, state, seen, limiter):
+    """Stages up to --batch pending peer entries and merges those that add coverage."""
+    pending = state["pending"]
+    staging = os.path.join(args.state_dir, "staging")
+    shutil.rmtree(staging, ignore_errors=True)
+    os.makedirs(staging)
+
+    staged = taken = 0
+    while taken < len(pending) and staged < args.batch:
+        peer, name = pending[taken]
+        taken += 1
+        if name in seen:
+            continue
+        src = os.path.join(args.shared, peer, name)
+        try:
+            copy_atomic(src, staging, name, limiter)
+        except OSError:
+            continue
+        seen.add(name)
+        staged += 1
+    del pending[:taken]
+    if staged == 0:
+        return 0, 0
+
+    before = len(os.listdir(args.local))
+    cmd = [args.fuzzer, "-merge=1", "-timeout=%d" % args.merge_timeout,
+           "-rss_limit_mb=%d" % args.rss_limit_mb, args.local, staging]
+    subprocess.run(cmd, stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+    added = len(os.listdir(args.local)) - before
+
+    # merged files are named by libFuzzer's sha1 too; don't export them back
+    for ent in os.scandir(args.local):
+        if ent.name not in state["local_done"] and ent.name in seen.recent:
+            state["local_done"][ent.name] = ent.name
+    shutil.rmtree(staging, ignore_errors=True)
+    return staged, added
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("--node", required=True, help="unique id of this node (e.g. hostname)")
+    ap.add_argument("--local", required=True, help="local corpus directory of the running fuzzer")
+    ap.add_argument("--shared", required=True, help="shared directory visible to all nodes")
+    ap.add_argument("--fuzzer", required=True, help="libFuzzer binary used for -merge=1")
+    ap.add_argument("--state-dir", default=None, help="where cursors and staging live (default: <local>/../.sync-<node>)")
+    ap.add_argument("--interval", type=float, default=300.0, help="seconds between cycles")
+    ap.add_argument("--batch", type=int, default=500, help="max files exported and imported per cycle")
+    ap.add_argument("--max-bytes-per-sec", type=int, default=5 << 20, help="copy rate limit, 0 = unlimited")
+    ap.add_argument("--merge-timeout", type=int, default=10)
+    ap.add_argument("--rss-limit-mb", type=int, default=4096)
+    ap.add_argument("--seen-limit", type=int, default=200000,
+                    help="recently handled hashes remembered beyond the corpus and share file names")
+    ap.add_argument("--once", action="store_true", help="run a single cycle and exit")
+    args = ap.parse_args()
+
+    if args.state_dir is None:
+        args.state_dir = os.path.join(os.path.dirname(os.path.abspath(args.local)), ".sync-" + args.node)
+    os.makedirs(args.state_dir, exist_ok=True)
+    os.makedirs(args.shared, exist_ok=True)
+    state_path = os.path.join(args.state_dir, "sync_state.json")
+    state = load_state(state_path)
+    seen = Seen(args, state["seen"], max(args.seen_limit, 1))
+    limiter = RateLimiter(args.max_bytes_per_sec)
+
+    while True:
+        t0 = time.monotonic()
+        # cursors, pending and seen are saved together, so nothing read from a
+        # manifest is dropped before it has been staged
+        state["pending"].extend([peer, name] for peer, name in read_peer_manifests(args, state)
+                                if name not in seen)
+        staged, added = import_new(args, state, seen, limiter)
+        exported = export_new(args, state, seen, limiter)
+        seen.save(state)
+        save_state(state_path, state)
+        print("[sync] %s: exported %d, staged %d, merged %d, backlog %d (%.1fs)" %
+              (args.node, len(exported), staged, added, len(state["pending"]), time.monotonic() - t0),
+              flush=True)
+        if args.once:
+            break
+        time.sleep(args.interval * random.uniform(0.8, 1.2))
+
+
+if __name__ == "__main__":
+    sys.exit(main())